@@ -6,12 +6,31 @@
 #include "view/window.h"
 #include "system/settings.h"
 #include "system/app.h"
+#include "system/flags.h"
+#include "system/importer.h"
+#include "system/scanner.h"
+#include "view/thumbnail_cache.h"
 
 int main(int argc, char* argv[]) {
+	Flags flags = meh_flags_parse(argc, argv);
+
+	/* import, scan and cache building modes, no UI. */
+	if (flags.import_gamelist != NULL) {
+		return meh_importer_main(flags.import_gamelist, flags.import_gamelist_file);
+	}
+
+	if (flags.scan) {
+		return meh_scanner_main();
+	}
+
+	if (flags.build_cache) {
+		return meh_thumbnail_cache_main();
+	}
+
 	/* create and init the app. */
 	App* app = meh_app_create();
 
-	meh_app_init(app, argc, argv);
+	meh_app_init(app, flags);
 
 	/* entering the main loop. */
 	meh_app_main_loop(app);
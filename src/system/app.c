@@ -10,11 +10,13 @@
 #include <libavformat/avformat.h>
 
 #include "view/image.h"
+#include "view/image_loader.h"
 #include "view/video.h"
 #include "view/screen.h"
 #include "view/screen/starting.h"
 #include "system/app.h"
 #include "system/consts.h"
+#include "system/db_profile.h"
 #include "system/flags.h"
 #include "system/input.h"
 #include "system/message.h"
@@ -23,16 +25,18 @@
 #include "system/db/models.h"
 
 static void meh_settings_print_system_infos();
+static void meh_app_poll_catalog(App* app);
+
+#define MEH_APP_CATALOG_POLL_MS (1000) /* delay between two checks of the changes of the catalog */
 
 App* meh_app_create() {
 	return g_new(App, 1);
 }
 
-int meh_app_init(App* app, int argc, char* argv[]) {
+int meh_app_init(App* app, Flags flags) {
 	g_assert(app != NULL);
 
-	/* reads the flags */
-	app->flags = meh_flags_parse(argc, argv);
+	app->flags = flags;
 
 	/* Nearly everything is used in the SDL. */
 	if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
@@ -64,19 +68,37 @@ int meh_app_init(App* app, int argc, char* argv[]) {
 
 	/* Init and read the settings */
 	Settings settings;
-	settings.fullscreen = FALSE;
-	settings.zoom_logo = FALSE;
-	meh_settings_read(&settings, "mehstation.conf");
+	meh_settings_load(&settings);
 	app->settings = settings;
 
 	/* Open the DB */
+	app->db_worker = NULL;
 	DB* db;
-	db = meh_db_open_or_create("database.db");
+	db = meh_db_open_or_create("database.db", settings);
 	app->db = db;
 	if (db == NULL) {
 		return 2;
 	}
 
+	app->db_worker = meh_db_worker_new("database.db", settings);
+	if (app->db_worker == NULL) {
+		return 2;
+	}
+
+	if (settings.catalog_scan_on_startup && !db->read_only) {
+		meh_db_worker_scan_platforms(app->db_worker);
+	}
+
+	/* after the scan: the snapshot must contain its changes. */
+	if (settings.catalog_snapshot && !db->read_only) {
+		meh_db_worker_write_snapshot(app->db_worker);
+	}
+
+	/* the changes of the catalog done from now on will be applied. */
+	app->catalog_change_id = meh_db_get_last_catalog_change(db);
+	app->data_version = meh_db_get_data_version(db);
+	app->next_catalog_poll = 0;
+
 	GQueue* platforms = meh_db_get_platforms(db);
 	for (unsigned int i = 0; i <  g_queue_get_length(platforms); i++) {
 		Platform* platform = g_queue_peek_nth(platforms, i);
@@ -86,7 +108,8 @@ int meh_app_init(App* app, int argc, char* argv[]) {
 
 
 	/* Open the main window */
-	Window* window = meh_window_create(settings.width, settings.height, settings.fullscreen, app->flags.force_software);
+	Window* window = meh_window_create(settings.width, settings.height, settings.fullscreen, app->flags.force_software,
+			settings.images_decode_threads, (gsize)MAX(settings.images_cache_budget, 0) * 1024 * 1024, settings.images_thumbnails);
 	app->window = window;
 
 	/* Opens some font. */
@@ -123,6 +146,17 @@ int meh_app_init(App* app, int argc, char* argv[]) {
 void meh_app_exit(App* app) {
 	g_assert(app != NULL);
 	g_message("mehstation is closing.");
+
+	if (app->db != NULL) {
+		meh_db_profile_dump(app->db->profile, "main");
+	}
+
+	/* the catalog may have changed during the session (favorites, launches),
+	 * the next start will use an up-to-date snapshot. Written before the
+	 * worker stops, see meh_app_destroy. */
+	if (app->db_worker != NULL && app->settings.catalog_snapshot && !app->db->read_only) {
+		meh_db_worker_write_snapshot(app->db_worker);
+	}
 }
 
 /*
@@ -132,7 +166,9 @@ void meh_app_exit(App* app) {
 int meh_app_destroy(App* app) {
 	g_assert(app != NULL);
 
+	meh_db_worker_destroy(app->db_worker);
 	meh_db_close(app->db);
+	app->db = NULL;
 
 	/* Free the resource */
 	meh_font_destroy(app->small_font);
@@ -142,13 +178,15 @@ int meh_app_destroy(App* app) {
 	meh_font_destroy(app->big_font);
 	app->big_font = NULL;
 
-	meh_window_destroy(app->window);
-	app->window = NULL;
-
+	/* before the window: the images it still waits for are cancelled. */
 	if (app->current_screen != NULL) {
 		meh_screen_destroy(app->current_screen);
+		app->current_screen = NULL;
 	}
 
+	meh_window_destroy(app->window);
+	app->window = NULL;
+
 	meh_input_manager_destroy(app->input_manager);
 
 	SDL_Quit();
@@ -182,6 +220,7 @@ int meh_app_main_loop(App* app) {
 	/* application lifecycle */
 	int loop_count = 0;
 	app->mainloop.next_tick = SDL_GetTicks();
+	app->mainloop.last_input = SDL_GetTicks();
 	int start_tick = SDL_GetTicks();
 
 	const int MAX_FRAMESKIP = app->settings.max_frameskip;
@@ -247,11 +286,13 @@ void meh_app_main_loop_event(App* app) {
 			case SDL_KEYUP:
 			case SDL_KEYDOWN:
 				meh_input_manager_read_event(app->input_manager, event);
+				app->mainloop.last_input = SDL_GetTicks();
 				break;
 			case SDL_JOYBUTTONUP:
 			case SDL_JOYBUTTONDOWN:
 			case SDL_JOYAXISMOTION:
 				meh_input_manager_read_event(app->input_manager, event);
+				app->mainloop.last_input = SDL_GetTicks();
 				break;
 			case SDL_QUIT:
 				/* directly stop the app */
@@ -279,6 +320,14 @@ void meh_app_main_loop_event(App* app) {
 void meh_app_main_loop_update(App* app) {
 	g_assert(app != NULL);
 
+	/* sends the results of the DB worker */
+	meh_db_worker_dispatch_results(app->db_worker, app);
+
+	/* sends the images decoded in background */
+	meh_image_loader_dispatch_results(app->window->image_loader, app);
+
+	meh_app_poll_catalog(app);
+
 	/* sends the update message */
 	Message* message = meh_message_new(MEH_MSG_UPDATE, NULL);
 	meh_app_send_message(app, message);
@@ -286,6 +335,31 @@ void meh_app_main_loop_update(App* app) {
 	message = NULL;
 }
 
+/*
+ * meh_app_poll_catalog checks regularly whether another connection (the DB
+ * worker, mehstation-config...) has committed in the database. If so, it reads
+ * the id of the last change of the catalog: the screens apply the changes they
+ * haven't seen yet while updating.
+ */
+static void meh_app_poll_catalog(App* app) {
+	g_assert(app != NULL);
+
+	/* nothing can change an immutable database. */
+	if (app->settings.db_immutable || SDL_GetTicks() < app->next_catalog_poll) {
+		return;
+	}
+
+	app->next_catalog_poll = SDL_GetTicks() + MEH_APP_CATALOG_POLL_MS;
+
+	gint64 data_version = meh_db_get_data_version(app->db);
+	if (data_version == app->data_version) {
+		return;
+	}
+
+	app->data_version = data_version;
+	app->catalog_change_id = meh_db_get_last_catalog_change(app->db);
+}
+
 /*
  * meh_app_main_loop_render is the rendering part of the pipeline.
  */
@@ -366,9 +440,21 @@ void meh_app_start_executable(App* app, Platform* platform, Executable* executab
 
 	g_debug("Launching '%s' on '%s'", executable->display_name, platform->name);
 
+	/* the launch is written by the DB worker while the executable
+	 * is running, it never delays the start. */
+	gboolean record = app->db_worker != NULL && !app->db->read_only;
+	gint64 played_at = g_get_real_time() / G_USEC_PER_SEC;
+	if (record) {
+		meh_db_worker_record_launch(app->db_worker, executable->id, played_at);
+	}
+
+	executable->last_played = played_at;
+
+	gint64 started = g_get_monotonic_time();
+
 	int exit_status = 0;
 	GError* error = NULL;
-	g_spawn_sync(NULL,
+	gboolean spawned = g_spawn_sync(NULL,
 				 parts,
 				 NULL,
 				 G_SPAWN_DEFAULT,
@@ -385,7 +471,12 @@ void meh_app_start_executable(App* app, Platform* platform, Executable* executab
 		g_error_free(error);
 	}
 
-	g_debug("End of execution of '%s'", executable->display_name);
+	int play_time = (g_get_monotonic_time() - started) / G_USEC_PER_SEC;
+	if (record && spawned && play_time > 0) {
+		meh_db_worker_add_play_time(app->db_worker, executable->id, play_time);
+	}
+
+	g_debug("End of execution of '%s' after %ds", executable->display_name, play_time);
 
 	/* when launching something, we may have missed some
 	 * input events, reset everything in case of. */
@@ -397,6 +488,8 @@ void meh_app_start_executable(App* app, Platform* platform, Executable* executab
 
 	/* reset the next_tick to avoid extra update/rendering frames. */
 	app->mainloop.next_tick = SDL_GetTicks();
+	/* the user has just been playing. */
+	app->mainloop.last_input = SDL_GetTicks();
 }
 
 /*
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "system/db.h"
+#include "system/db_worker.h"
 #include "system/flags.h"
 #include "system/input.h"
 #include "system/message.h"
@@ -21,6 +22,9 @@ typedef struct {
 	/* making it public to allow the system to change it after
 	 * having resumed mehstation when coming back from a platform */
 	unsigned int next_tick;
+
+	/* time of the last input, to know whether mehstation is idle. */
+	guint32 last_input;
 } Mainloop;
 
 typedef struct App {
@@ -30,14 +34,20 @@ typedef struct App {
 	Font* small_bold_font;
 	Font* big_font;
 	DB* db;
+	DBWorker* db_worker; /* executes the long queries outside of the main loop */
 	Flags flags; /* cli params */
 	InputManager* input_manager;
 	Settings settings;
 	Mainloop mainloop;
+	/* id of the last change of the catalog, the screens apply
+	 * the changes they haven't seen yet. See meh_app_poll_catalog. */
+	gint64 catalog_change_id;
+	gint64 data_version;
+	guint32 next_catalog_poll;
 } App;
 
 App* meh_app_create();
-int meh_app_init(App* app, int argc, char* argv[]);
+int meh_app_init(App* app, Flags flags);
 void meh_app_exit(App* app);
 int meh_app_destroy(App* app);
 void meh_app_set_current_screen(App* app, Screen* screen, gboolean end_transitions);
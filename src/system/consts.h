@@ -27,7 +27,9 @@
 #define MEH_MSG_BUTTON_PRESSED 0
 #define MEH_MSG_UPDATE 1
 #define MEH_MSG_RENDER 2
-#define MEH_MSG_END 3
+#define MEH_MSG_DB_RESULT 3 /* data: the executed DBRequest* */
+#define MEH_MSG_IMAGE_RESULT 4 /* data: the decoded ImageRequest* */
+#define MEH_MSG_END 5
 
 /*
  * We fake a resolution while drawing into a Screen
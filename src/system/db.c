@@ -4,28 +4,174 @@
 #include <SDL2/SDL.h>
 
 #include "system/db.h"
+#include "system/db_profile.h"
 #include "system/input.h"
+#include "system/migrations.h"
+#include "system/snapshot.h"
 #include "system/db/models.h"
 
 #define MEH_SCHEMA_FILE "res/schema.sql"
 
+/*
+ * How long a connection waits for a lock held by another
+ * connection (e.g. the one of the DB worker), in ms.
+ */
+#define MEH_DB_BUSY_TIMEOUT 2000
+
+/*
+ * Above this amount of matches, the search results aren't ranked:
+ * computing bm25 for every match would be too long for a type-ahead.
+ */
+#define MEH_DB_SEARCH_RANK_MAX 2000
+
 static gboolean meh_db_check_schema(DB* db);
 static gboolean meh_db_initialize(DB* db);
+static DB* meh_db_open_failed(DB* db);
+static void meh_db_apply_pragmas(DB* db, Settings settings);
+static void meh_db_log_pragmas(DB* db);
+static sqlite3_stmt* meh_db_get_statement(DB* db, int query_id);
+static void meh_db_release_statement(sqlite3_stmt* statement);
+static Executable* meh_db_read_executable(sqlite3_stmt* statement);
+static Executable* meh_db_read_slim_executable(sqlite3_stmt* statement);
+static GQueue* meh_db_get_platform_executables_with_resources(DB* db, const Platform* platform);
+static GQueue* meh_db_read_executables_with_resources(sqlite3_stmt* statement, int size, int* rows, int* resources);
+static GQueue* meh_db_get_executables_page(DB* db, const Platform* platform, int query_id, int executable_id, int limit);
+static gchar* meh_db_search_expression(const gchar* text);
+static gboolean meh_db_step_once(DB* db, int query_id);
+static gint64 meh_db_get_catalog_version(DB* db);
+static Snapshot* meh_db_get_snapshot(DB* db);
+static GQueue* meh_db_read_platforms(DB* db);
+static gboolean meh_db_read_executable_resources(DB* db, Executable* executable);
+
+/*
+ * Columns read by meh_db_read_executables_with_resources: the list
+ * only needs the slim columns of the executables, all covered by the
+ * executable_platform_list index. The other columns are read
+ * by meh_db_hydrate_executable.
+ */
+#define MEH_DB_EXECUTABLE_WITH_RESOURCES_COLUMNS "e.\"id\", e.\"display_name\", e.\"favorite\", e.\"last_played\", r.\"id\", r.\"kind\", r.\"filepath\""
+
+/*
+ * The pages are read with a keyset on (sort_key, id) ordering the executables
+ * (see the executable_platform_list index): a page starts at or ends before a
+ * known executable, no OFFSET is ever used.
+ * A page is selected in a subquery then joined with the resources.
+ */
+#define MEH_DB_EXECUTABLES_PAGE(WHERE, ORDER) "SELECT " MEH_DB_EXECUTABLE_WITH_RESOURCES_COLUMNS " FROM " \
+	"(SELECT \"id\", \"display_name\", \"favorite\", \"last_played\", sort_key FROM executable WHERE platform_id = ?1 AND missing = 0 " WHERE " ORDER BY " ORDER " LIMIT ?3) e " \
+	"LEFT JOIN executable_resource r ON r.\"executable_id\" = e.\"id\" ORDER BY e.sort_key, e.\"id\", r.\"id\""
+
+/*
+ * SQL of the queries kept in the statements cache, indexed by query id.
+ */
+static const char* meh_db_queries[MEH_DB_QUERY_END] = {
+	[MEH_DB_QUERY_GET_PLATFORMS] = "SELECT \"id\", \"name\", \"command\", \"icon\", \"background\", \"executables_count\", \"rom_path\", \"extensions\" FROM platform ORDER BY name",
+	[MEH_DB_QUERY_GET_PLATFORM] = "SELECT \"id\", \"name\", \"command\", \"icon\", \"background\", \"executables_count\", \"rom_path\", \"extensions\" FROM platform WHERE id = ?1 ORDER BY name",
+	[MEH_DB_QUERY_GET_PLATFORM_EXECUTABLES] = "SELECT \"id\", \"display_name\", \"filepath\", \"description\", \"genres\", \"publisher\", \"developer\", \"release_date\", \"rating\", \"players\",\"extra_parameter\", \"favorite\", \"last_played\"  FROM executable WHERE platform_id = ?1 AND missing = 0 ORDER BY sort_key, \"id\"",
+	[MEH_DB_QUERY_GET_PLATFORM_EXECUTABLES_WITH_RESOURCES] = "SELECT " MEH_DB_EXECUTABLE_WITH_RESOURCES_COLUMNS " FROM executable e LEFT JOIN executable_resource r ON r.\"executable_id\" = e.\"id\" WHERE e.platform_id = ?1 AND e.missing = 0 ORDER BY e.sort_key, e.\"id\", r.\"id\"",
+	[MEH_DB_QUERY_COUNT_PLATFORM_EXECUTABLES] = "SELECT count(\"id\") FROM executable WHERE platform_id = ?1 AND missing = 0",
+	[MEH_DB_QUERY_GET_EXECUTABLE_RESOURCES] = "SELECT \"id\", \"executable_id\", \"kind\", \"filepath\" FROM executable_resource WHERE executable_id = ?1",
+	[MEH_DB_QUERY_SET_EXECUTABLE_FAVORITE] = "UPDATE executable SET favorite = ?1 WHERE id = ?2",
+	[MEH_DB_QUERY_COUNT_MAPPING] = "SELECT count(\"id\") FROM mapping",
+	[MEH_DB_QUERY_GET_MAPPING] = "SELECT \"id\", \"up\", \"down\", \"left\", \"right\", \"start\", \"select\", \"a\", \"b\", \"l\", \"r\" FROM mapping WHERE \"id\" = ?1",
+	[MEH_DB_QUERY_SAVE_MAPPING] = "INSERT INTO mapping (id, up, down, left, right, `start`, `select`, a, b, l, r) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11)",
+	[MEH_DB_QUERY_DELETE_MAPPING] = "DELETE FROM mapping WHERE id = ?1",
+	[MEH_DB_QUERY_EXECUTABLES_PAGE_FIRST] = MEH_DB_EXECUTABLES_PAGE("", "sort_key, \"id\""),
+	[MEH_DB_QUERY_EXECUTABLES_PAGE_FROM] = MEH_DB_EXECUTABLES_PAGE("AND (sort_key, \"id\") >= (SELECT sort_key, \"id\" FROM executable WHERE \"id\" = ?2)", "sort_key, \"id\""),
+	[MEH_DB_QUERY_EXECUTABLES_PAGE_AFTER] = MEH_DB_EXECUTABLES_PAGE("AND (sort_key, \"id\") > (SELECT sort_key, \"id\" FROM executable WHERE \"id\" = ?2)", "sort_key, \"id\""),
+	[MEH_DB_QUERY_EXECUTABLES_PAGE_LAST] = MEH_DB_EXECUTABLES_PAGE("", "sort_key DESC, \"id\" DESC"),
+	[MEH_DB_QUERY_EXECUTABLES_PAGE_BEFORE] = MEH_DB_EXECUTABLES_PAGE("AND (sort_key, \"id\") < (SELECT sort_key, \"id\" FROM executable WHERE \"id\" = ?2)", "sort_key DESC, \"id\" DESC"),
+	[MEH_DB_QUERY_GET_EXECUTABLE_DETAILS] = "SELECT \"filepath\", \"description\", \"genres\", \"publisher\", \"developer\", \"release_date\", \"rating\", \"players\", \"extra_parameter\" FROM executable WHERE \"id\" = ?1",
+	/* the CROSS JOIN makes the FTS index drive the search. */
+	[MEH_DB_QUERY_SEARCH_COUNT] = "SELECT count(*) FROM executable_search CROSS JOIN executable e ON e.\"id\" = executable_search.rowid WHERE executable_search MATCH ?1 AND e.platform_id = ?2 AND e.missing = 0",
+	[MEH_DB_QUERY_SEARCH_RANKED] = "SELECT e.\"id\", e.\"display_name\", e.\"favorite\", e.\"last_played\" FROM executable_search CROSS JOIN executable e ON e.\"id\" = executable_search.rowid WHERE executable_search MATCH ?1 AND e.platform_id = ?2 AND e.missing = 0 ORDER BY bm25(executable_search, 10.0, 2.0, 1.0, 1.0) LIMIT ?3",
+	[MEH_DB_QUERY_SEARCH] = "SELECT e.\"id\", e.\"display_name\", e.\"favorite\", e.\"last_played\" FROM executable_search CROSS JOIN executable e ON e.\"id\" = executable_search.rowid WHERE executable_search MATCH ?1 AND e.platform_id = ?2 AND e.missing = 0 LIMIT ?3",
+	[MEH_DB_QUERY_RECORD_EXECUTABLE_LAUNCH] = "UPDATE executable SET last_played = ?1, play_count = play_count + 1 WHERE id = ?2",
+	[MEH_DB_QUERY_ADD_EXECUTABLE_PLAY_TIME] = "UPDATE executable SET play_time = play_time + ?1 WHERE id = ?2",
+	/* the condition on last_played lets the executable_last_played partial index drive the query. */
+	[MEH_DB_QUERY_GET_RECENT_EXECUTABLES] = "SELECT \"id\", \"display_name\", \"favorite\", \"last_played\", \"platform_id\" FROM executable WHERE last_played > 0 AND missing = 0 ORDER BY last_played DESC LIMIT ?1",
+	[MEH_DB_QUERY_GET_CATALOG_VERSION] = "SELECT \"value\" FROM mehstation WHERE \"name\" = 'catalog_version'",
+	[MEH_DB_QUERY_BEGIN_READ] = "BEGIN",
+	/* every executable of every platform in the list order, see meh_db_write_snapshot. */
+	[MEH_DB_QUERY_GET_SNAPSHOT_EXECUTABLES] = "SELECT e.\"platform_id\", " MEH_DB_EXECUTABLE_WITH_RESOURCES_COLUMNS " FROM executable e LEFT JOIN executable_resource r ON r.\"executable_id\" = e.\"id\" WHERE e.missing = 0 ORDER BY e.platform_id, e.sort_key, e.\"id\", r.\"id\"",
+	[MEH_DB_QUERY_BEGIN] = "BEGIN IMMEDIATE",
+	[MEH_DB_QUERY_COMMIT] = "COMMIT",
+	[MEH_DB_QUERY_ROLLBACK] = "ROLLBACK",
+	[MEH_DB_QUERY_START_BULK_INSERT] = "INSERT INTO mehstation (\"name\", \"value\") VALUES ('bulk_insert', NULL)",
+	[MEH_DB_QUERY_STOP_BULK_INSERT] = "DELETE FROM mehstation WHERE \"name\" = 'bulk_insert'",
+	[MEH_DB_QUERY_INDEX_EXECUTABLES] = "INSERT INTO executable_search(rowid, display_name, genres, developer, publisher) SELECT \"id\", \"display_name\", \"genres\", \"developer\", \"publisher\" FROM executable WHERE \"id\" >= ?1",
+	[MEH_DB_QUERY_COUNT_INSERTED_EXECUTABLES] = "UPDATE platform SET executables_count = executables_count + (SELECT count(\"id\") FROM executable WHERE \"id\" >= ?1 AND platform_id = platform.\"id\" AND missing = 0) WHERE \"id\" IN (SELECT DISTINCT platform_id FROM executable WHERE \"id\" >= ?1)",
+	[MEH_DB_QUERY_LOG_INSERTED_EXECUTABLES] = "INSERT INTO catalog_change (\"kind\", \"platform_id\") SELECT DISTINCT 1, platform_id FROM executable WHERE \"id\" >= ?1",
+	[MEH_DB_QUERY_GET_DATA_VERSION] = "PRAGMA data_version",
+	/* the AUTOINCREMENT sequence: still known once the changes have been deleted. */
+	[MEH_DB_QUERY_GET_LAST_CATALOG_CHANGE] = "SELECT \"seq\" FROM sqlite_sequence WHERE \"name\" = 'catalog_change'",
+	[MEH_DB_QUERY_GET_FIRST_CATALOG_CHANGE] = "SELECT min(\"id\") FROM catalog_change",
+	[MEH_DB_QUERY_GET_CATALOG_CHANGES] = "SELECT \"id\", \"kind\", \"platform_id\", \"executable_id\" FROM catalog_change WHERE \"id\" > ?1 ORDER BY \"id\"",
+	[MEH_DB_QUERY_GET_EXECUTABLE] = "SELECT \"id\", \"display_name\", \"favorite\", \"last_played\", \"platform_id\" FROM executable WHERE \"id\" = ?1 AND missing = 0",
+	[MEH_DB_QUERY_GET_EXECUTABLE_ID] = "SELECT \"id\" FROM executable WHERE platform_id = ?1 AND filepath = ?2",
+	[MEH_DB_QUERY_INSERT_EXECUTABLE] = "INSERT INTO executable (\"display_name\", \"filepath\", \"platform_id\", \"description\", \"genres\", \"publisher\", \"developer\", \"release_date\", \"rating\", \"players\", \"favorite\", \"sort_key\") VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, (CASE WHEN ?11 > 0 THEN '0' ELSE '1' END) || upper(coalesce(?1, '')))",
+	[MEH_DB_QUERY_INSERT_EXECUTABLE_RESOURCE] = "INSERT INTO executable_resource (\"executable_id\", \"type\", \"filepath\", kind) VALUES (?1, ?2, ?3, ?4)",
+	[MEH_DB_QUERY_GET_PLATFORM_FILES] = "SELECT \"id\", \"filepath\", \"missing\" FROM executable WHERE platform_id = ?1",
+	[MEH_DB_QUERY_SET_EXECUTABLE_MISSING] = "UPDATE executable SET missing = ?1 WHERE id = ?2",
+	[MEH_DB_QUERY_GET_SCAN_DIRECTORIES] = "SELECT \"path\", \"mtime\" FROM scan_directory WHERE platform_id = ?1",
+	[MEH_DB_QUERY_SAVE_SCAN_DIRECTORY] = "INSERT OR REPLACE INTO scan_directory (\"platform_id\", \"path\", \"mtime\") VALUES (?1, ?2, ?3)",
+	[MEH_DB_QUERY_DELETE_SCAN_DIRECTORY] = "DELETE FROM scan_directory WHERE platform_id = ?1 AND \"path\" = ?2",
+	[MEH_DB_QUERY_EXECUTABLE_POSITION] = "SELECT count(\"id\") FROM executable WHERE platform_id = ?1 AND missing = 0 AND (sort_key, \"id\") < (SELECT sort_key, \"id\" FROM executable WHERE \"id\" = ?2)",
+};
 
 /*
  * meh_db_open_or_create uses the given filename to open
- * or create (if needed) an SQLite3 DB.
+ * or create (if needed) an SQLite3 DB, tuned with the
+ * [database] section of the settings.
  */
-DB* meh_db_open_or_create(const char* filename) {
+DB* meh_db_open_or_create(const char* filename, Settings settings) {
 	DB* db = g_new(DB, 1);
 
 	db->filename = filename;
-	/* opens/creates the given filename. */
-	int return_code = sqlite3_open_v2(db->filename, &(db->sqlite), SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL); 
+	db->read_only = settings.db_read_only || settings.db_immutable;
+	for (int i = 0; i < MEH_DB_QUERY_END; i++) {
+		db->statements[i] = NULL;
+	}
+	db->use_snapshot = settings.catalog_snapshot;
+	db->snapshot_filename = g_strdup_printf("%s.snapshot", filename);
+	db->snapshot = NULL;
+	db->profile = NULL;
+
+	/* opens/creates the given filename, an immutable database
+	 * is opened through an URI to give the parameter to SQLite. */
+	int return_code = SQLITE_OK;
+	if (settings.db_immutable) {
+		gchar* uri = g_strdup_printf("file:%s?immutable=1", db->filename);
+		return_code = sqlite3_open_v2(uri, &(db->sqlite), SQLITE_OPEN_READONLY | SQLITE_OPEN_URI, NULL);
+		g_free(uri);
+	} else if (settings.db_read_only) {
+		return_code = sqlite3_open_v2(db->filename, &(db->sqlite), SQLITE_OPEN_READONLY, NULL);
+	} else {
+		return_code = sqlite3_open_v2(db->filename, &(db->sqlite), SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL);
+	}
 
 	if (return_code != SQLITE_OK) {
 		g_critical("Can't open the SQLite database with filename '%s', error: %s", filename, sqlite3_errstr(return_code));
-		return NULL;
+		return meh_db_open_failed(db);
+	}
+
+	sqlite3_busy_timeout(db->sqlite, MEH_DB_BUSY_TIMEOUT);
+
+	if (settings.db_profile) {
+		db->profile = meh_db_profile_new(db->sqlite, settings.db_slow_query_ms);
+	}
+
+	meh_db_apply_pragmas(db, settings);
+
+	/* A read-only database can't be initialized nor migrated,
+	 * it must have been prepared by a read-write mehstation. */
+	if (db->read_only) {
+		if (!meh_db_check_schema(db) || meh_migrations_schema_version(db) != meh_migrations_last_version()) {
+			g_critical("The read-only database '%s' doesn't have an up-to-date schema, start mehstation once in read-write mode to migrate it.", filename);
+			return meh_db_open_failed(db);
+		}
+		meh_db_log_pragmas(db);
+		return db;
 	}
 
 	/* Initialize the database if needed. */
@@ -35,22 +181,205 @@ DB* meh_db_open_or_create(const char* filename) {
 		gboolean creation_success = meh_db_initialize(db);
 		if (creation_success == FALSE) {
 			g_critical("Can't initialize the mehstation database.");
-			return NULL;
+			return meh_db_open_failed(db);
 		}
 	}
 
+	/* Upgrade the schema if needed. */
+	if (!meh_migrations_run(db)) {
+		g_critical("Can't migrate the mehstation database.");
+		return meh_db_open_failed(db);
+	}
+
+	meh_db_log_pragmas(db);
+
 	return db;
 }
 
 /*
- * meh_db_close closes the given db.
+ * meh_db_open_failed releases what has been opened of a database
+ * which can't be used, returns NULL for meh_db_open_or_create.
+ */
+static DB* meh_db_open_failed(DB* db) {
+	g_assert(db != NULL);
+
+	meh_db_close(db);
+	return NULL;
+}
+
+/*
+ * meh_db_pragma_value returns the given value if it's one of the accepted
+ * values for a PRAGMA, NULL otherwise.
+ */
+static const gchar* meh_db_pragma_value(const gchar* pragma, const gchar* value, const gchar** accepted) {
+	if (value == NULL || strlen(value) == 0) {
+		return NULL;
+	}
+
+	for (int i = 0; accepted[i] != NULL; i++) {
+		if (g_ascii_strcasecmp(value, accepted[i]) == 0) {
+			return accepted[i];
+		}
+	}
+
+	g_warning("Unknown value '%s' for the database setting %s, ignored.", value, pragma);
+	return NULL;
+}
+
+/*
+ * meh_db_exec_pragma executes the given PRAGMA, logging on error.
+ */
+static void meh_db_exec_pragma(DB* db, const gchar* pragma) {
+	g_assert(db != NULL);
+
+	char* error = NULL;
+	if (sqlite3_exec(db->sqlite, pragma, NULL, NULL, &error) != SQLITE_OK) {
+		g_warning("Can't execute '%s': %s", pragma, error);
+		sqlite3_free(error);
+	}
+}
+
+/*
+ * meh_db_apply_pragmas tunes the opened connection with the
+ * values of the [database] section of the settings.
+ */
+static void meh_db_apply_pragmas(DB* db, Settings settings) {
+	g_assert(db != NULL);
+
+	const gchar* journal_modes[] = { "WAL", "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "OFF", NULL };
+	const gchar* synchronous_modes[] = { "OFF", "NORMAL", "FULL", "EXTRA", NULL };
+	const gchar* temp_stores[] = { "DEFAULT", "FILE", "MEMORY", NULL };
+
+	gchar* pragma = NULL;
+	const gchar* value = NULL;
+
+	/* these ones write in the database file. */
+	if (!db->read_only) {
+		/* a new database, before its first table and before the journal
+		 * mode which writes the header: the free pages can then be given
+		 * back by small steps, see meh_db_maintenance_step. */
+		if (!meh_db_check_schema(db)) {
+			meh_db_exec_pragma(db, "PRAGMA auto_vacuum = INCREMENTAL");
+		}
+		if ((value = meh_db_pragma_value("journal_mode", settings.db_journal_mode, journal_modes)) != NULL) {
+			pragma = g_strdup_printf("PRAGMA journal_mode = %s", value);
+			meh_db_exec_pragma(db, pragma);
+			g_free(pragma);
+		}
+	}
+
+	if ((value = meh_db_pragma_value("synchronous", settings.db_synchronous, synchronous_modes)) != NULL) {
+		pragma = g_strdup_printf("PRAGMA synchronous = %s", value);
+		meh_db_exec_pragma(db, pragma);
+		g_free(pragma);
+	}
+
+	if ((value = meh_db_pragma_value("temp_store", settings.db_temp_store, temp_stores)) != NULL) {
+		pragma = g_strdup_printf("PRAGMA temp_store = %s", value);
+		meh_db_exec_pragma(db, pragma);
+		g_free(pragma);
+	}
+
+	pragma = g_strdup_printf("PRAGMA cache_size = %d", settings.db_cache_size);
+	meh_db_exec_pragma(db, pragma);
+	g_free(pragma);
+
+	pragma = g_strdup_printf("PRAGMA mmap_size = %d", settings.db_mmap_size);
+	meh_db_exec_pragma(db, pragma);
+	g_free(pragma);
+}
+
+/*
+ * meh_db_log_pragmas logs the value in effect of the tuned PRAGMAs.
+ */
+static void meh_db_log_pragmas(DB* db) {
+	g_assert(db != NULL);
+
+	const gchar* pragmas[] = { "journal_mode", "synchronous", "cache_size", "mmap_size", "temp_store", NULL };
+
+	for (int i = 0; pragmas[i] != NULL; i++) {
+		sqlite3_stmt* statement = NULL;
+		gchar* sql = g_strdup_printf("PRAGMA %s", pragmas[i]);
+
+		if (sqlite3_prepare_v2(db->sqlite, sql, -1, &statement, NULL) == SQLITE_OK &&
+			sqlite3_step(statement) == SQLITE_ROW) {
+			g_message("SQLite %s: %s", pragmas[i], (const char*)sqlite3_column_text(statement, 0));
+		}
+
+		sqlite3_finalize(statement);
+		g_free(sql);
+	}
+
+	g_message("SQLite read-only: %s", db->read_only ? "yes" : "no");
+}
+
+/*
+ * meh_db_close closes the given db and frees it.
  */
 void meh_db_close(DB* db) {
 	g_assert(db != NULL);
 
+	/* finalize the cached statements, the connection
+	 * can't be closed while they're alive. */
+	for (int i = 0; i < MEH_DB_QUERY_END; i++) {
+		if (db->statements[i] != NULL) {
+			sqlite3_finalize(db->statements[i]);
+			db->statements[i] = NULL;
+		}
+	}
+
 	if (db->sqlite != NULL) {
 		sqlite3_close_v2(db->sqlite);
 	}
+
+	meh_snapshot_close(db->snapshot);
+	db->snapshot = NULL;
+	g_free(db->snapshot_filename);
+
+	/* after the connection: no more statements to trace. */
+	meh_db_profile_destroy(db->profile);
+
+	g_free(db);
+}
+
+/*
+ * meh_db_get_statement returns the cached prepared statement of the given
+ * query, preparing it on its first use. The statement is reset and its
+ * bindings are cleared, it must be given back with meh_db_release_statement
+ * once its rows are read.
+ * Returns NULL if the query can't be prepared.
+ */
+static sqlite3_stmt* meh_db_get_statement(DB* db, int query_id) {
+	g_assert(db != NULL);
+	g_assert(query_id >= 0 && query_id < MEH_DB_QUERY_END);
+
+	sqlite3_stmt* statement = db->statements[query_id];
+
+	if (statement == NULL) {
+		const char* sql = meh_db_queries[query_id];
+		int return_code = sqlite3_prepare_v2(db->sqlite, sql, strlen(sql), &statement, NULL);
+		if (statement == NULL || return_code != SQLITE_OK) {
+			g_critical("Can't execute the query: %s\nError: %s", sql, sqlite3_errmsg(db->sqlite));
+			sqlite3_finalize(statement);
+			return NULL;
+		}
+		db->statements[query_id] = statement;
+		return statement;
+	}
+
+	sqlite3_reset(statement);
+	sqlite3_clear_bindings(statement);
+	return statement;
+}
+
+/*
+ * meh_db_release_statement resets the given cached statement so it
+ * doesn't keep the database locked until its next use.
+ */
+static void meh_db_release_statement(sqlite3_stmt* statement) {
+	if (statement != NULL) {
+		sqlite3_reset(statement);
+	}
 }
 
 /*
@@ -140,17 +469,22 @@ static gboolean meh_db_check_schema(DB* db) {
 GQueue* meh_db_get_platforms(DB* db) {
 	g_assert(db != NULL);
 
-	sqlite3_stmt *statement = NULL;
-
-	const char* sql = "SELECT \"id\", \"name\", \"command\", \"icon\", \"background\" FROM platform ORDER BY name";
-	int return_code = sqlite3_prepare_v2(db->sqlite, sql, strlen(sql), &statement, NULL);
-	if (return_code != SQLITE_OK) {
-		g_critical("Can't execute the query: %s\nError: %s", sql, sqlite3_errstr(return_code));
-		return NULL;
+	Snapshot* snapshot = meh_db_get_snapshot(db);
+	if (snapshot != NULL) {
+		return meh_snapshot_get_platforms(snapshot);
 	}
 
+	return meh_db_read_platforms(db);
+}
+
+/*
+ * meh_db_read_platforms reads the platforms in the DB, ordered by name.
+ */
+static GQueue* meh_db_read_platforms(DB* db) {
+	g_assert(db != NULL);
+
+	sqlite3_stmt *statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_PLATFORMS);
 	if (statement == NULL) {
-		g_critical("Null statement returned on : %s", sql);
 		return NULL;
 	}
 
@@ -159,20 +493,32 @@ GQueue* meh_db_get_platforms(DB* db) {
 	/*
 	 * read every row
 	 */
-	while (sqlite3_step(statement) == SQLITE_ROW) {
+	int return_code = SQLITE_OK;
+	while ((return_code = sqlite3_step(statement)) == SQLITE_ROW) {
 		/* read column */
 		int id = sqlite3_column_int(statement, 0);
 		const char* name = (const char*)sqlite3_column_text(statement, 1);	
 		const char* command = (const char*)sqlite3_column_text(statement, 2);
 		const char* icon = (const char*)sqlite3_column_text(statement, 3);
 		const char* background = (const char*)sqlite3_column_text(statement, 4);
+		int executables_count = sqlite3_column_int(statement, 5);
+		const char* rom_path = (const char*)sqlite3_column_text(statement, 6);
+		const char* extensions = (const char*)sqlite3_column_text(statement, 7);
 		/* build the object */
-		Platform* platform = meh_model_platform_new(id, name, command, icon, background);
+		Platform* platform = meh_model_platform_new(id, name, command, icon, background, executables_count, rom_path, extensions);
 		/* append in the list */
 		g_queue_push_tail(list, platform);
 	}
 
-	sqlite3_finalize(statement);
+	meh_db_release_statement(statement);
+
+	/* an error would be taken for the end of the platforms. */
+	if (return_code != SQLITE_DONE) {
+		g_critical("Can't read the platforms: %s", sqlite3_errmsg(db->sqlite));
+		meh_model_platforms_destroy(list);
+		return NULL;
+	}
+
 	return list;
 }
 
@@ -184,24 +530,19 @@ int meh_db_count_platform_executables(DB* db, const Platform* platform) {
 	g_assert(db != NULL);
 	g_assert(platform != NULL);
 
-	sqlite3_stmt* statement = NULL;
-	const char* sql = "SELECT count(\"id\") FROM executable WHERE platform_id = ?1";
-	int return_code = sqlite3_prepare_v2(db->sqlite, sql, strlen(sql), &statement, NULL);
-	if (statement == NULL || return_code != SQLITE_OK) {
-		g_critical("Can't execute the query: %s\nError: %s", sql, sqlite3_errstr(return_code));
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_COUNT_PLATFORM_EXECUTABLES);
+	if (statement == NULL) {
 		return 0;
 	}
 
 	sqlite3_bind_int(statement, 1, platform->id);
 
-	/* can't find this mapping. */
-	if (sqlite3_step(statement) != SQLITE_ROW) {
-		return 0;
+	int count = 0;
+	if (sqlite3_step(statement) == SQLITE_ROW) {
+		count = (int)sqlite3_column_int(statement, 0);
 	}
 
-	int count = (int)sqlite3_column_int(statement, 0);
-
-	sqlite3_finalize(statement);
+	meh_db_release_statement(statement);
 	return count;
 }
 
@@ -211,22 +552,17 @@ int meh_db_count_platform_executables(DB* db, const Platform* platform) {
 int meh_db_count_mapping(DB* db) {
 	g_assert(db != NULL);
 
-	sqlite3_stmt* statement = NULL;
-	const char* sql = "SELECT count(\"id\") FROM mapping";
-	int return_code = sqlite3_prepare_v2(db->sqlite, sql, strlen(sql), &statement, NULL);
-	if (statement == NULL || return_code != SQLITE_OK) {
-		g_critical("Can't execute the query: %s\nError: %s", sql, sqlite3_errstr(return_code));
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_COUNT_MAPPING);
+	if (statement == NULL) {
 		return 0;
 	}
 
-	/* can't find this mapping. */
-	if (sqlite3_step(statement) != SQLITE_ROW) {
-		return 0;
+	int count = 0;
+	if (sqlite3_step(statement) == SQLITE_ROW) {
+		count = (int)sqlite3_column_int(statement, 0);
 	}
 
-	int count = (int)sqlite3_column_int(statement, 0);
-
-	sqlite3_finalize(statement);
+	meh_db_release_statement(statement);
 	return count;
 }
 
@@ -241,18 +577,17 @@ void meh_db_delete_mapping(DB* db, gchar* id) {
 		return;
 	}
 
-	sqlite3_stmt* statement = NULL;
-	const char* sql = "DELETE FROM mapping WHERE id = ?1";
-
-	int return_code = sqlite3_prepare_v2(db->sqlite, sql, strlen(sql), &statement, NULL);
-	if (statement == NULL || return_code != SQLITE_OK) {
-		g_critical("Can't execute the query :%s\nError :%s", sql, sqlite3_errstr(return_code));
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_DELETE_MAPPING);
+	if (statement == NULL) {
 		return;
 	}
 
 	sqlite3_bind_text(statement, 1, id, -1, NULL);
 
-	if (sqlite3_step(statement) != SQLITE_ROW) {
+	int return_code = sqlite3_step(statement);
+	meh_db_release_statement(statement);
+
+	if (return_code != SQLITE_DONE) {
 		return;
 	}
 
@@ -266,12 +601,8 @@ void meh_db_save_mapping(DB* db, Mapping* mapping) {
 	g_assert(db != NULL);
 	g_assert(mapping != NULL);
 
-	sqlite3_stmt* statement = NULL;
-	const char* sql = "INSERT INTO mapping (id, up, down, left, right, `start`, `select`, a, b, l, r) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11)";
-
-	int return_code = sqlite3_prepare_v2(db->sqlite, sql, strlen(sql), &statement, NULL);
-	if (statement == NULL || return_code != SQLITE_OK) {
-		g_critical("Can't execute the query :%s\nError :%s", sql, sqlite3_errstr(return_code));
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_SAVE_MAPPING);
+	if (statement == NULL) {
 		return;
 	}
 
@@ -288,7 +619,10 @@ void meh_db_save_mapping(DB* db, Mapping* mapping) {
 	sqlite3_bind_int(statement, 10, mapping->l);
 	sqlite3_bind_int(statement, 11, mapping->r);
 
-	if (sqlite3_step(statement) != SQLITE_ROW) {
+	int return_code = sqlite3_step(statement);
+	meh_db_release_statement(statement);
+
+	if (return_code != SQLITE_DONE) {
 		return;
 	}
 
@@ -303,11 +637,8 @@ Mapping* meh_db_get_mapping(DB* db, const gchar* id) {
 	g_assert(id != NULL);
 	g_assert(strlen(id) > 0);
 
-	sqlite3_stmt* statement = NULL;
-	const char* sql = "SELECT \"id\", \"up\", \"down\", \"left\", \"right\", \"start\", \"select\", \"a\", \"b\", \"l\", \"r\" FROM mapping WHERE \"id\" = ?1";
-	int return_code = sqlite3_prepare_v2(db->sqlite, sql, strlen(sql), &statement, NULL);
-	if (statement == NULL || return_code != SQLITE_OK) {
-		g_critical("Can't execute the query: %s\nError: %s", sql, sqlite3_errstr(return_code));
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_MAPPING);
+	if (statement == NULL) {
 		return NULL;
 	}
 
@@ -315,6 +646,7 @@ Mapping* meh_db_get_mapping(DB* db, const gchar* id) {
 
 	/* can't find this mapping. */
 	if (sqlite3_step(statement) != SQLITE_ROW) {
+		meh_db_release_statement(statement);
 		return NULL;
 	}
 
@@ -333,7 +665,7 @@ Mapping* meh_db_get_mapping(DB* db, const gchar* id) {
 					(int)sqlite3_column_int(statement, 10)
 	);
 
-	sqlite3_finalize(statement);
+	meh_db_release_statement(statement);
 
 	return m;
 }
@@ -345,23 +677,19 @@ Platform* meh_db_get_platform(DB* db, int platform_id) {
 	g_assert(db != NULL);
 	g_assert(platform_id > -1);
 
-	Platform* platform = NULL;
-	sqlite3_stmt *statement = NULL;
-
-	const char* sql = "SELECT \"id\", \"name\", \"command\", \"icon\", \"background\" FROM platform WHERE id = ?1 ORDER BY name";
-	int return_code = sqlite3_prepare_v2(db->sqlite, sql, strlen(sql), &statement, NULL);
-	if (statement == NULL || return_code != SQLITE_OK) {
-		g_critical("Can't execute the query: %s\nError: %s", sql, sqlite3_errstr(return_code));
-		return NULL;
+	Snapshot* snapshot = meh_db_get_snapshot(db);
+	if (snapshot != NULL) {
+		return meh_snapshot_get_platform(snapshot, platform_id);
 	}
 
-	sqlite3_bind_int(statement, 1, platform_id);
-
+	Platform* platform = NULL;
+	sqlite3_stmt *statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_PLATFORM);
 	if (statement == NULL) {
-		g_critical("Null statement returned on : %s", sql);
 		return NULL;
 	}
 
+	sqlite3_bind_int(statement, 1, platform_id);
+
 	/*
 	 * read every row
 	 */
@@ -372,139 +700,1137 @@ Platform* meh_db_get_platform(DB* db, int platform_id) {
 		const char* command = (const char*)sqlite3_column_text(statement, 2);
 		const char* icon = (const char*)sqlite3_column_text(statement, 3);
 		const char* background = (const char*)sqlite3_column_text(statement, 4);
+		int executables_count = sqlite3_column_int(statement, 5);
+		const char* rom_path = (const char*)sqlite3_column_text(statement, 6);
+		const char* extensions = (const char*)sqlite3_column_text(statement, 7);
 		/* build the object */
-		platform = meh_model_platform_new(id, name, command, icon, background);
+		platform = meh_model_platform_new(id, name, command, icon, background, executables_count, rom_path, extensions);
 	}
 
-	sqlite3_finalize(statement);
+	meh_db_release_statement(statement);
 
 	return platform;
 }
 
 /*
- * meh_db_get_platform_executables gets in  the SQLite3 database all the executables
- * available for the given platform.
+ * meh_db_read_executable builds an Executable from the current row of the
+ * given statement, the executable columns must be the 13 first ones.
  */
-GQueue* meh_db_get_platform_executables(DB* db, const Platform* platform, gboolean get_resources) {
-	g_assert(db != NULL);
-	g_assert(platform != NULL);
+static Executable* meh_db_read_executable(sqlite3_stmt* statement) {
+	g_assert(statement != NULL);
+
+	/* read column */
+	int id = sqlite3_column_int(statement, 0);
+	const char* display_name = (const char*)sqlite3_column_text(statement, 1);	
+	const char* filepath = (const char*)sqlite3_column_text(statement, 2);
+	const char* description = (const char*)sqlite3_column_text(statement, 3);
+	const char* genres = (const char*)sqlite3_column_text(statement, 4);
+	const char* publisher = (const char*)sqlite3_column_text(statement, 5);
+	const char* developer = (const char*)sqlite3_column_text(statement, 6);
+	const char* release_date = (const char*)sqlite3_column_text(statement, 7);
+	const char* rating = (const char*)sqlite3_column_text(statement, 8);
+	const char* players = (const char*)sqlite3_column_text(statement, 9);
+	const char* extra_parameter = (const char*)sqlite3_column_text(statement, 10);
+	gboolean favorite = sqlite3_column_int(statement, 11) > 0 ? TRUE : FALSE;
+	gint64 last_played = sqlite3_column_int64(statement, 12);
+
+	/* build the object */
+	return meh_model_executable_new(id, display_name, filepath, description,
+			genres, publisher, developer, release_date, rating, players, extra_parameter,
+			favorite, last_played);
+}
 
-	GQueue* executables = g_queue_new();
-	sqlite3_stmt *statement = NULL;
+/*
+ * meh_db_read_slim_executable builds a slim Executable (see meh_model_executable_new_slim)
+ * from the current row of the given statement, the slim executable columns must
+ * be the 4 first ones.
+ */
+static Executable* meh_db_read_slim_executable(sqlite3_stmt* statement) {
+	g_assert(statement != NULL);
 
-	const char* sql = "SELECT \"id\", \"display_name\", \"filepath\", \"description\", \"genres\", \"publisher\", \"developer\", \"release_date\", \"rating\", \"players\",\"extra_parameter\", \"favorite\", \"last_played\"  FROM executable WHERE platform_id = ?1 ORDER BY favorite DESC, upper(\"display_name\")";
-	int return_code = sqlite3_prepare_v2(db->sqlite, sql, strlen(sql), &statement, NULL);
-	if (return_code != SQLITE_OK) {
-		g_critical("Can't execute the query: %s\nError: %s", sql, sqlite3_errstr(return_code));
-		return NULL;
-	}
+	int id = sqlite3_column_int(statement, 0);
+	const char* display_name = (const char*)sqlite3_column_text(statement, 1);
+	gboolean favorite = sqlite3_column_int(statement, 2) > 0 ? TRUE : FALSE;
+	gint64 last_played = sqlite3_column_int64(statement, 3);
 
-	sqlite3_bind_int(statement, 1, platform->id);
+	return meh_model_executable_new_slim(id, display_name, favorite, last_played);
+}
 
-	/*
-	 * read every row
-	 */
-	while (sqlite3_step(statement) == SQLITE_ROW) {
-		/* read column */
-		int id = sqlite3_column_int(statement, 0);
-		const char* display_name = (const char*)sqlite3_column_text(statement, 1);	
-		const char* filepath = (const char*)sqlite3_column_text(statement, 2);
-		const char* description = (const char*)sqlite3_column_text(statement, 3);
-		const char* genres = (const char*)sqlite3_column_text(statement, 4);
-		const char* publisher = (const char*)sqlite3_column_text(statement, 5);
-		const char* developer = (const char*)sqlite3_column_text(statement, 6);
-		const char* release_date = (const char*)sqlite3_column_text(statement, 7);
-		const char* rating = (const char*)sqlite3_column_text(statement, 8);
-		const char* players = (const char*)sqlite3_column_text(statement, 9);
-		const char* extra_parameter = (const char*)sqlite3_column_text(statement, 10);
-		gboolean favorite = sqlite3_column_int(statement, 11) > 0 ? TRUE : FALSE;
-		GDateTime* last_played = g_date_time_new_from_unix_local(sqlite3_column_int(statement, 12));
+/*
+ * meh_db_hydrate_executable reads the details of a slim executable
+ * (filepath, description, metadata...). Does nothing if the
+ * executable is already hydrated.
+ */
+gboolean meh_db_hydrate_executable(DB* db, Executable* executable) {
+	g_assert(db != NULL);
+	g_assert(executable != NULL);
 
-		/* build the object */
-		Executable* executable = meh_model_executable_new(id, display_name, filepath, description,
-				genres, publisher, developer, release_date, rating, players, extra_parameter,
-				favorite, last_played);
+	if (executable->hydrated) {
+		return TRUE;
+	}
 
-		if (executable != NULL) {
-			/* do we get the resources of this executable ? */
-			if (get_resources == TRUE) {
-				executable->resources = meh_db_get_executable_resources(db, executable);
-			}
-			/* append in the list */
-			g_queue_push_tail(executables, executable);
-		}
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_EXECUTABLE_DETAILS);
+	if (statement == NULL) {
+		return FALSE;
 	}
 
-	/* finalize our work with this statement. */
-	sqlite3_finalize(statement);
+	sqlite3_bind_int(statement, 1, executable->id);
 
-	return executables;
+	if (sqlite3_step(statement) != SQLITE_ROW) {
+		g_critical("Can't read the details of the executable %d: %s", executable->id, sqlite3_errmsg(db->sqlite));
+		meh_db_release_statement(statement);
+		return FALSE;
+	}
+
+	meh_model_executable_hydrate(executable,
+			(const char*)sqlite3_column_text(statement, 0),
+			(const char*)sqlite3_column_text(statement, 1),
+			(const char*)sqlite3_column_text(statement, 2),
+			(const char*)sqlite3_column_text(statement, 3),
+			(const char*)sqlite3_column_text(statement, 4),
+			(const char*)sqlite3_column_text(statement, 5),
+			(const char*)sqlite3_column_text(statement, 6),
+			(const char*)sqlite3_column_text(statement, 7),
+			(const char*)sqlite3_column_text(statement, 8));
+
+	meh_db_release_statement(statement);
+	return TRUE;
 }
 
-gboolean meh_db_set_executable_favorite(DB* db, const Executable* executable, gboolean favorite) {
-	g_assert(db != NULL);
-	g_assert(executable != NULL);
+/*
+ * meh_db_search_expression converts the text typed by the user into a
+ * FTS5 query: every word is used as a prefix and all of them must match.
+ * Returns NULL if the text has no words, must be freed otherwise.
+ */
+static gchar* meh_db_search_expression(const gchar* text) {
+	g_assert(text != NULL);
 
-	sqlite3_stmt *statement = NULL;
+	GString* expression = g_string_new("");
+	gchar** words = g_strsplit_set(text, " \t", -1);
 
-	const char* sql = "UPDATE executable SET favorite = ?1 WHERE id = ?2";
-	int return_code = sqlite3_prepare_v2(db->sqlite, sql, strlen(sql), &statement, NULL);
+	for (int i = 0; words[i] != NULL; i++) {
+		if (strlen(words[i]) == 0) {
+			continue;
+		}
 
-	if (return_code != SQLITE_OK) {
-		g_critical("Can't execute the query: %s\nError: %s", sql, sqlite3_errstr(return_code));
-		return FALSE;
+		/* quoted as a string, the quotes are doubled. */
+		gchar** parts = g_strsplit(words[i], "\"", -1);
+		gchar* escaped = g_strjoinv("\"\"", parts);
+		g_strfreev(parts);
+
+		if (expression->len > 0) {
+			g_string_append_c(expression, ' ');
+		}
+		g_string_append_printf(expression, "\"%s\"*", escaped);
+		g_free(escaped);
 	}
 
-	sqlite3_bind_int(statement, 1, favorite == TRUE ? 1 : 0);
-	sqlite3_bind_int(statement, 2, executable->id);
+	g_strfreev(words);
 
-	if (sqlite3_step(statement) == SQLITE_DONE) {
-		return TRUE;
+	if (expression->len == 0) {
+		g_string_free(expression, TRUE);
+		return NULL;
 	}
 
-	return FALSE;
+	return g_string_free(expression, FALSE);
 }
 
 /*
- * meh_db_get_executable_resources gets in  the SQLite3 database all the resources
- * available for the given executable.
+ * meh_db_search_executables looks for the executables of the platform matching
+ * the given text in their name, genres, developer or publisher. Returns at most
+ * `limit` slim executables, the most relevant first when there's not too
+ * many matches.
  */
-GQueue* meh_db_get_executable_resources(DB* db, const Executable* executable) {
+GQueue* meh_db_search_executables(DB* db, int platform_id, const gchar* text, int limit) {
 	g_assert(db != NULL);
-	g_assert(executable != NULL);
+	g_assert(text != NULL);
 
-	sqlite3_stmt *statement = NULL;
+	GQueue* executables = g_queue_new();
 
-	const char* sql = "SELECT \"id\", \"executable_id\", \"type\", \"filepath\" FROM executable_resource WHERE executable_id = ?1";
-	int return_code = sqlite3_prepare_v2(db->sqlite, sql, strlen(sql), &statement, NULL);
-	if (return_code != SQLITE_OK) {
-		g_critical("Can't execute the query: %s\nError: %s", sql, sqlite3_errstr(return_code));
-		return NULL;
+	gchar* expression = meh_db_search_expression(text);
+	if (expression == NULL) {
+		return executables;
 	}
 
-	GQueue* exec_resources = g_queue_new();
+	gint64 start = g_get_monotonic_time();
 
-	sqlite3_bind_int(statement, 1, executable->id);
+	/* count the matches in the platform to know whether they can be ranked */
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_SEARCH_COUNT);
+	if (statement == NULL) {
+		g_free(expression);
+		return executables;
+	}
+
+	sqlite3_bind_text(statement, 1, expression, -1, NULL);
+	sqlite3_bind_int(statement, 2, platform_id);
+
+	int matches = 0;
+	if (sqlite3_step(statement) == SQLITE_ROW) {
+		matches = sqlite3_column_int(statement, 0);
+	}
+	meh_db_release_statement(statement);
+
+	if (matches == 0) {
+		g_free(expression);
+		return executables;
+	}
+
+	statement = meh_db_get_statement(db, matches <= MEH_DB_SEARCH_RANK_MAX ? MEH_DB_QUERY_SEARCH_RANKED : MEH_DB_QUERY_SEARCH);
+	if (statement == NULL) {
+		g_free(expression);
+		return executables;
+	}
+
+	sqlite3_bind_text(statement, 1, expression, -1, NULL);
+	sqlite3_bind_int(statement, 2, platform_id);
+	sqlite3_bind_int(statement, 3, limit);
 
-	/*
-	 * read every row
-	 */
 	while (sqlite3_step(statement) == SQLITE_ROW) {
-		/* read column */
-		int id = sqlite3_column_int(statement, 0);
-		int executable_id = sqlite3_column_int(statement, 1);
-		const char* type = (const char*)sqlite3_column_text(statement, 2);	
-		const char* filepath = (const char*)sqlite3_column_text(statement, 3);
-		/* build the object */
-		ExecutableResource* exec_res = meh_model_exec_res_new(id, executable_id, type, filepath);
-		/* append in the list */
-		if (exec_res != NULL) {
-			g_queue_push_tail(exec_resources, exec_res);
+		Executable* executable = meh_db_read_slim_executable(statement);
+		if (executable != NULL) {
+			g_queue_push_tail(executables, executable);
 		}
 	}
 
-	/* finalize our work with this statement. */
-	sqlite3_finalize(statement);
+	meh_db_release_statement(statement);
+
+	g_debug("Search '%s': %d results out of %d matches in %" G_GINT64_FORMAT "us.", expression,
+			g_queue_get_length(executables), matches, g_get_monotonic_time() - start);
+
+	g_free(expression);
+
+	return executables;
+}
 
-	return exec_resources;
+/*
+ * meh_db_get_platform_executables gets in  the SQLite3 database all the executables
+ * available for the given platform. With their resources, the executables
+ * are slim ones: see meh_db_hydrate_executable.
+ */
+GQueue* meh_db_get_platform_executables(DB* db, const Platform* platform, gboolean get_resources) {
+	g_assert(db != NULL);
+	g_assert(platform != NULL);
+
+	/* one query for the executables and their resources. */
+	if (get_resources == TRUE) {
+		return meh_db_get_platform_executables_with_resources(db, platform);
+	}
+
+	sqlite3_stmt *statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_PLATFORM_EXECUTABLES);
+	if (statement == NULL) {
+		return NULL;
+	}
+
+	GQueue* executables = g_queue_new();
+
+	sqlite3_bind_int(statement, 1, platform->id);
+
+	/*
+	 * read every row
+	 */
+	while (sqlite3_step(statement) == SQLITE_ROW) {
+		Executable* executable = meh_db_read_executable(statement);
+		if (executable != NULL) {
+			/* append in the list */
+			g_queue_push_tail(executables, executable);
+		}
+	}
+
+	/* we're done with this statement. */
+	meh_db_release_statement(statement);
+
+	return executables;
+}
+
+/*
+ * meh_db_get_platform_executables_with_resources loads the executables of the
+ * given platform with their resources using only one query: the executables are
+ * left joined with their resources, an executable having N resources is then
+ * read on N consecutive rows.
+ */
+static GQueue* meh_db_get_platform_executables_with_resources(DB* db, const Platform* platform) {
+	g_assert(db != NULL);
+	g_assert(platform != NULL);
+
+	gint64 start = g_get_monotonic_time();
+
+	Snapshot* snapshot = meh_db_get_snapshot(db);
+	if (snapshot != NULL) {
+		GQueue* executables = meh_snapshot_get_platform_executables(snapshot, platform->id);
+		if (executables != NULL) {
+			g_message("Loaded %d executables of '%s' from the catalog snapshot in %" G_GINT64_FORMAT "ms.",
+					g_queue_get_length(executables), platform->name, (g_get_monotonic_time() - start) / 1000);
+			return executables;
+		}
+	}
+
+	sqlite3_stmt *statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_PLATFORM_EXECUTABLES_WITH_RESOURCES);
+	if (statement == NULL) {
+		return NULL;
+	}
+
+	int rows = 0;
+	int resources = 0;
+
+	sqlite3_bind_int(statement, 1, platform->id);
+
+	GQueue* executables = meh_db_read_executables_with_resources(statement, platform->executables_count, &rows, &resources);
+
+	/* we're done with this statement. */
+	meh_db_release_statement(statement);
+
+	g_message("Loaded %d executables and %d resources of '%s' from %d rows in %" G_GINT64_FORMAT "ms.",
+			g_queue_get_length(executables), resources, platform->name, rows,
+			(g_get_monotonic_time() - start) / 1000);
+
+	return executables;
+}
+
+/*
+ * meh_db_read_executables_with_resources reads the executables and their resources
+ * from an executed statement returning the MEH_DB_EXECUTABLE_WITH_RESOURCES_COLUMNS
+ * ordered by executable, in one catalog (see catalog.h). `size` is the expected
+ * amount of executables. The amount of rows and resources read are added to the
+ * given counters.
+ */
+static GQueue* meh_db_read_executables_with_resources(sqlite3_stmt* statement, int size, int* rows, int* resources) {
+	g_assert(statement != NULL);
+	g_assert(rows != NULL);
+	g_assert(resources != NULL);
+
+	CatalogBuilder* builder = meh_model_catalog_builder_new(size);
+	gboolean first = TRUE;
+	int executable_id = 0;
+
+	/*
+	 * read every row
+	 */
+	while (sqlite3_step(statement) == SQLITE_ROW) {
+		(*rows)++;
+
+		/* the rows are ordered by executable, a new id means a new executable. */
+		int id = sqlite3_column_int(statement, 0);
+		if (first || executable_id != id) {
+			meh_model_catalog_builder_add_executable(builder, id,
+					(const char*)sqlite3_column_text(statement, 1),
+					sqlite3_column_int(statement, 2) > 0 ? TRUE : FALSE,
+					sqlite3_column_int64(statement, 3));
+			executable_id = id;
+			first = FALSE;
+		}
+
+		/* no resources for this executable. */
+		if (sqlite3_column_type(statement, 4) == SQLITE_NULL) {
+			continue;
+		}
+
+		meh_model_catalog_builder_add_resource(builder, sqlite3_column_int(statement, 4),
+				sqlite3_column_int(statement, 5),
+				(const char*)sqlite3_column_text(statement, 6));
+		(*resources)++;
+	}
+
+	return meh_model_catalog_builder_finish(builder);
+}
+
+/*
+ * meh_db_get_executables_page reads, with their resources, at most `limit` executables
+ * of the platform using one of the keyset page queries, positioned on the given executable.
+ * The executables are always returned in the list order.
+ */
+static GQueue* meh_db_get_executables_page(DB* db, const Platform* platform, int query_id, int executable_id, int limit) {
+	g_assert(db != NULL);
+	g_assert(platform != NULL);
+
+	sqlite3_stmt *statement = meh_db_get_statement(db, query_id);
+	if (statement == NULL) {
+		return g_queue_new();
+	}
+
+	int rows = 0;
+	int resources = 0;
+
+	sqlite3_bind_int(statement, 1, platform->id);
+	sqlite3_bind_int(statement, 2, executable_id);
+	sqlite3_bind_int(statement, 3, limit);
+
+	GQueue* executables = meh_db_read_executables_with_resources(statement, limit, &rows, &resources);
+
+	meh_db_release_statement(statement);
+
+	g_debug("Page of %d executables read from %d rows.", g_queue_get_length(executables), rows);
+
+	return executables;
+}
+
+/*
+ * meh_db_get_executables_from returns, in the list order and with their resources, at most
+ * `limit` executables of the platform starting with the given executable included.
+ * With an executable_id of -1, the page starts with the first executable of the platform.
+ */
+GQueue* meh_db_get_executables_from(DB* db, const Platform* platform, int executable_id, int limit) {
+	if (executable_id < 0) {
+		return meh_db_get_executables_page(db, platform, MEH_DB_QUERY_EXECUTABLES_PAGE_FIRST, executable_id, limit);
+	}
+	return meh_db_get_executables_page(db, platform, MEH_DB_QUERY_EXECUTABLES_PAGE_FROM, executable_id, limit);
+}
+
+/*
+ * meh_db_get_executables_after returns, in the list order and with their resources, at most
+ * `limit` executables of the platform following the given one.
+ */
+GQueue* meh_db_get_executables_after(DB* db, const Platform* platform, int executable_id, int limit) {
+	return meh_db_get_executables_page(db, platform, MEH_DB_QUERY_EXECUTABLES_PAGE_AFTER, executable_id, limit);
+}
+
+/*
+ * meh_db_get_executables_before returns, in the list order and with their resources, at most
+ * `limit` executables of the platform preceding the given one.
+ * With an executable_id of -1, the page ends with the last executable of the platform.
+ */
+GQueue* meh_db_get_executables_before(DB* db, const Platform* platform, int executable_id, int limit) {
+	if (executable_id < 0) {
+		return meh_db_get_executables_page(db, platform, MEH_DB_QUERY_EXECUTABLES_PAGE_LAST, executable_id, limit);
+	}
+	return meh_db_get_executables_page(db, platform, MEH_DB_QUERY_EXECUTABLES_PAGE_BEFORE, executable_id, limit);
+}
+
+/*
+ * meh_db_get_executable_position returns the index of the given executable
+ * in the executables list of the platform, -1 on error.
+ */
+int meh_db_get_executable_position(DB* db, const Platform* platform, int executable_id) {
+	g_assert(db != NULL);
+	g_assert(platform != NULL);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_EXECUTABLE_POSITION);
+	if (statement == NULL) {
+		return -1;
+	}
+
+	sqlite3_bind_int(statement, 1, platform->id);
+	sqlite3_bind_int(statement, 2, executable_id);
+
+	int position = -1;
+	if (sqlite3_step(statement) == SQLITE_ROW) {
+		position = (int)sqlite3_column_int(statement, 0);
+	}
+
+	meh_db_release_statement(statement);
+	return position;
+}
+
+/*
+ * meh_db_set_executable_favorite updates the favorite flag of an executable.
+ * `catalog_change_id` receives the id of the last change of the catalog
+ * once written: the changes of this executable up to it are already applied
+ * by the caller (see meh_exec_list_apply_changes).
+ */
+gboolean meh_db_set_executable_favorite(DB* db, int executable_id, gboolean favorite, gint64* catalog_change_id) {
+	g_assert(db != NULL);
+	g_assert(catalog_change_id != NULL);
+
+	/* in a transaction, no other connection can log a change
+	 * between the update and the read of the last change. */
+	if (!meh_db_step_once(db, MEH_DB_QUERY_BEGIN)) {
+		return FALSE;
+	}
+
+	sqlite3_stmt *statement = meh_db_get_statement(db, MEH_DB_QUERY_SET_EXECUTABLE_FAVORITE);
+	if (statement == NULL) {
+		meh_db_rollback(db);
+		return FALSE;
+	}
+
+	sqlite3_bind_int(statement, 1, favorite == TRUE ? 1 : 0);
+	sqlite3_bind_int(statement, 2, executable_id);
+
+	int return_code = sqlite3_step(statement);
+	meh_db_release_statement(statement);
+
+	if (return_code != SQLITE_DONE) {
+		meh_db_rollback(db);
+		return FALSE;
+	}
+
+	*catalog_change_id = meh_db_get_last_catalog_change(db);
+
+	if (!meh_db_step_once(db, MEH_DB_QUERY_COMMIT)) {
+		meh_db_rollback(db);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*
+ * meh_db_record_executable_launch stores the launch of an executable
+ * at the given unix time and increments its play count.
+ */
+gboolean meh_db_record_executable_launch(DB* db, int executable_id, gint64 played_at) {
+	g_assert(db != NULL);
+
+	sqlite3_stmt *statement = meh_db_get_statement(db, MEH_DB_QUERY_RECORD_EXECUTABLE_LAUNCH);
+	if (statement == NULL) {
+		return FALSE;
+	}
+
+	sqlite3_bind_int64(statement, 1, played_at);
+	sqlite3_bind_int(statement, 2, executable_id);
+
+	int return_code = sqlite3_step(statement);
+	meh_db_release_statement(statement);
+
+	return return_code == SQLITE_DONE;
+}
+
+/*
+ * meh_db_add_executable_play_time adds the given amount
+ * of seconds to the play time of an executable.
+ */
+gboolean meh_db_add_executable_play_time(DB* db, int executable_id, int seconds) {
+	g_assert(db != NULL);
+
+	sqlite3_stmt *statement = meh_db_get_statement(db, MEH_DB_QUERY_ADD_EXECUTABLE_PLAY_TIME);
+	if (statement == NULL) {
+		return FALSE;
+	}
+
+	sqlite3_bind_int(statement, 1, seconds);
+	sqlite3_bind_int(statement, 2, executable_id);
+
+	int return_code = sqlite3_step(statement);
+	meh_db_release_statement(statement);
+
+	return return_code == SQLITE_DONE;
+}
+
+/*
+ * meh_db_get_recent_executables returns the last played executables of
+ * every platform, the most recent first. These slim executables have
+ * their platform_id set.
+ */
+GQueue* meh_db_get_recent_executables(DB* db, int limit) {
+	g_assert(db != NULL);
+
+	GQueue* executables = g_queue_new();
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_RECENT_EXECUTABLES);
+	if (statement == NULL) {
+		return executables;
+	}
+
+	sqlite3_bind_int(statement, 1, limit);
+
+	while (sqlite3_step(statement) == SQLITE_ROW) {
+		Executable* executable = meh_db_read_slim_executable(statement);
+		if (executable != NULL) {
+			executable->platform_id = sqlite3_column_int(statement, 4);
+			g_queue_push_tail(executables, executable);
+		}
+	}
+
+	meh_db_release_statement(statement);
+
+	return executables;
+}
+
+/*
+ * meh_db_step_once executes a cached query returning no rows.
+ */
+static gboolean meh_db_step_once(DB* db, int query_id) {
+	g_assert(db != NULL);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, query_id);
+	if (statement == NULL) {
+		return FALSE;
+	}
+
+	int return_code = sqlite3_step(statement);
+	meh_db_release_statement(statement);
+
+	if (return_code != SQLITE_DONE) {
+		g_critical("Can't execute the query: %s\nError: %s", meh_db_queries[query_id], sqlite3_errmsg(db->sqlite));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+ * meh_db_get_catalog_version returns the version of the catalog, incremented
+ * on every change of the data in the snapshot, -1 if unknown.
+ */
+static gint64 meh_db_get_catalog_version(DB* db) {
+	g_assert(db != NULL);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_CATALOG_VERSION);
+	if (statement == NULL) {
+		return -1;
+	}
+
+	gint64 version = -1;
+	if (sqlite3_step(statement) == SQLITE_ROW) {
+		version = sqlite3_column_int64(statement, 0);
+	}
+
+	meh_db_release_statement(statement);
+	return version;
+}
+
+/*
+ * meh_db_get_snapshot returns the snapshot of the catalog if it's up-to-date,
+ * NULL if the queries must be used. A stale snapshot is closed and the file
+ * opened again: it may have been written since by another connection.
+ */
+static Snapshot* meh_db_get_snapshot(DB* db) {
+	g_assert(db != NULL);
+
+	if (!db->use_snapshot) {
+		return NULL;
+	}
+
+	gint64 version = meh_db_get_catalog_version(db);
+	if (version < 0) {
+		return NULL;
+	}
+
+	if (db->snapshot != NULL) {
+		if (db->snapshot->version == version) {
+			return db->snapshot;
+		}
+		meh_snapshot_close(db->snapshot);
+		db->snapshot = NULL;
+	}
+
+	db->snapshot = meh_snapshot_open(db->snapshot_filename, version);
+	return db->snapshot;
+}
+
+/*
+ * meh_db_write_snapshot writes the snapshot of the catalog if the
+ * existing one is stale. The catalog is read in one transaction
+ * to write a consistent snapshot of its version.
+ */
+gboolean meh_db_write_snapshot(DB* db) {
+	g_assert(db != NULL);
+
+	if (!db->use_snapshot || db->read_only) {
+		return FALSE;
+	}
+
+	gint64 start = g_get_monotonic_time();
+
+	if (!meh_db_step_once(db, MEH_DB_QUERY_BEGIN_READ)) {
+		return FALSE;
+	}
+
+	gint64 version = meh_db_get_catalog_version(db);
+	if (version < 0 || meh_db_get_snapshot(db) != NULL) {
+		/* nothing to write or already up-to-date. */
+		meh_db_step_once(db, MEH_DB_QUERY_COMMIT);
+		return version >= 0;
+	}
+
+	SnapshotWriter* writer = meh_snapshot_writer_new(version);
+
+	/* a partial snapshot would be trusted as the catalog of its version:
+	 * nothing is saved on any error while reading. */
+	GQueue* platforms = meh_db_read_platforms(db);
+	if (platforms == NULL) {
+		meh_db_rollback(db);
+		meh_snapshot_writer_destroy(writer);
+		return FALSE;
+	}
+
+	for (GList* l = platforms->head; l != NULL; l = l->next) {
+		meh_snapshot_writer_add_platform(writer, l->data);
+	}
+	meh_model_platforms_destroy(platforms);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_SNAPSHOT_EXECUTABLES);
+	if (statement == NULL) {
+		meh_db_rollback(db);
+		meh_snapshot_writer_destroy(writer);
+		return FALSE;
+	}
+
+	/* the rows are ordered by executable, its resources on consecutive rows. */
+	int last_id = -1;
+	int return_code = SQLITE_OK;
+	while ((return_code = sqlite3_step(statement)) == SQLITE_ROW) {
+		int id = sqlite3_column_int(statement, 1);
+		if (id != last_id) {
+			last_id = id;
+			meh_snapshot_writer_add_executable(writer,
+					sqlite3_column_int(statement, 0),
+					id,
+					(const gchar*)sqlite3_column_text(statement, 2),
+					sqlite3_column_int(statement, 3) > 0 ? TRUE : FALSE,
+					sqlite3_column_int64(statement, 4));
+		}
+
+		if (sqlite3_column_type(statement, 5) == SQLITE_NULL) {
+			continue;
+		}
+
+		meh_snapshot_writer_add_resource(writer,
+				sqlite3_column_int(statement, 5),
+				sqlite3_column_int(statement, 6),
+				(const gchar*)sqlite3_column_text(statement, 7));
+	}
+
+	if (return_code != SQLITE_DONE) {
+		g_critical("Can't read the executables of the catalog snapshot: %s", sqlite3_errmsg(db->sqlite));
+		meh_db_release_statement(statement);
+		meh_db_rollback(db);
+		meh_snapshot_writer_destroy(writer);
+		return FALSE;
+	}
+
+	meh_db_release_statement(statement);
+	meh_db_step_once(db, MEH_DB_QUERY_COMMIT);
+
+	gboolean saved = meh_snapshot_writer_save(writer, db->snapshot_filename);
+	if (saved) {
+		g_message("Catalog snapshot written: %u platforms, %u executables, %u resources, %u KB of strings in %" G_GINT64_FORMAT "ms.",
+				writer->platforms->len, writer->executables->len, writer->resources->len,
+				(guint)(writer->strings->len / 1024), (g_get_monotonic_time() - start) / 1000);
+	}
+
+	meh_snapshot_writer_destroy(writer);
+
+	return saved;
+}
+
+/*
+ * meh_db_get_data_version returns a value changing every time another
+ * connection commits a change in the database, -1 on error.
+ */
+gint64 meh_db_get_data_version(DB* db) {
+	g_assert(db != NULL);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_DATA_VERSION);
+	if (statement == NULL) {
+		return -1;
+	}
+
+	gint64 version = -1;
+	if (sqlite3_step(statement) == SQLITE_ROW) {
+		version = sqlite3_column_int64(statement, 0);
+	}
+
+	meh_db_release_statement(statement);
+	return version;
+}
+
+/*
+ * meh_db_get_last_catalog_change returns the id of the last change
+ * logged in the catalog, 0 if none.
+ */
+gint64 meh_db_get_last_catalog_change(DB* db) {
+	g_assert(db != NULL);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_LAST_CATALOG_CHANGE);
+	if (statement == NULL) {
+		return 0;
+	}
+
+	gint64 id = 0;
+	if (sqlite3_step(statement) == SQLITE_ROW) {
+		id = sqlite3_column_int64(statement, 0);
+	}
+
+	meh_db_release_statement(statement);
+	return id;
+}
+
+/*
+ * meh_db_get_catalog_changes returns the CatalogChange* logged after
+ * the change `since`, in order, to free with g_queue_free_full.
+ * Returns NULL if some of them have been deleted by the maintenance:
+ * everything must be read again.
+ */
+GQueue* meh_db_get_catalog_changes(DB* db, gint64 since) {
+	g_assert(db != NULL);
+
+	/* a read transaction: no change can be deleted between both queries. */
+	if (!meh_db_step_once(db, MEH_DB_QUERY_BEGIN_READ)) {
+		return NULL;
+	}
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_FIRST_CATALOG_CHANGE);
+	if (statement == NULL) {
+		meh_db_rollback(db);
+		return NULL;
+	}
+
+	gboolean deleted = FALSE;
+	if (sqlite3_step(statement) == SQLITE_ROW && sqlite3_column_type(statement, 0) != SQLITE_NULL) {
+		deleted = sqlite3_column_int64(statement, 0) > since + 1;
+	}
+	meh_db_release_statement(statement);
+
+	statement = deleted ? NULL : meh_db_get_statement(db, MEH_DB_QUERY_GET_CATALOG_CHANGES);
+	if (statement == NULL) {
+		meh_db_rollback(db);
+		return NULL;
+	}
+
+	sqlite3_bind_int64(statement, 1, since);
+
+	GQueue* changes = g_queue_new();
+	while (sqlite3_step(statement) == SQLITE_ROW) {
+		CatalogChange* change = g_new(CatalogChange, 1);
+		change->id = sqlite3_column_int64(statement, 0);
+		change->kind = sqlite3_column_int(statement, 1);
+		change->platform_id = sqlite3_column_type(statement, 2) == SQLITE_NULL ? -1 : sqlite3_column_int(statement, 2);
+		change->executable_id = sqlite3_column_type(statement, 3) == SQLITE_NULL ? -1 : sqlite3_column_int(statement, 3);
+		g_queue_push_tail(changes, change);
+	}
+
+	meh_db_release_statement(statement);
+	meh_db_step_once(db, MEH_DB_QUERY_COMMIT);
+
+	return changes;
+}
+
+/*
+ * meh_db_get_executable reads the slim executable with the given id, with
+ * its platform_id and its resources. Returns NULL if it doesn't exist.
+ */
+Executable* meh_db_get_executable(DB* db, int executable_id) {
+	g_assert(db != NULL);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_EXECUTABLE);
+	if (statement == NULL) {
+		return NULL;
+	}
+
+	sqlite3_bind_int(statement, 1, executable_id);
+
+	Executable* executable = NULL;
+	if (sqlite3_step(statement) == SQLITE_ROW) {
+		executable = meh_db_read_slim_executable(statement);
+		executable->platform_id = sqlite3_column_int(statement, 4);
+	}
+
+	meh_db_release_statement(statement);
+
+	if (executable != NULL) {
+		meh_db_read_executable_resources(db, executable);
+	}
+
+	return executable;
+}
+
+/*
+ * meh_db_begin_bulk_insert starts a transaction for many inserts, much
+ * faster when grouped. The search index and the executables count of the
+ * platforms aren't updated by each insert of executable during the
+ * transaction, see meh_db_commit_bulk_insert.
+ */
+gboolean meh_db_begin_bulk_insert(DB* db) {
+	g_assert(db != NULL);
+
+	if (!meh_db_step_once(db, MEH_DB_QUERY_BEGIN)) {
+		return FALSE;
+	}
+
+	if (!meh_db_step_once(db, MEH_DB_QUERY_START_BULK_INSERT)) {
+		meh_db_rollback(db);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*
+ * meh_db_commit_bulk_insert counts, indexes at once for the search and logs
+ * as changes of their platforms the executables inserted since the given
+ * id (-1 if none), then commits the bulk insert.
+ */
+gboolean meh_db_commit_bulk_insert(DB* db, int first_executable_id) {
+	g_assert(db != NULL);
+
+	const int queries[] = { MEH_DB_QUERY_COUNT_INSERTED_EXECUTABLES, MEH_DB_QUERY_INDEX_EXECUTABLES, MEH_DB_QUERY_LOG_INSERTED_EXECUTABLES };
+
+	for (int i = 0; first_executable_id != -1 && i < G_N_ELEMENTS(queries); i++) {
+		sqlite3_stmt* statement = meh_db_get_statement(db, queries[i]);
+		if (statement == NULL) {
+			meh_db_rollback(db);
+			return FALSE;
+		}
+
+		sqlite3_bind_int(statement, 1, first_executable_id);
+		int return_code = sqlite3_step(statement);
+		meh_db_release_statement(statement);
+
+		if (return_code != SQLITE_DONE) {
+			g_critical("Can't count, index and log the inserted executables: %s", sqlite3_errmsg(db->sqlite));
+			meh_db_rollback(db);
+			return FALSE;
+		}
+	}
+
+	if (!meh_db_step_once(db, MEH_DB_QUERY_STOP_BULK_INSERT) || !meh_db_step_once(db, MEH_DB_QUERY_COMMIT)) {
+		meh_db_rollback(db);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*
+ * meh_db_rollback cancels the current transaction, if any.
+ */
+void meh_db_rollback(DB* db) {
+	g_assert(db != NULL);
+
+	if (!sqlite3_get_autocommit(db->sqlite)) {
+		meh_db_step_once(db, MEH_DB_QUERY_ROLLBACK);
+	}
+}
+
+/*
+ * meh_db_get_executable_id looks for the executable of the
+ * platform launching the given file.
+ * Returns -1 if there is none.
+ */
+int meh_db_get_executable_id(DB* db, int platform_id, const gchar* filepath) {
+	g_assert(db != NULL);
+	g_assert(filepath != NULL);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_EXECUTABLE_ID);
+	if (statement == NULL) {
+		return -1;
+	}
+
+	sqlite3_bind_int(statement, 1, platform_id);
+	sqlite3_bind_text(statement, 2, filepath, -1, NULL);
+
+	int id = -1;
+	if (sqlite3_step(statement) == SQLITE_ROW) {
+		id = sqlite3_column_int(statement, 0);
+	}
+
+	meh_db_release_statement(statement);
+	return id;
+}
+
+/*
+ * meh_db_insert_executable inserts an executable in the given platform,
+ * the NULL values are stored as NULL, the sort key is computed by the insert.
+ * Returns the id of the new executable, -1 on error.
+ */
+int meh_db_insert_executable(DB* db, int platform_id, const gchar* display_name, const gchar* filepath,
+		const gchar* description, const gchar* genres, const gchar* publisher,
+		const gchar* developer, const gchar* release_date, const gchar* rating,
+		const gchar* players, gboolean favorite) {
+	g_assert(db != NULL);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_INSERT_EXECUTABLE);
+	if (statement == NULL) {
+		return -1;
+	}
+
+	/* the strings outlive the step: no copy by SQLite. */
+	sqlite3_bind_text(statement, 1, display_name, -1, NULL);
+	sqlite3_bind_text(statement, 2, filepath, -1, NULL);
+	sqlite3_bind_int(statement, 3, platform_id);
+	sqlite3_bind_text(statement, 4, description, -1, NULL);
+	sqlite3_bind_text(statement, 5, genres, -1, NULL);
+	sqlite3_bind_text(statement, 6, publisher, -1, NULL);
+	sqlite3_bind_text(statement, 7, developer, -1, NULL);
+	sqlite3_bind_text(statement, 8, release_date, -1, NULL);
+	sqlite3_bind_text(statement, 9, rating, -1, NULL);
+	sqlite3_bind_text(statement, 10, players, -1, NULL);
+	sqlite3_bind_int(statement, 11, favorite == TRUE ? 1 : 0);
+
+	int return_code = sqlite3_step(statement);
+	meh_db_release_statement(statement);
+
+	if (return_code != SQLITE_DONE) {
+		g_critical("Can't insert the executable '%s': %s", display_name, sqlite3_errmsg(db->sqlite));
+		return -1;
+	}
+
+	return (int)sqlite3_last_insert_rowid(db->sqlite);
+}
+
+/*
+ * meh_db_insert_executable_resource inserts a resource of an executable,
+ * `type` is one of the MEH_EXEC_RES_*.
+ */
+gboolean meh_db_insert_executable_resource(DB* db, int executable_id, int type, const gchar* filepath) {
+	g_assert(db != NULL);
+	g_assert(filepath != NULL);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_INSERT_EXECUTABLE_RESOURCE);
+	if (statement == NULL) {
+		return FALSE;
+	}
+
+	sqlite3_bind_int(statement, 1, executable_id);
+	sqlite3_bind_text(statement, 2, meh_model_exec_res_type_name(type), -1, NULL);
+	sqlite3_bind_text(statement, 3, filepath, -1, NULL);
+	sqlite3_bind_int(statement, 4, type);
+
+	int return_code = sqlite3_step(statement);
+	meh_db_release_statement(statement);
+
+	if (return_code != SQLITE_DONE) {
+		g_critical("Can't insert the resource '%s' of the executable %d: %s", filepath, executable_id, sqlite3_errmsg(db->sqlite));
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*
+ * meh_db_get_platform_files reads the files of the executables of
+ * the platform.
+ * Returns a table of the filepath to its ExecutableFile, NULL on error,
+ * must be freed with g_hash_table_destroy.
+ */
+GHashTable* meh_db_get_platform_files(DB* db, int platform_id) {
+	g_assert(db != NULL);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_PLATFORM_FILES);
+	if (statement == NULL) {
+		return NULL;
+	}
+
+	GHashTable* files = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+	sqlite3_bind_int(statement, 1, platform_id);
+
+	while (sqlite3_step(statement) == SQLITE_ROW) {
+		const char* filepath = (const char*)sqlite3_column_text(statement, 1);
+		if (filepath == NULL) {
+			continue;
+		}
+
+		ExecutableFile* file = g_new(ExecutableFile, 1);
+		file->id = sqlite3_column_int(statement, 0);
+		file->missing = sqlite3_column_int(statement, 2) > 0 ? TRUE : FALSE;
+		g_hash_table_replace(files, g_strdup(filepath), file);
+	}
+
+	meh_db_release_statement(statement);
+	return files;
+}
+
+gboolean meh_db_set_executable_missing(DB* db, int executable_id, gboolean missing) {
+	g_assert(db != NULL);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_SET_EXECUTABLE_MISSING);
+	if (statement == NULL) {
+		return FALSE;
+	}
+
+	sqlite3_bind_int(statement, 1, missing == TRUE ? 1 : 0);
+	sqlite3_bind_int(statement, 2, executable_id);
+
+	int return_code = sqlite3_step(statement);
+	meh_db_release_statement(statement);
+
+	return return_code == SQLITE_DONE;
+}
+
+/*
+ * meh_db_get_scan_directories reads the directories of the platform
+ * scanned by the last scan.
+ * Returns a table of the path to its mtime (gint64*), NULL on error,
+ * must be freed with g_hash_table_destroy.
+ */
+GHashTable* meh_db_get_scan_directories(DB* db, int platform_id) {
+	g_assert(db != NULL);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_SCAN_DIRECTORIES);
+	if (statement == NULL) {
+		return NULL;
+	}
+
+	GHashTable* directories = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+	sqlite3_bind_int(statement, 1, platform_id);
+
+	while (sqlite3_step(statement) == SQLITE_ROW) {
+		const char* path = (const char*)sqlite3_column_text(statement, 0);
+		gint64* mtime = g_new(gint64, 1);
+		*mtime = sqlite3_column_int64(statement, 1);
+		g_hash_table_replace(directories, g_strdup(path), mtime);
+	}
+
+	meh_db_release_statement(statement);
+	return directories;
+}
+
+gboolean meh_db_save_scan_directory(DB* db, int platform_id, const gchar* path, gint64 mtime) {
+	g_assert(db != NULL);
+	g_assert(path != NULL);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_SAVE_SCAN_DIRECTORY);
+	if (statement == NULL) {
+		return FALSE;
+	}
+
+	sqlite3_bind_int(statement, 1, platform_id);
+	sqlite3_bind_text(statement, 2, path, -1, NULL);
+	sqlite3_bind_int64(statement, 3, mtime);
+
+	int return_code = sqlite3_step(statement);
+	meh_db_release_statement(statement);
+
+	return return_code == SQLITE_DONE;
+}
+
+gboolean meh_db_delete_scan_directory(DB* db, int platform_id, const gchar* path) {
+	g_assert(db != NULL);
+	g_assert(path != NULL);
+
+	sqlite3_stmt* statement = meh_db_get_statement(db, MEH_DB_QUERY_DELETE_SCAN_DIRECTORY);
+	if (statement == NULL) {
+		return FALSE;
+	}
+
+	sqlite3_bind_int(statement, 1, platform_id);
+	sqlite3_bind_text(statement, 2, path, -1, NULL);
+
+	int return_code = sqlite3_step(statement);
+	meh_db_release_statement(statement);
+
+	return return_code == SQLITE_DONE;
+}
+
+/*
+ * meh_db_read_executable_resources reads in the SQLite3 database all the resources
+ * available for the given executable, which must not be part of a catalog.
+ */
+static gboolean meh_db_read_executable_resources(DB* db, Executable* executable) {
+	g_assert(db != NULL);
+	g_assert(executable != NULL);
+
+	sqlite3_stmt *statement = meh_db_get_statement(db, MEH_DB_QUERY_GET_EXECUTABLE_RESOURCES);
+	if (statement == NULL) {
+		return FALSE;
+	}
+
+	sqlite3_bind_int(statement, 1, executable->id);
+
+	/*
+	 * read every row
+	 */
+	while (sqlite3_step(statement) == SQLITE_ROW) {
+		/* read column */
+		int id = sqlite3_column_int(statement, 0);
+		int type = sqlite3_column_int(statement, 2);
+		const char* filepath = (const char*)sqlite3_column_text(statement, 3);
+		meh_model_executable_add_resource(executable, id, type, filepath);
+	}
+
+	/* we're done with this statement. */
+	meh_db_release_statement(statement);
+
+	return TRUE;
 }
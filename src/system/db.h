@@ -3,25 +3,143 @@
 #include <glib.h>
 #include <sqlite3.h>
 
+#include "system/settings.h"
+
 struct Platform;
 struct Executable;
 struct Mapping;
+struct Snapshot;
+struct DBProfile;
+
+/*
+ * Ids of the queries for which the prepared statement
+ * is kept in the DB statements cache.
+ */
+#define MEH_DB_QUERY_GET_PLATFORMS 0
+#define MEH_DB_QUERY_GET_PLATFORM 1
+#define MEH_DB_QUERY_GET_PLATFORM_EXECUTABLES 2
+#define MEH_DB_QUERY_COUNT_PLATFORM_EXECUTABLES 3
+#define MEH_DB_QUERY_GET_EXECUTABLE_RESOURCES 4
+#define MEH_DB_QUERY_SET_EXECUTABLE_FAVORITE 5
+#define MEH_DB_QUERY_COUNT_MAPPING 6
+#define MEH_DB_QUERY_GET_MAPPING 7
+#define MEH_DB_QUERY_SAVE_MAPPING 8
+#define MEH_DB_QUERY_DELETE_MAPPING 9
+#define MEH_DB_QUERY_GET_PLATFORM_EXECUTABLES_WITH_RESOURCES 10
+#define MEH_DB_QUERY_EXECUTABLES_PAGE_FIRST 11
+#define MEH_DB_QUERY_EXECUTABLES_PAGE_FROM 12
+#define MEH_DB_QUERY_EXECUTABLES_PAGE_AFTER 13
+#define MEH_DB_QUERY_EXECUTABLES_PAGE_LAST 14
+#define MEH_DB_QUERY_EXECUTABLES_PAGE_BEFORE 15
+#define MEH_DB_QUERY_EXECUTABLE_POSITION 16
+#define MEH_DB_QUERY_GET_EXECUTABLE_DETAILS 17
+#define MEH_DB_QUERY_SEARCH_COUNT 18
+#define MEH_DB_QUERY_SEARCH_RANKED 19
+#define MEH_DB_QUERY_SEARCH 20
+#define MEH_DB_QUERY_BEGIN 21
+#define MEH_DB_QUERY_COMMIT 22
+#define MEH_DB_QUERY_ROLLBACK 23
+#define MEH_DB_QUERY_START_BULK_INSERT 24
+#define MEH_DB_QUERY_STOP_BULK_INSERT 25
+#define MEH_DB_QUERY_INDEX_EXECUTABLES 26
+#define MEH_DB_QUERY_GET_EXECUTABLE_ID 27
+#define MEH_DB_QUERY_INSERT_EXECUTABLE 28
+#define MEH_DB_QUERY_INSERT_EXECUTABLE_RESOURCE 29
+#define MEH_DB_QUERY_GET_PLATFORM_FILES 30
+#define MEH_DB_QUERY_SET_EXECUTABLE_MISSING 31
+#define MEH_DB_QUERY_GET_SCAN_DIRECTORIES 32
+#define MEH_DB_QUERY_SAVE_SCAN_DIRECTORY 33
+#define MEH_DB_QUERY_DELETE_SCAN_DIRECTORY 34
+#define MEH_DB_QUERY_COUNT_INSERTED_EXECUTABLES 35
+#define MEH_DB_QUERY_RECORD_EXECUTABLE_LAUNCH 36
+#define MEH_DB_QUERY_ADD_EXECUTABLE_PLAY_TIME 37
+#define MEH_DB_QUERY_GET_RECENT_EXECUTABLES 38
+#define MEH_DB_QUERY_GET_CATALOG_VERSION 39
+#define MEH_DB_QUERY_BEGIN_READ 40
+#define MEH_DB_QUERY_GET_SNAPSHOT_EXECUTABLES 41
+#define MEH_DB_QUERY_LOG_INSERTED_EXECUTABLES 42
+#define MEH_DB_QUERY_GET_DATA_VERSION 43
+#define MEH_DB_QUERY_GET_LAST_CATALOG_CHANGE 44
+#define MEH_DB_QUERY_GET_FIRST_CATALOG_CHANGE 45
+#define MEH_DB_QUERY_GET_CATALOG_CHANGES 46
+#define MEH_DB_QUERY_GET_EXECUTABLE 47
+#define MEH_DB_QUERY_END 48
+
+/*
+ * Kinds of the rows changed in the catalog.
+ */
+#define MEH_CATALOG_CHANGE_PLATFORM 0
+#define MEH_CATALOG_CHANGE_EXECUTABLE 1
+#define MEH_CATALOG_CHANGE_RESOURCES 2
 
 typedef struct DB {
 	/* filename of the DB to use. */
 	const char* filename;
 	/* an opened db. */
 	sqlite3* sqlite; 
+	/* opened in read-only or immutable mode. */
+	gboolean read_only;
+	/* prepared statements, indexed by query id, NULL until
+	 * their first use. Finalized when the DB is closed. */
+	sqlite3_stmt* statements[MEH_DB_QUERY_END];
+	/* snapshot of the catalog used instead of the queries while it's
+	 * up-to-date, NULL if not opened yet or stale. */
+	gboolean use_snapshot;
+	gchar* snapshot_filename;
+	struct Snapshot* snapshot;
+	/* statistics of the executed statements, NULL if not profiled. */
+	struct DBProfile* profile;
 } DB;
 
-DB* meh_db_open_or_create(const char* filename);
+/* a row of the catalog changed by any connection, see meh_db_get_catalog_changes */
+typedef struct CatalogChange {
+	gint64 id;
+	int kind;
+	int platform_id;
+	int executable_id; /* -1 for a platform, or for every executable of the platform after a bulk insert */
+} CatalogChange;
+
+/* an executable file known in a platform, see meh_db_get_platform_files */
+typedef struct ExecutableFile {
+	int id;
+	gboolean missing;
+} ExecutableFile;
+
+DB* meh_db_open_or_create(const char* filename, Settings settings);
 void meh_db_close(DB* db);
 GQueue* meh_db_get_platforms(DB* db);
 struct Platform* meh_db_get_platform(DB* db, int platform_id);
 GQueue* meh_db_get_platform_executables(DB* db, const struct Platform* platform, gboolean get_resources);
 int meh_db_count_platform_executables(DB* db, const struct Platform* platform);
-GQueue* meh_db_get_executable_resources(DB* db, const struct Executable* executable);
-gboolean meh_db_set_executable_favorite(DB* db, const struct Executable* executable, gboolean favorite);
+GQueue* meh_db_get_executables_from(DB* db, const struct Platform* platform, int executable_id, int limit);
+GQueue* meh_db_get_executables_after(DB* db, const struct Platform* platform, int executable_id, int limit);
+GQueue* meh_db_get_executables_before(DB* db, const struct Platform* platform, int executable_id, int limit);
+int meh_db_get_executable_position(DB* db, const struct Platform* platform, int executable_id);
+gboolean meh_db_hydrate_executable(DB* db, struct Executable* executable);
+GQueue* meh_db_search_executables(DB* db, int platform_id, const gchar* text, int limit);
+gboolean meh_db_set_executable_favorite(DB* db, int executable_id, gboolean favorite, gint64* catalog_change_id);
+gboolean meh_db_record_executable_launch(DB* db, int executable_id, gint64 played_at);
+gboolean meh_db_add_executable_play_time(DB* db, int executable_id, int seconds);
+GQueue* meh_db_get_recent_executables(DB* db, int limit);
+gboolean meh_db_write_snapshot(DB* db);
+gint64 meh_db_get_data_version(DB* db);
+gint64 meh_db_get_last_catalog_change(DB* db);
+GQueue* meh_db_get_catalog_changes(DB* db, gint64 since);
+struct Executable* meh_db_get_executable(DB* db, int executable_id);
+gboolean meh_db_begin_bulk_insert(DB* db);
+gboolean meh_db_commit_bulk_insert(DB* db, int first_executable_id);
+void meh_db_rollback(DB* db);
+int meh_db_get_executable_id(DB* db, int platform_id, const gchar* filepath);
+int meh_db_insert_executable(DB* db, int platform_id, const gchar* display_name, const gchar* filepath,
+		const gchar* description, const gchar* genres, const gchar* publisher,
+		const gchar* developer, const gchar* release_date, const gchar* rating,
+		const gchar* players, gboolean favorite);
+gboolean meh_db_insert_executable_resource(DB* db, int executable_id, int type, const gchar* filepath);
+GHashTable* meh_db_get_platform_files(DB* db, int platform_id);
+gboolean meh_db_set_executable_missing(DB* db, int executable_id, gboolean missing);
+GHashTable* meh_db_get_scan_directories(DB* db, int platform_id);
+gboolean meh_db_save_scan_directory(DB* db, int platform_id, const gchar* path, gint64 mtime);
+gboolean meh_db_delete_scan_directory(DB* db, int platform_id, const gchar* path);
 void meh_db_delete_mapping(DB* db, gchar* id);
 struct Mapping* meh_db_get_mapping(DB* db, const gchar* id);
 void meh_db_save_mapping(DB* db, struct Mapping* mapping);
@@ -0,0 +1,237 @@
+#include <string.h>
+#include <glib.h>
+
+#include "system/db/catalog.h"
+
+static guint32 meh_model_catalog_builder_add_string(CatalogBuilder* builder, const gchar* str);
+static const gchar* meh_model_catalog_string(const gchar* strings, guint32 offset);
+
+/*
+ * meh_model_catalog_builder_new starts a catalog, `size` is the expected
+ * amount of executables (0 if unknown).
+ */
+CatalogBuilder* meh_model_catalog_builder_new(guint size) {
+	CatalogBuilder* builder = g_new(CatalogBuilder, 1);
+
+	builder->ids = g_array_sized_new(FALSE, FALSE, sizeof(gint32), size);
+	builder->favorites = g_array_sized_new(FALSE, FALSE, sizeof(guint8), size);
+	builder->last_played = g_array_sized_new(FALSE, FALSE, sizeof(gint64), size);
+	builder->display_names = g_array_sized_new(FALSE, FALSE, sizeof(guint32), size);
+	builder->first_resources = g_array_sized_new(FALSE, FALSE, sizeof(guint32), size);
+
+	builder->resources_ids = g_array_sized_new(FALSE, FALSE, sizeof(gint32), size);
+	builder->resources_types = g_array_sized_new(FALSE, FALSE, sizeof(guint8), size);
+	builder->resources_filepaths = g_array_sized_new(FALSE, FALSE, sizeof(guint32), size);
+
+	/* a name and some resources paths by executable */
+	builder->strings = g_string_sized_new(size * 64);
+
+	return builder;
+}
+
+void meh_model_catalog_builder_add_executable(CatalogBuilder* builder, int id, const gchar* display_name,
+		gboolean favorite, gint64 last_played) {
+	g_assert(builder != NULL);
+
+	gint32 record_id = id;
+	guint8 record_favorite = favorite ? 1 : 0;
+	guint32 name = meh_model_catalog_builder_add_string(builder, display_name);
+	guint32 first_resource = builder->resources_ids->len;
+
+	g_array_append_val(builder->ids, record_id);
+	g_array_append_val(builder->favorites, record_favorite);
+	g_array_append_val(builder->last_played, last_played);
+	g_array_append_val(builder->display_names, name);
+	g_array_append_val(builder->first_resources, first_resource);
+}
+
+/*
+ * meh_model_catalog_builder_add_resource adds a resource
+ * to the last executable added.
+ */
+void meh_model_catalog_builder_add_resource(CatalogBuilder* builder, int id, int type, const gchar* filepath) {
+	g_assert(builder != NULL);
+	g_assert(builder->ids->len > 0);
+
+	gint32 record_id = id;
+	guint8 record_type = type >= 0 && type < MEH_EXEC_RES_TYPES ? type : MEH_EXEC_RES_OTHER;
+	guint32 record_filepath = meh_model_catalog_builder_add_string(builder, filepath);
+
+	g_array_append_val(builder->resources_ids, record_id);
+	g_array_append_val(builder->resources_types, record_type);
+	g_array_append_val(builder->resources_filepaths, record_filepath);
+}
+
+/*
+ * meh_model_catalog_builder_add_string copies the string at the end
+ * of the strings arena, returns its offset.
+ */
+static guint32 meh_model_catalog_builder_add_string(CatalogBuilder* builder, const gchar* str) {
+	if (str == NULL) {
+		return MEH_CATALOG_NULL_STRING;
+	}
+
+	guint32 offset = builder->strings->len;
+	g_string_append_len(builder->strings, str, strlen(str) + 1);
+	return offset;
+}
+
+static const gchar* meh_model_catalog_string(const gchar* strings, guint32 offset) {
+	return offset == MEH_CATALOG_NULL_STRING ? NULL : strings + offset;
+}
+
+/*
+ * meh_model_catalog_builder_finish creates the catalog of the added
+ * executables and frees the builder. Returns the executables, in the
+ * order they have been added, to destroy with meh_model_executable_destroy.
+ */
+GQueue* meh_model_catalog_builder_finish(CatalogBuilder* builder) {
+	g_assert(builder != NULL);
+
+	GQueue* executables = g_queue_new();
+	guint length = builder->ids->len;
+	guint resources_length = builder->resources_ids->len;
+
+	Catalog* catalog = NULL;
+	if (length > 0) {
+		catalog = g_new(Catalog, 1);
+		catalog->length = length;
+		catalog->resources_length = resources_length;
+		catalog->alive = length;
+		catalog->metadata = NULL;
+		catalog->metadata_strings = NULL;
+		catalog->interned_lookups = 0;
+		catalog->interned_hits = 0;
+		catalog->interned_saved = 0;
+		catalog->executables = g_new0(Executable, length);
+		catalog->resources = g_new(ExecutableResource, resources_length);
+		catalog->strings = g_string_free(builder->strings, FALSE);
+		builder->strings = NULL;
+	}
+
+	for (guint i = 0; i < length; i++) {
+		Executable* executable = &catalog->executables[i];
+		guint32 first_resource = g_array_index(builder->first_resources, guint32, i);
+		guint32 end_resource = i + 1 < length ? g_array_index(builder->first_resources, guint32, i + 1) : resources_length;
+
+		executable->id = g_array_index(builder->ids, gint32, i);
+		executable->display_name = (gchar*)meh_model_catalog_string(catalog->strings,
+				g_array_index(builder->display_names, guint32, i));
+		executable->favorite = g_array_index(builder->favorites, guint8, i) > 0 ? TRUE : FALSE;
+		executable->last_played = g_array_index(builder->last_played, gint64, i);
+		executable->platform_id = -1;
+		executable->hydrated = FALSE;
+		executable->catalog = catalog;
+		executable->resources = end_resource > first_resource ? &catalog->resources[first_resource] : NULL;
+		executable->resources_count = end_resource - first_resource;
+
+		/* groups the resources by type, keeping their order in a type. */
+		int positions[MEH_EXEC_RES_TYPES] = { 0 };
+		for (guint32 j = first_resource; j < end_resource; j++) {
+			guint8 type = g_array_index(builder->resources_types, guint8, j);
+			for (int t = type + 1; t < MEH_EXEC_RES_TYPES; t++) {
+				positions[t]++;
+			}
+		}
+		memcpy(executable->resources_by_type, positions, sizeof(positions));
+
+		for (guint32 j = first_resource; j < end_resource; j++) {
+			guint8 type = g_array_index(builder->resources_types, guint8, j);
+			ExecutableResource* resource = &executable->resources[positions[type]++];
+			resource->id = g_array_index(builder->resources_ids, gint32, j);
+			resource->executable_id = executable->id;
+			resource->type = type;
+			resource->filepath = (gchar*)meh_model_catalog_string(catalog->strings,
+					g_array_index(builder->resources_filepaths, guint32, j));
+		}
+
+		g_queue_push_tail(executables, executable);
+	}
+
+	g_array_free(builder->ids, TRUE);
+	g_array_free(builder->favorites, TRUE);
+	g_array_free(builder->last_played, TRUE);
+	g_array_free(builder->display_names, TRUE);
+	g_array_free(builder->first_resources, TRUE);
+	g_array_free(builder->resources_ids, TRUE);
+	g_array_free(builder->resources_types, TRUE);
+	g_array_free(builder->resources_filepaths, TRUE);
+	if (builder->strings != NULL) {
+		g_string_free(builder->strings, TRUE);
+	}
+	g_free(builder);
+
+	return executables;
+}
+
+/*
+ * meh_model_catalog_intern returns the copy of the string stored by the
+ * catalog, the same one for every equal string. It must not be freed.
+ */
+const gchar* meh_model_catalog_intern(Catalog* catalog, const gchar* str) {
+	g_assert(catalog != NULL);
+
+	if (str == NULL) {
+		return NULL;
+	}
+
+	if (catalog->metadata == NULL) {
+		catalog->metadata = g_string_chunk_new(MEH_CATALOG_METADATA_CHUNK);
+		catalog->metadata_strings = g_hash_table_new(g_str_hash, g_str_equal);
+	}
+
+	catalog->interned_lookups++;
+
+	const gchar* interned = g_hash_table_lookup(catalog->metadata_strings, str);
+	if (interned != NULL) {
+		catalog->interned_hits++;
+		catalog->interned_saved += strlen(str) + 1;
+		return interned;
+	}
+
+	gchar* copy = g_string_chunk_insert(catalog->metadata, str);
+	g_hash_table_insert(catalog->metadata_strings, copy, copy);
+	return copy;
+}
+
+/*
+ * meh_model_catalog_owns returns TRUE if the string has been
+ * interned by the catalog.
+ */
+gboolean meh_model_catalog_owns(const Catalog* catalog, const gchar* str) {
+	g_assert(catalog != NULL);
+
+	if (str == NULL || catalog->metadata_strings == NULL) {
+		return FALSE;
+	}
+
+	return g_hash_table_lookup(catalog->metadata_strings, str) == str;
+}
+
+/*
+ * meh_model_catalog_release is called when one of the executables
+ * of the catalog is destroyed, the catalog is freed with the last one.
+ */
+void meh_model_catalog_release(Catalog* catalog) {
+	g_assert(catalog != NULL);
+	g_assert(catalog->alive > 0);
+
+	catalog->alive--;
+	if (catalog->alive > 0) {
+		return;
+	}
+
+	if (catalog->metadata != NULL) {
+		g_debug("Catalog of %u executables: %u metadata strings interned, %u%% of hits on %u lookups, %" G_GSIZE_FORMAT " bytes saved.",
+				catalog->length, g_hash_table_size(catalog->metadata_strings),
+				catalog->interned_hits * 100 / catalog->interned_lookups, catalog->interned_lookups,
+				catalog->interned_saved);
+		g_hash_table_destroy(catalog->metadata_strings);
+		g_string_chunk_free(catalog->metadata);
+	}
+
+	g_free(catalog->executables);
+	g_free(catalog->resources);
+	g_free(catalog->strings);
+	g_free(catalog);
+}
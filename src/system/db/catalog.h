@@ -0,0 +1,63 @@
+#pragma once
+
+#include <glib.h>
+
+#include "system/db/executable.h"
+#include "system/db/executable_resource.h"
+
+#define MEH_CATALOG_NULL_STRING G_MAXUINT32 /* offset of a NULL string */
+#define MEH_CATALOG_METADATA_CHUNK (4096) /* bytes allocated at once for the interned metadata */
+
+/*
+ * A catalog stores in a few blocks the executables of a list read at once:
+ * the executables in one array, their resources in another one and all
+ * their strings in one arena. Its Executable* are views in these arrays, the
+ * hydrated details of an executable are still owned by the executable,
+ * except its metadata which are interned in the catalog: the genres,
+ * publishers, developers... and the fallback values repeat a lot.
+ * The catalog is freed with its last executable.
+ */
+typedef struct Catalog {
+	Executable* executables;
+	guint length;
+	ExecutableResource* resources; /* grouped by executable then by type */
+	guint resources_length;
+	gchar* strings; /* NUL-terminated strings */
+	guint alive; /* executables not destroyed yet */
+
+	/* interned metadata, created with the first one. */
+	GStringChunk* metadata;
+	GHashTable* metadata_strings; /* gchar* of `metadata` -> the same gchar* */
+	guint interned_lookups;
+	guint interned_hits;
+	gsize interned_saved; /* bytes */
+} Catalog;
+
+/*
+ * Reads a catalog in one pass, the executables must be added
+ * in the list order, each one followed by its resources.
+ */
+typedef struct CatalogBuilder {
+	/* one entry by executable */
+	GArray* ids; /* gint32 */
+	GArray* favorites; /* guint8 */
+	GArray* last_played; /* gint64 */
+	GArray* display_names; /* guint32 offset in `strings` */
+	GArray* first_resources; /* guint32 index of its first resource */
+
+	/* one entry by resource */
+	GArray* resources_ids; /* gint32 */
+	GArray* resources_types; /* guint8 MEH_EXEC_RES_* */
+	GArray* resources_filepaths; /* guint32 offset in `strings` */
+
+	GString* strings;
+} CatalogBuilder;
+
+CatalogBuilder* meh_model_catalog_builder_new(guint size);
+void meh_model_catalog_builder_add_executable(CatalogBuilder* builder, int id, const gchar* display_name,
+		gboolean favorite, gint64 last_played);
+void meh_model_catalog_builder_add_resource(CatalogBuilder* builder, int id, int type, const gchar* filepath);
+GQueue* meh_model_catalog_builder_finish(CatalogBuilder* builder);
+const gchar* meh_model_catalog_intern(Catalog* catalog, const gchar* str);
+gboolean meh_model_catalog_owns(const Catalog* catalog, const gchar* str);
+void meh_model_catalog_release(Catalog* catalog);
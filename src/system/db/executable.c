@@ -1,86 +1,242 @@
 #include <string.h>
 #include <glib-2.0/glib.h>
 
+#include "system/db/catalog.h"
 #include "system/db/executable.h"
 #include "system/db/executable_resource.h"
 
-static gchar* meh_string_copy(const gchar* str, const gchar* fallback);
+static gchar* meh_string_copy(Executable* executable, const gchar* str, const gchar* fallback, gboolean intern);
+static void meh_string_free(Executable* executable, gchar* str);
 
 Executable* meh_model_executable_new(int id, const gchar* display_name, const gchar* filepath,
 		const gchar* description, const gchar* genres, const gchar* publisher,
 		const gchar* developer, const gchar* release_date, const gchar* rating, const gchar* players,
-		const gchar* extra_parameter, gboolean favorite, GDateTime* last_played) {
-	Executable* executable = g_new(Executable, 1);
+		const gchar* extra_parameter, gboolean favorite, gint64 last_played) {
+	Executable* executable = meh_model_executable_new_slim(id, display_name, favorite, last_played);
+	meh_model_executable_hydrate(executable, filepath, description, genres, publisher,
+			developer, release_date, rating, players, extra_parameter);
+	return executable;
+}
+
+/*
+ * meh_model_executable_new_slim creates an executable with only the
+ * information needed in a list, its details can later be set
+ * with meh_model_executable_hydrate.
+ */
+Executable* meh_model_executable_new_slim(int id, const gchar* display_name,
+		gboolean favorite, gint64 last_played) {
+	Executable* executable = g_new0(Executable, 1);
 
 	executable->id = id;
 	executable->display_name = g_strdup(display_name);
+	executable->favorite = favorite;
+	executable->last_played = last_played;
+	executable->platform_id = -1;
+	executable->hydrated = FALSE;
+
+	executable->resources = NULL;
+	executable->resources_count = 0;
+	for (int i = 0; i < MEH_EXEC_RES_TYPES; i++) {
+		executable->resources_by_type[i] = 0;
+	}
+	executable->catalog = NULL;
+
+	return executable;
+}
+
+/*
+ * meh_model_executable_add_resource adds a resource to an executable
+ * which isn't part of a catalog, after the other ones of its type.
+ */
+void meh_model_executable_add_resource(Executable* executable, int id, int type, const gchar* filepath) {
+	g_assert(executable != NULL);
+	g_assert(executable->catalog == NULL);
+	g_assert(type >= 0 && type < MEH_EXEC_RES_TYPES);
+
+	int position = type + 1 < MEH_EXEC_RES_TYPES ? executable->resources_by_type[type + 1] : executable->resources_count;
+
+	executable->resources = g_renew(ExecutableResource, executable->resources, executable->resources_count + 1);
+	memmove(&executable->resources[position + 1], &executable->resources[position],
+			(executable->resources_count - position) * sizeof(ExecutableResource));
+
+	ExecutableResource* resource = &executable->resources[position];
+	resource->id = id;
+	resource->executable_id = executable->id;
+	resource->type = type;
+	resource->filepath = g_strdup(filepath);
+
+	executable->resources_count++;
+	for (int i = type + 1; i < MEH_EXEC_RES_TYPES; i++) {
+		executable->resources_by_type[i]++;
+	}
+}
+
+/*
+ * meh_model_executable_get_resources returns the resources of the executable
+ * having a type between `first_type` and `last_type` (included), their
+ * amount is stored in `count`. NULL if none.
+ */
+ExecutableResource* meh_model_executable_get_resources(Executable* executable, int first_type, int last_type, int* count) {
+	g_assert(executable != NULL);
+	g_assert(count != NULL);
+	g_assert(first_type >= 0 && first_type <= last_type && last_type < MEH_EXEC_RES_TYPES);
+
+	int start = executable->resources_by_type[first_type];
+	int end = last_type + 1 < MEH_EXEC_RES_TYPES ? executable->resources_by_type[last_type + 1] : executable->resources_count;
+
+	*count = end - start;
+	return *count > 0 ? &executable->resources[start] : NULL;
+}
+
+/*
+ * meh_model_executable_compare compares two executables in the order of
+ * the lists, the one of their sort_key column: the favorites first, then the
+ * names uppercased by SQLite (ASCII only) compared byte per byte, then the ids.
+ */
+int meh_model_executable_compare(const Executable* a, const Executable* b) {
+	g_assert(a != NULL);
+	g_assert(b != NULL);
+
+	gboolean favorite_a = a->favorite ? TRUE : FALSE;
+	gboolean favorite_b = b->favorite ? TRUE : FALSE;
+	if (favorite_a != favorite_b) {
+		return favorite_a ? -1 : 1;
+	}
+
+	const gchar* name_a = a->display_name != NULL ? a->display_name : "";
+	const gchar* name_b = b->display_name != NULL ? b->display_name : "";
+	while (*name_a != '\0' && g_ascii_toupper(*name_a) == g_ascii_toupper(*name_b)) {
+		name_a++;
+		name_b++;
+	}
+
+	guchar char_a = (guchar)g_ascii_toupper(*name_a);
+	guchar char_b = (guchar)g_ascii_toupper(*name_b);
+	if (char_a != char_b) {
+		return char_a < char_b ? -1 : 1;
+	}
+
+	if (a->id == b->id) {
+		return 0;
+	}
+	return a->id < b->id ? -1 : 1;
+}
+
+/*
+ * meh_model_executable_hydrate sets the details of the executable.
+ */
+void meh_model_executable_hydrate(Executable* executable, const gchar* filepath,
+		const gchar* description, const gchar* genres, const gchar* publisher,
+		const gchar* developer, const gchar* release_date, const gchar* rating,
+		const gchar* players, const gchar* extra_parameter) {
+	g_assert(executable != NULL);
+
+	/* replaces the previous details if any */
+	meh_model_executable_dehydrate(executable);
+
 	executable->filepath = g_strdup(filepath);
 
-	executable->description = meh_string_copy(description, "No description.");
-	executable->genres = meh_string_copy(genres, "Unknown");
-	executable->publisher = meh_string_copy(publisher, "Unknown");
-	executable->developer = meh_string_copy(developer, "Unknown");
-	executable->release_date = meh_string_copy(release_date, "Unknown");
+	/* the description is nearly always unique, only its fallback is interned */
+	executable->description = meh_string_copy(executable, description, "No description.", FALSE);
+	executable->genres = meh_string_copy(executable, genres, "Unknown", TRUE);
+	executable->publisher = meh_string_copy(executable, publisher, "Unknown", TRUE);
+	executable->developer = meh_string_copy(executable, developer, "Unknown", TRUE);
+	executable->release_date = meh_string_copy(executable, release_date, "Unknown", TRUE);
 
-	executable->extra_parameter = meh_string_copy(extra_parameter, "");
-	executable->favorite = favorite;
-	executable->last_played = last_played;
+	executable->extra_parameter = meh_string_copy(executable, extra_parameter, "", TRUE);
 
 	if (g_strcmp0(rating, "0.0") == 0) {
-		executable->rating = g_strdup("No rating");
-	} else {
-		executable->rating = meh_string_copy(rating, "No rating");
+		rating = NULL;
 	}
+	executable->rating = meh_string_copy(executable, rating, "No rating", TRUE);
 
 	if (g_strcmp0(players, "0")  == 0) {
-		executable->players = g_strdup("Unknown");
-	} else {
-		executable->players = meh_string_copy(players, "Unknown");
+		players = NULL;
 	}
+	executable->players = meh_string_copy(executable, players, "Unknown", TRUE);
 
-	executable->resources = g_queue_new();
+	executable->hydrated = TRUE;
+}
 
-	return executable;
+/*
+ * meh_model_executable_dehydrate frees the details of the executable,
+ * making it a slim executable again.
+ */
+void meh_model_executable_dehydrate(Executable* executable) {
+	g_assert(executable != NULL);
+
+	g_free(executable->filepath);
+	meh_string_free(executable, executable->description);
+	meh_string_free(executable, executable->genres);
+	meh_string_free(executable, executable->publisher);
+	meh_string_free(executable, executable->developer);
+	meh_string_free(executable, executable->release_date);
+	meh_string_free(executable, executable->rating);
+	meh_string_free(executable, executable->players);
+	meh_string_free(executable, executable->extra_parameter);
+
+	executable->filepath = NULL;
+	executable->description = NULL;
+	executable->genres = NULL;
+	executable->publisher = NULL;
+	executable->developer = NULL;
+	executable->release_date = NULL;
+	executable->rating = NULL;
+	executable->players = NULL;
+	executable->extra_parameter = NULL;
+
+	executable->hydrated = FALSE;
 }
 
 /*
  * meh_string_copy copies the string or fallback to the given value.
+ * The fallback, and the string if `intern`, is interned in the catalog
+ * of the executable if any.
  */
-static gchar* meh_string_copy(const gchar* str, const gchar* fallback) {
+static gchar* meh_string_copy(Executable* executable, const gchar* str, const gchar* fallback, gboolean intern) {
 	if (str == NULL || strlen(str) == 0) {
-		return g_strdup(fallback);
+		str = fallback;
+		intern = TRUE;
+	}
+
+	if (intern && executable->catalog != NULL) {
+		return (gchar*)meh_model_catalog_intern(executable->catalog, str);
 	}
 	return g_strdup(str);
 }
 
+/*
+ * meh_string_free frees a string copied by meh_string_copy.
+ */
+static void meh_string_free(Executable* executable, gchar* str) {
+	if (executable->catalog != NULL && meh_model_catalog_owns(executable->catalog, str)) {
+		return;
+	}
+	g_free(str);
+}
+
 void meh_model_executable_destroy(Executable* executable) {
 	g_assert(executable != NULL);
 
+	meh_model_executable_dehydrate(executable);
+
+	/* stored by its catalog */
+	if (executable->catalog != NULL) {
+		meh_model_catalog_release(executable->catalog);
+		return;
+	}
+
 	/* destroy the executable resources if any. */
-	if (executable->resources != NULL) {
-		meh_model_exec_res_list_destroy(executable->resources);
+	for (int i = 0; i < executable->resources_count; i++) {
+		g_free(executable->resources[i].filepath);
 	}
+	g_free(executable->resources);
 
 	g_free(executable->display_name);
-	g_free(executable->filepath);
-	
-	g_free(executable->description);
-	g_free(executable->genres);
-	g_free(executable->publisher);
-	g_free(executable->developer);
-	g_free(executable->release_date);
-	g_free(executable->rating);
-	g_free(executable->extra_parameter);
-
-	g_date_time_unref(executable->last_played);
 
 	g_free(executable);
 }
 
 void meh_model_executables_destroy(GQueue* executables) {
-	for (unsigned int i = 0; i < g_queue_get_length(executables); i++) {
-		Executable* executable = g_queue_peek_nth(executables, i);
-		meh_model_executable_destroy(executable);
-	}
-	g_queue_free(executables);
+	g_queue_free_full(executables, (GDestroyNotify)meh_model_executable_destroy);
 }
@@ -2,6 +2,10 @@
 
 #include <glib.h>
 
+#include "system/db/executable_resource.h"
+
+struct Catalog;
+
 typedef struct Executable {
 	int id;
 	gchar* display_name;
@@ -17,15 +21,41 @@ typedef struct Executable {
 	gchar* extra_parameter;
 
 	gboolean favorite;
-	GDateTime* last_played;
+	gint64 last_played; /* unix time, 0 if never played */
+
+	/* only read by the queries listing the executables
+	 * of several platforms, -1 otherwise. */
+	int platform_id;
+
+	/* FALSE for a slim executable: only the id, display_name, favorite and
+	 * last_played are set, the other strings are NULL until hydrated. */
+	gboolean hydrated;
 
-	GQueue* resources;
+	/* array of `resources_count` resources grouped by type, NULL if none.
+	 * See meh_model_executable_get_resources. */
+	ExecutableResource* resources;
+	int resources_count;
+	int resources_by_type[MEH_EXEC_RES_TYPES]; /* index of the first resource of each type */
+
+	/* catalog storing the display name and the resources of the
+	 * executable, NULL if the executable owns them. See catalog.h */
+	struct Catalog* catalog;
 } Executable;
 
 Executable* meh_model_executable_new(int id, const gchar* display_name, const gchar* filepath,
 		const gchar* description, const gchar* genres, const gchar* publisher,
 		const gchar* developer, const gchar* release_date, const gchar* rating,
 		const gchar* players, const gchar* extra_parameter,
-		gboolean favorite, GDateTime* last_played);
+		gboolean favorite, gint64 last_played);
+Executable* meh_model_executable_new_slim(int id, const gchar* display_name,
+		gboolean favorite, gint64 last_played);
+void meh_model_executable_add_resource(Executable* executable, int id, int type, const gchar* filepath);
+ExecutableResource* meh_model_executable_get_resources(Executable* executable, int first_type, int last_type, int* count);
+int meh_model_executable_compare(const Executable* a, const Executable* b);
+void meh_model_executable_hydrate(Executable* executable, const gchar* filepath,
+		const gchar* description, const gchar* genres, const gchar* publisher,
+		const gchar* developer, const gchar* release_date, const gchar* rating,
+		const gchar* players, const gchar* extra_parameter);
+void meh_model_executable_dehydrate(Executable* executable);
 void meh_model_executable_destroy(Executable* executable);
 void meh_model_executables_destroy(GQueue* executables);
@@ -3,34 +3,37 @@
 #include "system/db/executable_resource.h"
 #include "view/image.h"
 
-ExecutableResource* meh_model_exec_res_new(int id, int executable_id, const gchar* type, const gchar* filepath) {
-	ExecutableResource* exec_res = g_new(ExecutableResource, 1);
+/* names of the types in the `type` column, indexed by MEH_EXEC_RES_* */
+static const gchar* meh_exec_res_types[MEH_EXEC_RES_TYPES] = {
+	[MEH_EXEC_RES_OTHER] = "other",
+	[MEH_EXEC_RES_FANART] = "fanart",
+	[MEH_EXEC_RES_SCREENSHOT] = "screenshot",
+	[MEH_EXEC_RES_COVER] = "cover",
+	[MEH_EXEC_RES_LOGO] = "logo",
+	[MEH_EXEC_RES_VIDEO] = "video",
+};
 
-	exec_res->id = id;
-	exec_res->executable_id = executable_id;
-	exec_res->type = g_strdup(type);
-	exec_res->filepath = g_strdup(filepath);
-
-	/* TODO Maybe we should load the real image data here ? */
-
-	return exec_res;
-}
-
-void meh_model_exec_res_destroy(ExecutableResource* exec_res) {
-	g_assert(exec_res != NULL);
-
-	g_free(exec_res->type);
-	g_free(exec_res->filepath);
-
-	g_free(exec_res);
+/*
+ * meh_model_exec_res_type returns the type having the given name,
+ * MEH_EXEC_RES_OTHER if unknown.
+ */
+int meh_model_exec_res_type(const gchar* name) {
+	for (int i = 0; i < MEH_EXEC_RES_TYPES; i++) {
+		if (g_strcmp0(name, meh_exec_res_types[i]) == 0) {
+			return i;
+		}
+	}
+	return MEH_EXEC_RES_OTHER;
 }
 
-void meh_model_exec_res_list_destroy(GQueue* exec_resources) {
-	for (unsigned int i = 0; i < g_queue_get_length(exec_resources); i++) {
-		ExecutableResource* exec_res = g_queue_peek_nth(exec_resources, i);
-		meh_model_exec_res_destroy(exec_res);
+/*
+ * meh_model_exec_res_type_name returns the name of the given type.
+ */
+const gchar* meh_model_exec_res_type_name(int type) {
+	if (type < 0 || type >= MEH_EXEC_RES_TYPES) {
+		return meh_exec_res_types[MEH_EXEC_RES_OTHER];
 	}
-	g_queue_free(exec_resources);
+	return meh_exec_res_types[type];
 }
 
 /*
@@ -45,9 +48,9 @@ SDL_Texture* meh_model_exec_res_as_texture(App* app, ExecutableResource* exec_re
 	g_assert(exec_res != NULL);
 
 	/* Checks that it's an image */
-	if (g_strcmp0(exec_res->type, MEH_EXEC_RES_COVER) != 0 &&
-		g_strcmp0(exec_res->type, MEH_EXEC_RES_FANART) != 0 &&
-		g_strcmp0(exec_res->type, MEH_EXEC_RES_SCREENSHOT) != 0) {
+	if (exec_res->type != MEH_EXEC_RES_COVER &&
+		exec_res->type != MEH_EXEC_RES_FANART &&
+		exec_res->type != MEH_EXEC_RES_SCREENSHOT) {
 		return NULL;
 	}
 
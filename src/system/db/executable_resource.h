@@ -3,21 +3,29 @@
 #include <SDL2/SDL.h>
 #include <glib.h>
 
-#define MEH_EXEC_RES_COVER "cover"
-#define MEH_EXEC_RES_FANART "fanart" 
-#define MEH_EXEC_RES_SCREENSHOT "screenshot" 
-#define MEH_EXEC_RES_VIDEO "video"
+/*
+ * Types of the resources, stored in the `kind` column of the executable_resource
+ * table (see the migration 12): never change these values. An executable stores
+ * its resources grouped by type in this order, the types usable as a background
+ * then the fanarts and screenshots are consecutive.
+ */
+#define MEH_EXEC_RES_OTHER 0 /* unknown type */
+#define MEH_EXEC_RES_FANART 1
+#define MEH_EXEC_RES_SCREENSHOT 2
+#define MEH_EXEC_RES_COVER 3
+#define MEH_EXEC_RES_LOGO 4
+#define MEH_EXEC_RES_VIDEO 5
+#define MEH_EXEC_RES_TYPES 6
 
 struct App;
 
 typedef struct ExecutableResource {
 	int id;
 	int executable_id;
-	gchar* type;
+	int type; /* MEH_EXEC_RES_* */
 	gchar* filepath;
 } ExecutableResource;
 
-ExecutableResource* meh_model_exec_res_new(int id, int executable_id, const gchar* display_name, const gchar* filepath);
-void meh_model_exec_res_destroy(ExecutableResource* exec_res);
-void meh_model_exec_res_list_destroy(GQueue* exec_resources);
+int meh_model_exec_res_type(const gchar* name);
+const gchar* meh_model_exec_res_type_name(int type);
 SDL_Texture* meh_model_exec_res_as_texture(struct App* app, ExecutableResource* exec_res);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "system/db/catalog.h"
 #include "system/db/executable.h"
 #include "system/db/executable_resource.h"
 #include "system/db/mapping.h"
@@ -2,7 +2,7 @@
 
 #include "system/db/platform.h"
 
-Platform* meh_model_platform_new(int id, const char* name, const char* command, const char* icon, const char* background) {
+Platform* meh_model_platform_new(int id, const char* name, const char* command, const char* icon, const char* background, int executables_count, const char* rom_path, const char* extensions) {
 	Platform* platform = g_new(Platform, 1);
 
 	platform->id = id;
@@ -10,6 +10,9 @@ Platform* meh_model_platform_new(int id, const char* name, const char* command,
 	platform->command = g_strdup(command);
 	platform->icon = g_strdup(icon);
 	platform->background = g_strdup(background);
+	platform->executables_count = executables_count;
+	platform->rom_path = g_strdup(rom_path);
+	platform->extensions = g_strdup(extensions);
 
 	return platform;
 }
@@ -21,6 +24,8 @@ void meh_model_platform_destroy(Platform* platform) {
 	g_free(platform->command);
 	g_free(platform->icon);
 	g_free(platform->background);
+	g_free(platform->rom_path);
+	g_free(platform->extensions);
 
 	g_free(platform);
 }
@@ -6,8 +6,13 @@ typedef struct Platform {
 	gchar* command;
 	gchar* icon;
 	gchar* background;
+	int executables_count;
+	/* directory scanned for the executables, NULL if none, and the
+	 * extensions of their files (e.g. "sfc smc zip"), all if NULL. */
+	gchar* rom_path;
+	gchar* extensions;
 } Platform;
 
-Platform* meh_model_platform_new(int id, const char* name, const char* command, const char* icon, const char* background);
+Platform* meh_model_platform_new(int id, const char* name, const char* command, const char* icon, const char* background, int executables_count, const char* rom_path, const char* extensions);
 void meh_model_platform_destroy(Platform* platform);
 void meh_model_platforms_destroy(GQueue* platforms);
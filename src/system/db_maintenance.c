@@ -0,0 +1,240 @@
+/*
+ * mehstation - Maintenance of the database.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ *
+ * The maintenance is split in steps executed by the DB worker while
+ * mehstation is idle. A step is stopped by a SQLite progress handler once
+ * its time budget is spent: a step not finished is executed again later,
+ * continuing where it has been stopped.
+ */
+
+#include <sqlite3.h>
+
+#include "system/db_maintenance.h"
+
+#define MEH_DB_MAINTENANCE_PROGRESS_OPS (1000) /* VM instructions between two checks of the deadline */
+#define MEH_DB_MAINTENANCE_ANALYSIS_LIMIT (1000) /* rows of an index read by ANALYZE */
+#define MEH_DB_MAINTENANCE_MERGE_MIN_PAGES (4) /* pages of the search index merged by the first merge of a step */
+#define MEH_DB_MAINTENANCE_MERGE_PAGES (64) /* max pages of the search index merged at once */
+#define MEH_DB_MAINTENANCE_VACUUM_PAGES (64) /* pages given back at once */
+#define MEH_DB_MAINTENANCE_FRAGMENTATION (10) /* free pages ratio (1/n) for a full VACUUM */
+#define MEH_DB_MAINTENANCE_KEPT_CHANGES (1000) /* last changes of the catalog kept in its log */
+
+static int meh_db_maintenance_progress(void* data);
+static int meh_db_maintenance_exec(DB* db, const char* sql);
+static int meh_db_maintenance_read_int(DB* db, const char* sql);
+static void meh_db_maintenance_statistics(DB* db);
+static gboolean meh_db_maintenance_merge_search(DB* db, gint64 deadline);
+static gboolean meh_db_maintenance_vacuum(DB* db, gint64 deadline);
+
+/*
+ * meh_db_maintenance_step executes the given step of the maintenance
+ * during at most (nearly) `budget_ms`.
+ * Returns the step to execute next: the same one if it's not finished,
+ * MEH_DB_MAINTENANCE_DONE after the last one.
+ */
+int meh_db_maintenance_step(DB* db, int step, int budget_ms) {
+	g_assert(db != NULL);
+	g_assert(step >= 0 && step < MEH_DB_MAINTENANCE_DONE);
+
+	if (db->read_only) {
+		return MEH_DB_MAINTENANCE_DONE;
+	}
+
+	gint64 start = g_get_monotonic_time();
+	gint64 deadline = start + (gint64)budget_ms * 1000;
+	int next = step + 1;
+
+	sqlite3_progress_handler(db->sqlite, MEH_DB_MAINTENANCE_PROGRESS_OPS, meh_db_maintenance_progress, &deadline);
+
+	switch (step) {
+		case MEH_DB_MAINTENANCE_STATISTICS:
+			meh_db_maintenance_statistics(db);
+			break;
+		case MEH_DB_MAINTENANCE_MERGE_SEARCH:
+			if (!meh_db_maintenance_merge_search(db, deadline)) {
+				next = step;
+			}
+			break;
+		case MEH_DB_MAINTENANCE_PRUNE_CHANGES:
+			{
+				/* a screen behind these changes reads everything again. */
+				gchar* prune = g_strdup_printf("DELETE FROM catalog_change WHERE \"id\" <= (SELECT max(\"id\") FROM catalog_change) - %d",
+						MEH_DB_MAINTENANCE_KEPT_CHANGES);
+				meh_db_maintenance_exec(db, prune);
+				g_free(prune);
+			}
+			break;
+		case MEH_DB_MAINTENANCE_VACUUM:
+			if (!meh_db_maintenance_vacuum(db, deadline)) {
+				next = step;
+			}
+			break;
+		case MEH_DB_MAINTENANCE_CHECKPOINT:
+			/* doesn't wait for the readers, the pages still read
+			 * by them will be copied by the next checkpoint. */
+			meh_db_maintenance_exec(db, "PRAGMA wal_checkpoint(PASSIVE)");
+			break;
+	}
+
+	sqlite3_progress_handler(db->sqlite, 0, NULL, NULL);
+
+	g_debug("Database maintenance step %d executed in %dms%s.", step,
+			(int)((g_get_monotonic_time() - start) / 1000), next == step ? ", not finished" : "");
+
+	return next;
+}
+
+/*
+ * meh_db_maintenance_progress interrupts the running statement
+ * once the deadline is passed.
+ */
+static int meh_db_maintenance_progress(void* data) {
+	gint64* deadline = (gint64*)data;
+	return g_get_monotonic_time() > *deadline ? 1 : 0;
+}
+
+/*
+ * meh_db_maintenance_exec executes the given SQL, an interruption
+ * by the progress handler is not an error.
+ */
+static int meh_db_maintenance_exec(DB* db, const char* sql) {
+	g_assert(db != NULL);
+	g_assert(sql != NULL);
+
+	char* error = NULL;
+	int return_code = sqlite3_exec(db->sqlite, sql, NULL, NULL, &error);
+	if (return_code != SQLITE_OK && return_code != SQLITE_INTERRUPT) {
+		g_warning("Can't execute '%s' during the maintenance: %s", sql, error);
+	}
+
+	sqlite3_free(error);
+	return return_code;
+}
+
+/*
+ * meh_db_maintenance_read_int returns the integer read by the
+ * given query (e.g. a PRAGMA), -1 on error.
+ */
+static int meh_db_maintenance_read_int(DB* db, const char* sql) {
+	g_assert(db != NULL);
+	g_assert(sql != NULL);
+
+	sqlite3_stmt* statement = NULL;
+	int value = -1;
+
+	if (sqlite3_prepare_v2(db->sqlite, sql, -1, &statement, NULL) == SQLITE_OK &&
+		sqlite3_step(statement) == SQLITE_ROW) {
+		value = sqlite3_column_int(statement, 0);
+	}
+
+	sqlite3_finalize(statement);
+	return value;
+}
+
+/*
+ * meh_db_maintenance_statistics updates the statistics of the
+ * query planner: a complete ANALYZE the first time, then only the
+ * tables which have changed enough. ANALYZE reads a sample of
+ * each index to stay in the time budget.
+ */
+static void meh_db_maintenance_statistics(DB* db) {
+	g_assert(db != NULL);
+
+	gboolean analyzed = meh_db_maintenance_read_int(db,
+			"SELECT COUNT(*) FROM sqlite_master WHERE \"name\" = 'sqlite_stat1'") > 0;
+
+	gchar* limit = g_strdup_printf("PRAGMA analysis_limit = %d", MEH_DB_MAINTENANCE_ANALYSIS_LIMIT);
+	meh_db_maintenance_exec(db, limit);
+	g_free(limit);
+
+	if (meh_db_maintenance_exec(db, analyzed ? "PRAGMA optimize" : "ANALYZE") == SQLITE_INTERRUPT) {
+		g_debug("The statistics of the database have not been updated in time.");
+	}
+
+	meh_db_maintenance_exec(db, "PRAGMA analysis_limit = 0");
+}
+
+/*
+ * meh_db_maintenance_merge_search merges the segments of the search
+ * index created by the imports and scans, some pages at a time: a few
+ * pages first, more after each merge done in time. An interrupted merge
+ * is rolled back, the next step starts again with a few pages.
+ * Returns FALSE if it must continue in another step.
+ */
+static gboolean meh_db_maintenance_merge_search(DB* db, gint64 deadline) {
+	g_assert(db != NULL);
+
+	int pages = MEH_DB_MAINTENANCE_MERGE_MIN_PAGES;
+	gboolean finished = FALSE;
+
+	while (!finished && g_get_monotonic_time() < deadline) {
+		gchar* merge = g_strdup_printf("INSERT INTO executable_search(executable_search, rank) VALUES ('merge', %d)", pages);
+		int changes = sqlite3_total_changes(db->sqlite);
+		int return_code = meh_db_maintenance_exec(db, merge);
+		g_free(merge);
+
+		if (return_code == SQLITE_INTERRUPT) {
+			break;
+		}
+
+		/* not an interruption, the index can't be merged: skipped. */
+		if (return_code != SQLITE_OK) {
+			finished = TRUE;
+			break;
+		}
+
+		/* less than 2 changes: nothing left to merge. */
+		finished = sqlite3_total_changes(db->sqlite) - changes < 2;
+		pages = MIN(pages * 2, MEH_DB_MAINTENANCE_MERGE_PAGES);
+	}
+
+	return finished;
+}
+
+/*
+ * meh_db_maintenance_vacuum gives back to the file system the free pages
+ * of the database, some pages at a time.
+ * A database created without auto_vacuum is converted by one full VACUUM,
+ * done only once it's really fragmented: it's not interruptible.
+ * Returns FALSE if it must continue in another step.
+ */
+static gboolean meh_db_maintenance_vacuum(DB* db, gint64 deadline) {
+	g_assert(db != NULL);
+
+	int auto_vacuum = meh_db_maintenance_read_int(db, "PRAGMA auto_vacuum");
+	int free_pages = meh_db_maintenance_read_int(db, "PRAGMA freelist_count");
+	int pages = meh_db_maintenance_read_int(db, "PRAGMA page_count");
+
+	if (free_pages <= 0) {
+		return TRUE;
+	}
+
+	/* 2 is incremental */
+	if (auto_vacuum != 2) {
+		if (auto_vacuum == 0 && free_pages * MEH_DB_MAINTENANCE_FRAGMENTATION >= pages) {
+			g_message("Converting the database to the incremental vacuum, %d free pages of %d.", free_pages, pages);
+			sqlite3_progress_handler(db->sqlite, 0, NULL, NULL);
+			meh_db_maintenance_exec(db, "PRAGMA auto_vacuum = INCREMENTAL");
+			meh_db_maintenance_exec(db, "VACUUM");
+		}
+		return TRUE;
+	}
+
+	gchar* vacuum = g_strdup_printf("PRAGMA incremental_vacuum(%d)", MEH_DB_MAINTENANCE_VACUUM_PAGES);
+
+	int vacuums = 0;
+	while (free_pages > 0 && g_get_monotonic_time() < deadline) {
+		if (meh_db_maintenance_exec(db, vacuum) != SQLITE_OK) {
+			break;
+		}
+		vacuums++;
+		free_pages = meh_db_maintenance_read_int(db, "PRAGMA freelist_count");
+	}
+
+	g_free(vacuum);
+
+	/* interrupted before having given back any page: skipped. */
+	return free_pages <= 0 || vacuums == 0;
+}
@@ -0,0 +1,26 @@
+/*
+ * mehstation - Maintenance of the database.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include "system/db.h"
+
+/*
+ * Steps of the maintenance, executed in this order.
+ */
+#define MEH_DB_MAINTENANCE_STATISTICS 0
+#define MEH_DB_MAINTENANCE_MERGE_SEARCH 1
+#define MEH_DB_MAINTENANCE_PRUNE_CHANGES 2
+#define MEH_DB_MAINTENANCE_VACUUM 3
+#define MEH_DB_MAINTENANCE_CHECKPOINT 4
+#define MEH_DB_MAINTENANCE_DONE 5
+
+#define MEH_DB_MAINTENANCE_STEP_MS (50) /* max duration of a step */
+#define MEH_DB_MAINTENANCE_INTERVAL ((gint64)G_USEC_PER_SEC * 60 * 60 * 24) /* between two complete maintenances */
+
+int meh_db_maintenance_step(DB* db, int step, int budget_ms);
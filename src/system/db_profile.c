@@ -0,0 +1,177 @@
+/*
+ * mehstation - Profiling of the SQL queries.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ *
+ * SQLite calls the trace callback for each row returned and with the
+ * duration of each statement execution. The statistics are kept by SQL
+ * text: the cached prepared statements are aggregated over the session.
+ */
+
+#include <sqlite3.h>
+
+#include "system/db_profile.h"
+
+#define MEH_DB_PROFILE_SQL_LENGTH (120) /* characters of SQL in the dump */
+
+static int meh_db_profile_trace(unsigned int type, void* context, void* p, void* x);
+static void meh_db_profile_query_stats_destroy(gpointer data);
+static gint meh_db_profile_compare(gconstpointer a, gconstpointer b);
+
+/*
+ * meh_db_profile_new starts the profiling of the statements executed
+ * on the given connection, the statements slower than `slow_query_ms`
+ * are logged if it's strictly positive.
+ */
+DBProfile* meh_db_profile_new(sqlite3* sqlite, int slow_query_ms) {
+	g_assert(sqlite != NULL);
+
+	DBProfile* profile = g_new(DBProfile, 1);
+
+	profile->statements = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, meh_db_profile_query_stats_destroy);
+	profile->pending_rows = g_hash_table_new(g_direct_hash, g_direct_equal);
+	profile->slow_query_ns = slow_query_ms > 0 ? (gint64)slow_query_ms * 1000000 : 0;
+
+	if (sqlite3_trace_v2(sqlite, SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW, meh_db_profile_trace, profile) != SQLITE_OK) {
+		g_warning("Can't profile the SQL queries.");
+	}
+
+	return profile;
+}
+
+/*
+ * meh_db_profile_destroy frees the profile, the connection
+ * must have been closed before.
+ */
+void meh_db_profile_destroy(DBProfile* profile) {
+	if (profile == NULL) {
+		return;
+	}
+
+	g_hash_table_destroy(profile->statements);
+	g_hash_table_destroy(profile->pending_rows);
+	g_free(profile);
+}
+
+static void meh_db_profile_query_stats_destroy(gpointer data) {
+	QueryStats* stats = (QueryStats*)data;
+	g_free(stats->sql);
+	g_free(stats);
+}
+
+static int meh_db_profile_trace(unsigned int type, void* context, void* p, void* x) {
+	DBProfile* profile = (DBProfile*)context;
+	sqlite3_stmt* statement = (sqlite3_stmt*)p;
+
+	/* an execution starts: the rows counted for a statement which has been
+	 * finalized without being profiled (e.g. the SQLite internal statements
+	 * reading the schema) must not be added to a statement reusing its
+	 * address. The triggers invocations are traced with a SQL comment. */
+	if (type == SQLITE_TRACE_STMT) {
+		const char* text = (const char*)x;
+		if (text == NULL || !g_str_has_prefix(text, "--")) {
+			g_hash_table_remove(profile->pending_rows, statement);
+		}
+		return 0;
+	}
+
+	/* rows are counted by running statement, only a pointer lookup. */
+	if (type == SQLITE_TRACE_ROW) {
+		guint rows = GPOINTER_TO_UINT(g_hash_table_lookup(profile->pending_rows, statement));
+		g_hash_table_insert(profile->pending_rows, statement, GUINT_TO_POINTER(rows + 1));
+		return 0;
+	}
+
+	if (type != SQLITE_TRACE_PROFILE) {
+		return 0;
+	}
+
+	gint64 duration = *(sqlite3_int64*)x;
+
+	guint rows = GPOINTER_TO_UINT(g_hash_table_lookup(profile->pending_rows, statement));
+	g_hash_table_remove(profile->pending_rows, statement);
+
+	const char* sql = sqlite3_sql(statement);
+	if (sql == NULL) {
+		return 0;
+	}
+
+	QueryStats* stats = g_hash_table_lookup(profile->statements, sql);
+	if (stats == NULL) {
+		stats = g_new0(QueryStats, 1);
+		stats->sql = g_strdup(sql);
+		g_hash_table_insert(profile->statements, stats->sql, stats);
+	}
+
+	stats->calls++;
+	stats->total_ns += duration;
+	stats->rows += rows;
+	if (duration > stats->max_ns) {
+		stats->max_ns = duration;
+	}
+
+	if (profile->slow_query_ns > 0 && duration >= profile->slow_query_ns) {
+		/* with the values of its parameters */
+		char* expanded = sqlite3_expanded_sql(statement);
+		g_warning("Slow query: %.1fms, %u rows: %s", duration / 1000000.0, rows, expanded != NULL ? expanded : sql);
+		sqlite3_free(expanded);
+	}
+
+	return 0;
+}
+
+/*
+ * meh_db_profile_compare orders the statistics by total time, the longest first.
+ */
+static gint meh_db_profile_compare(gconstpointer a, gconstpointer b) {
+	const QueryStats* stats_a = (const QueryStats*)a;
+	const QueryStats* stats_b = (const QueryStats*)b;
+
+	if (stats_a->total_ns == stats_b->total_ns) {
+		return 0;
+	}
+	return stats_a->total_ns > stats_b->total_ns ? -1 : 1;
+}
+
+/*
+ * meh_db_profile_dump logs the statistics of every statement
+ * executed on the connection, by total time.
+ */
+void meh_db_profile_dump(const DBProfile* profile, const gchar* connection) {
+	if (profile == NULL) {
+		return;
+	}
+
+	GList* statements = g_list_sort(g_hash_table_get_values(profile->statements), meh_db_profile_compare);
+
+	guint calls = 0;
+	gint64 total_ns = 0;
+	for (GList* l = statements; l != NULL; l = l->next) {
+		QueryStats* stats = (QueryStats*)l->data;
+		calls += stats->calls;
+		total_ns += stats->total_ns;
+	}
+
+	g_message("SQL profile of the %s connection: %u executions of %u statements in %.1fms.",
+			connection, calls, g_list_length(statements), total_ns / 1000000.0);
+	g_message("%8s %10s %10s %10s %10s  %s", "calls", "total ms", "avg ms", "max ms", "rows", "sql");
+
+	for (GList* l = statements; l != NULL; l = l->next) {
+		QueryStats* stats = (QueryStats*)l->data;
+
+		gchar* sql = g_strndup(stats->sql, MEH_DB_PROFILE_SQL_LENGTH);
+		g_strdelimit(sql, "\n\r\t", ' ');
+
+		g_message("%8u %10.2f %10.3f %10.2f %10" G_GUINT64_FORMAT "  %s",
+				stats->calls,
+				stats->total_ns / 1000000.0,
+				stats->total_ns / 1000000.0 / stats->calls,
+				stats->max_ns / 1000000.0,
+				stats->rows,
+				sql);
+
+		g_free(sql);
+	}
+
+	g_list_free(statements);
+}
@@ -0,0 +1,35 @@
+/*
+ * mehstation - Profiling of the SQL queries.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <sqlite3.h>
+
+/*
+ * Statistics of one statement, by SQL text.
+ */
+typedef struct QueryStats {
+	gchar* sql;
+	guint calls;
+	gint64 total_ns;
+	gint64 max_ns;
+	guint64 rows;
+} QueryStats;
+
+/*
+ * Profile of the statements executed on one connection,
+ * filled by a SQLite trace callback.
+ */
+typedef struct DBProfile {
+	GHashTable* statements; /* SQL -> QueryStats* */
+	GHashTable* pending_rows; /* sqlite3_stmt* -> rows returned by its running execution */
+	gint64 slow_query_ns; /* 0 to not log the slow queries */
+} DBProfile;
+
+DBProfile* meh_db_profile_new(sqlite3* sqlite, int slow_query_ms);
+void meh_db_profile_destroy(DBProfile* profile);
+void meh_db_profile_dump(const DBProfile* profile, const gchar* connection);
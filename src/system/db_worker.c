@@ -0,0 +1,359 @@
+/*
+ * mehstation - Database worker thread.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ *
+ * The queries which could be long are executed by a worker thread using its
+ * own SQLite connection, the UI thread never waits for them: it pushes
+ * a request and receives later its result as a MEH_MSG_DB_RESULT message
+ * sent to the current screen.
+ */
+
+#include <glib.h>
+
+#include "system/app.h"
+#include "system/consts.h"
+#include "system/db_maintenance.h"
+#include "system/db_profile.h"
+#include "system/db_worker.h"
+#include "system/message.h"
+#include "system/scanner.h"
+#include "system/db/models.h"
+
+static gpointer meh_db_worker_run(gpointer data);
+static void meh_db_worker_execute(DBWorker* worker, DBRequest* request);
+static guint meh_db_worker_push(DBWorker* worker, DBRequest* request);
+static DBRequest* meh_db_request_new(int type);
+static void meh_db_request_destroy(DBRequest* request);
+
+/*
+ * meh_db_worker_new opens a new connection to the given database
+ * and starts the worker thread using it.
+ */
+DBWorker* meh_db_worker_new(const char* filename, Settings settings) {
+	g_assert(filename != NULL);
+
+	DB* db = meh_db_open_or_create(filename, settings);
+	if (db == NULL) {
+		g_critical("Can't open the database connection of the DB worker.");
+		return NULL;
+	}
+
+	DBWorker* worker = g_new(DBWorker, 1);
+
+	worker->db = db;
+	worker->requests = g_async_queue_new();
+	worker->results = g_async_queue_new();
+	worker->last_request_id = 0;
+	worker->maintenance_step = MEH_DB_MAINTENANCE_STATISTICS;
+	worker->maintenance_request = 0;
+	worker->maintenance_done_at = 0;
+	worker->thread = g_thread_new("db-worker", meh_db_worker_run, worker);
+
+	return worker;
+}
+
+/*
+ * meh_db_worker_destroy stops the worker thread once the pending requests
+ * have been executed, then frees the worker. The results not dispatched
+ * are lost.
+ */
+void meh_db_worker_destroy(DBWorker* worker) {
+	if (worker == NULL) {
+		return;
+	}
+
+	meh_db_worker_push(worker, meh_db_request_new(MEH_DB_REQUEST_QUIT));
+	g_thread_join(worker->thread);
+
+	/* the worker connection is only read once the thread has stopped. */
+	meh_db_profile_dump(worker->db->profile, "worker");
+
+	DBRequest* request = NULL;
+	while ((request = g_async_queue_try_pop(worker->results)) != NULL) {
+		meh_db_request_destroy(request);
+	}
+
+	g_async_queue_unref(worker->requests);
+	g_async_queue_unref(worker->results);
+
+	meh_db_close(worker->db);
+
+	g_free(worker);
+}
+
+/*
+ * meh_db_worker_run is the worker thread main loop.
+ */
+static gpointer meh_db_worker_run(gpointer data) {
+	DBWorker* worker = (DBWorker*)data;
+	g_assert(worker != NULL);
+
+	while (TRUE) {
+		DBRequest* request = g_async_queue_pop(worker->requests);
+		if (request->type == MEH_DB_REQUEST_QUIT) {
+			meh_db_request_destroy(request);
+			break;
+		}
+
+		meh_db_worker_execute(worker, request);
+		g_async_queue_push(worker->results, request);
+	}
+
+	return NULL;
+}
+
+/*
+ * meh_db_worker_execute executes the request in the worker
+ * thread and stores the result in the request.
+ */
+static void meh_db_worker_execute(DBWorker* worker, DBRequest* request) {
+	g_assert(worker != NULL);
+	g_assert(request != NULL);
+
+	switch (request->type) {
+		case MEH_DB_REQUEST_LOAD_EXECUTABLE_LIST:
+			{
+				Platform* platform = meh_db_get_platform(worker->db, request->platform_id);
+				if (platform == NULL) {
+					break;
+				}
+				request->count = platform->executables_count;
+				/* too many executables: the screen will page them. */
+				if (request->paging_threshold <= 0 || request->count <= request->paging_threshold) {
+					request->executables = meh_db_get_platform_executables(worker->db, platform, TRUE);
+				}
+				request->success = TRUE;
+				meh_model_platform_destroy(platform);
+			}
+			break;
+		case MEH_DB_REQUEST_SET_EXECUTABLE_FAVORITE:
+			request->success = meh_db_set_executable_favorite(worker->db, request->executable_id, request->favorite,
+					&request->catalog_change_id);
+			break;
+		case MEH_DB_REQUEST_SEARCH_EXECUTABLES:
+			request->executables = meh_db_search_executables(worker->db, request->platform_id, request->text, request->limit);
+			request->success = TRUE;
+			break;
+		case MEH_DB_REQUEST_SCAN_PLATFORMS:
+			request->count = meh_scanner_scan_platforms(worker->db);
+			request->success = request->count >= 0;
+			break;
+		case MEH_DB_REQUEST_RECORD_LAUNCH:
+			request->success = meh_db_record_executable_launch(worker->db, request->executable_id, request->played_at);
+			break;
+		case MEH_DB_REQUEST_ADD_PLAY_TIME:
+			request->success = meh_db_add_executable_play_time(worker->db, request->executable_id, request->play_time);
+			break;
+		case MEH_DB_REQUEST_GET_RECENT_EXECUTABLES:
+			request->executables = meh_db_get_recent_executables(worker->db, request->limit);
+			request->success = TRUE;
+			break;
+		case MEH_DB_REQUEST_WRITE_SNAPSHOT:
+			request->success = meh_db_write_snapshot(worker->db);
+			break;
+		case MEH_DB_REQUEST_MAINTENANCE:
+			request->count = meh_db_maintenance_step(worker->db, request->maintenance_step, MEH_DB_MAINTENANCE_STEP_MS);
+			request->success = TRUE;
+			break;
+		default:
+			g_critical("Unknown DB request type: %d", request->type);
+			break;
+	}
+}
+
+/*
+ * meh_db_worker_push gives an id to the request and queues it.
+ * Returns the request id.
+ */
+static guint meh_db_worker_push(DBWorker* worker, DBRequest* request) {
+	g_assert(worker != NULL);
+	g_assert(request != NULL);
+
+	request->id = ++worker->last_request_id;
+	g_async_queue_push(worker->requests, request);
+	return request->id;
+}
+
+/*
+ * meh_db_worker_load_executable_list requests the executables of the given
+ * platform with their resources. The result contains the amount of executables
+ * in `count` and the executables in `executables`, which is NULL if there
+ * is more executables than the (strictly positive) paging threshold.
+ */
+guint meh_db_worker_load_executable_list(DBWorker* worker, int platform_id, int paging_threshold) {
+	g_assert(worker != NULL);
+
+	DBRequest* request = meh_db_request_new(MEH_DB_REQUEST_LOAD_EXECUTABLE_LIST);
+	request->platform_id = platform_id;
+	request->paging_threshold = paging_threshold;
+	return meh_db_worker_push(worker, request);
+}
+
+/*
+ * meh_db_worker_set_executable_favorite requests the update of the
+ * favorite flag of an executable, result in `success`.
+ */
+guint meh_db_worker_set_executable_favorite(DBWorker* worker, int executable_id, gboolean favorite) {
+	g_assert(worker != NULL);
+
+	DBRequest* request = meh_db_request_new(MEH_DB_REQUEST_SET_EXECUTABLE_FAVORITE);
+	request->executable_id = executable_id;
+	request->favorite = favorite;
+	return meh_db_worker_push(worker, request);
+}
+
+/*
+ * meh_db_worker_search_executables requests a search of the executables
+ * of the given platform, results in `executables`.
+ */
+guint meh_db_worker_search_executables(DBWorker* worker, int platform_id, const gchar* text, int limit) {
+	g_assert(worker != NULL);
+	g_assert(text != NULL);
+
+	DBRequest* request = meh_db_request_new(MEH_DB_REQUEST_SEARCH_EXECUTABLES);
+	request->platform_id = platform_id;
+	request->text = g_strdup(text);
+	request->limit = limit;
+	return meh_db_worker_push(worker, request);
+}
+
+/*
+ * meh_db_worker_scan_platforms requests a scan of the ROM directories of
+ * the platforms, the amount of executables changed is in `count`.
+ */
+guint meh_db_worker_scan_platforms(DBWorker* worker) {
+	g_assert(worker != NULL);
+
+	return meh_db_worker_push(worker, meh_db_request_new(MEH_DB_REQUEST_SCAN_PLATFORMS));
+}
+
+/*
+ * meh_db_worker_record_launch requests to store the launch of an executable
+ * at the given unix time, result in `success`. Nothing waits for it: the
+ * queue is the write-behind buffer of the launches, flushed by
+ * meh_db_worker_destroy at the latest.
+ */
+guint meh_db_worker_record_launch(DBWorker* worker, int executable_id, gint64 played_at) {
+	g_assert(worker != NULL);
+
+	DBRequest* request = meh_db_request_new(MEH_DB_REQUEST_RECORD_LAUNCH);
+	request->executable_id = executable_id;
+	request->played_at = played_at;
+	return meh_db_worker_push(worker, request);
+}
+
+/*
+ * meh_db_worker_add_play_time requests to add seconds to the
+ * play time of an executable, result in `success`.
+ */
+guint meh_db_worker_add_play_time(DBWorker* worker, int executable_id, int play_time) {
+	g_assert(worker != NULL);
+
+	DBRequest* request = meh_db_request_new(MEH_DB_REQUEST_ADD_PLAY_TIME);
+	request->executable_id = executable_id;
+	request->play_time = play_time;
+	return meh_db_worker_push(worker, request);
+}
+
+/*
+ * meh_db_worker_get_recent_executables requests the last played executables
+ * of every platform, results in `executables`.
+ */
+guint meh_db_worker_get_recent_executables(DBWorker* worker, int limit) {
+	g_assert(worker != NULL);
+
+	DBRequest* request = meh_db_request_new(MEH_DB_REQUEST_GET_RECENT_EXECUTABLES);
+	request->limit = limit;
+	return meh_db_worker_push(worker, request);
+}
+
+/*
+ * meh_db_worker_write_snapshot requests to write the snapshot
+ * of the catalog if it's stale, result in `success`.
+ */
+guint meh_db_worker_write_snapshot(DBWorker* worker) {
+	g_assert(worker != NULL);
+
+	return meh_db_worker_push(worker, meh_db_request_new(MEH_DB_REQUEST_WRITE_SNAPSHOT));
+}
+
+/*
+ * meh_db_worker_maintain requests the next step of the database maintenance
+ * if none is running, to call while mehstation is idle. One step at a time:
+ * the other requests don't wait behind the whole maintenance. Once
+ * finished, it's done again after MEH_DB_MAINTENANCE_INTERVAL.
+ */
+void meh_db_worker_maintain(DBWorker* worker) {
+	g_assert(worker != NULL);
+
+	if (worker->maintenance_request != 0) {
+		return;
+	}
+
+	if (worker->maintenance_step == MEH_DB_MAINTENANCE_DONE) {
+		if (g_get_monotonic_time() - worker->maintenance_done_at < MEH_DB_MAINTENANCE_INTERVAL) {
+			return;
+		}
+		worker->maintenance_step = MEH_DB_MAINTENANCE_STATISTICS;
+	}
+
+	if (worker->maintenance_step == MEH_DB_MAINTENANCE_STATISTICS) {
+		g_message("Starting the database maintenance.");
+	}
+
+	DBRequest* request = meh_db_request_new(MEH_DB_REQUEST_MAINTENANCE);
+	request->maintenance_step = worker->maintenance_step;
+	worker->maintenance_request = meh_db_worker_push(worker, request);
+}
+
+/*
+ * meh_db_worker_dispatch_results sends the results available to the current
+ * screen, must be called from the main loop. A screen not waiting for a
+ * result ignores it, the results are freed once dispatched.
+ */
+void meh_db_worker_dispatch_results(DBWorker* worker, App* app) {
+	g_assert(worker != NULL);
+	g_assert(app != NULL);
+
+	DBRequest* request = NULL;
+	while ((request = g_async_queue_try_pop(worker->results)) != NULL) {
+		if (request->type == MEH_DB_REQUEST_MAINTENANCE) {
+			worker->maintenance_request = 0;
+			worker->maintenance_step = request->count;
+			if (request->count == MEH_DB_MAINTENANCE_DONE) {
+				worker->maintenance_done_at = g_get_monotonic_time();
+				g_message("Database maintenance done.");
+			}
+		}
+
+		Message* message = meh_message_new(MEH_MSG_DB_RESULT, request);
+		meh_app_send_message(app, message);
+
+		/* the request isn't a simple allocation. */
+		message->data = NULL;
+		meh_message_destroy(message);
+		meh_db_request_destroy(request);
+	}
+}
+
+static DBRequest* meh_db_request_new(int type) {
+	DBRequest* request = g_new0(DBRequest, 1);
+	request->type = type;
+	request->platform_id = -1;
+	request->executable_id = -1;
+	request->success = FALSE;
+	request->executables = NULL;
+	request->text = NULL;
+	return request;
+}
+
+static void meh_db_request_destroy(DBRequest* request) {
+	g_assert(request != NULL);
+
+	if (request->executables != NULL) {
+		meh_model_executables_destroy(request->executables);
+	}
+	g_free(request->text);
+	g_free(request);
+}
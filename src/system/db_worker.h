@@ -0,0 +1,85 @@
+/*
+ * mehstation - Database worker thread.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include "system/db.h"
+#include "system/settings.h"
+
+struct App;
+
+/*
+ * Types of the requests executed by the worker.
+ */
+#define MEH_DB_REQUEST_QUIT 0
+#define MEH_DB_REQUEST_LOAD_EXECUTABLE_LIST 1
+#define MEH_DB_REQUEST_SET_EXECUTABLE_FAVORITE 2
+#define MEH_DB_REQUEST_SEARCH_EXECUTABLES 3
+#define MEH_DB_REQUEST_SCAN_PLATFORMS 4
+#define MEH_DB_REQUEST_RECORD_LAUNCH 5
+#define MEH_DB_REQUEST_ADD_PLAY_TIME 6
+#define MEH_DB_REQUEST_GET_RECENT_EXECUTABLES 7
+#define MEH_DB_REQUEST_WRITE_SNAPSHOT 8
+#define MEH_DB_REQUEST_MAINTENANCE 9
+#define MEH_DB_REQUEST_END 10
+
+/*
+ * A request to the worker, filled with its result by the worker
+ * then sent to the current screen as the data of a MEH_MSG_DB_RESULT.
+ */
+typedef struct DBRequest {
+	guint id;
+	int type;
+
+	/* parameters */
+	int platform_id;
+	int executable_id;
+	gboolean favorite;
+	int paging_threshold;
+	gchar* text;
+	int limit;
+	gint64 played_at; /* unix time */
+	int play_time; /* seconds */
+	int maintenance_step;
+
+	/* results */
+	gboolean success;
+	int count;
+	GQueue* executables; /* List of Executable*, set to NULL by the screen taking its ownership. */
+	gint64 catalog_change_id; /* last change of the catalog once the request written */
+} DBRequest;
+
+typedef struct DBWorker {
+	GThread* thread;
+	/* connection only used by the worker thread. */
+	DB* db;
+	/* DBRequest* to execute / executed. */
+	GAsyncQueue* requests;
+	GAsyncQueue* results;
+	/* last id given to a request, only used in the main thread. */
+	guint last_request_id;
+	/* progress of the idle maintenance, only used in the main thread:
+	 * next step to execute, id of the running step (0 if none) and
+	 * when the last complete maintenance has finished. */
+	int maintenance_step;
+	guint maintenance_request;
+	gint64 maintenance_done_at;
+} DBWorker;
+
+DBWorker* meh_db_worker_new(const char* filename, Settings settings);
+void meh_db_worker_destroy(DBWorker* worker);
+guint meh_db_worker_load_executable_list(DBWorker* worker, int platform_id, int paging_threshold);
+guint meh_db_worker_set_executable_favorite(DBWorker* worker, int executable_id, gboolean favorite);
+guint meh_db_worker_search_executables(DBWorker* worker, int platform_id, const gchar* text, int limit);
+guint meh_db_worker_scan_platforms(DBWorker* worker);
+guint meh_db_worker_record_launch(DBWorker* worker, int executable_id, gint64 played_at);
+guint meh_db_worker_add_play_time(DBWorker* worker, int executable_id, int play_time);
+guint meh_db_worker_get_recent_executables(DBWorker* worker, int limit);
+guint meh_db_worker_write_snapshot(DBWorker* worker);
+void meh_db_worker_maintain(DBWorker* worker);
+void meh_db_worker_dispatch_results(DBWorker* worker, struct App* app);
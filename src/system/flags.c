@@ -18,12 +18,22 @@ Flags meh_flags_parse(int argc, char* argv[]) {
 	/* default values */
 	f.configure_mapping = FALSE;
 	f.force_software = FALSE;
+	f.import_gamelist = NULL;
+	f.import_gamelist_file = NULL;
+	f.scan = FALSE;
+	f.build_cache = FALSE;
+
+	gchar** remaining = NULL;
 
 	/* defining the flags */
 	GOptionEntry flags[] =
 	{
 		{ "mapping", 'm', 0, G_OPTION_ARG_NONE, &f.configure_mapping, "Go through the mapping screen when starting.", NULL },
 		{ "software", 's', 0, G_OPTION_ARG_NONE, &f.force_software, "Force software renderer.", NULL },
+		{ "import-gamelist", 'i', 0, G_OPTION_ARG_STRING, &f.import_gamelist, "Import the EmulationStation gamelist FILE in the platform (name or id) and exit.", "PLATFORM" },
+		{ "scan", 0, 0, G_OPTION_ARG_NONE, &f.scan, "Scan the ROM directories of the platforms and exit.", NULL },
+		{ "build-cache", 0, 0, G_OPTION_ARG_NONE, &f.build_cache, "Build the thumbnails of every image and exit.", NULL },
+		{ G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &remaining, NULL, "[FILE]" },
 		{ NULL }
 	};
 
@@ -34,6 +44,14 @@ Flags meh_flags_parse(int argc, char* argv[]) {
 	if (!g_option_context_parse (context, &argc, &argv, &error))
 	{
 		g_critical("Options parsing failed: %s", error->message);
+		g_error_free(error);
+	}
+	g_option_context_free(context);
+
+	/* the gamelist file follows the platform */
+	if (remaining != NULL) {
+		f.import_gamelist_file = g_strdup(remaining[0]);
+		g_strfreev(remaining);
 	}
 
 	g_debug("flags read");
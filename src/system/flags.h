@@ -7,6 +7,16 @@ typedef struct {
 	gboolean configure_mapping;
 	/* to force the software renderer */
 	gboolean force_software;
+	/* platform and file of a gamelist to import
+	 * without starting the UI */
+	gchar* import_gamelist;
+	gchar* import_gamelist_file;
+	/* to scan the platforms ROM directories
+	 * without starting the UI */
+	gboolean scan;
+	/* to fill the thumbnail cache with every
+	 * image without starting the UI */
+	gboolean build_cache;
 } Flags;
 
 Flags meh_flags_parse(int argc, char* argv[]);
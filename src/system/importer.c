@@ -0,0 +1,423 @@
+/*
+ * mehstation - Import of EmulationStation gamelists.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ *
+ * The gamelist.xml is read by chunks and parsed while being read, no tree of
+ * the document is ever built: every <game> is inserted as soon as its closing
+ * element is parsed. The inserts use the cached prepared statements of the DB
+ * and are grouped in bulk insert transactions of MEH_IMPORTER_BATCH_SIZE
+ * games, indexed for the search once per transaction.
+ * A game already known (same platform and same file) is not inserted again,
+ * so an interrupted import can simply be started again.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "system/db.h"
+#include "system/importer.h"
+#include "system/settings.h"
+#include "system/db/models.h"
+
+static void meh_importer_start_element(GMarkupParseContext* context, const gchar* element_name,
+		const gchar** attribute_names, const gchar** attribute_values, gpointer user_data, GError** error);
+static void meh_importer_end_element(GMarkupParseContext* context, const gchar* element_name,
+		gpointer user_data, GError** error);
+static void meh_importer_text(GMarkupParseContext* context, const gchar* text, gsize text_len,
+		gpointer user_data, GError** error);
+static gboolean meh_importer_insert_game(GamelistImport* import);
+static void meh_importer_clear_values(GamelistImport* import);
+static gchar* meh_importer_resolve_path(const gchar* base_dir, const gchar* path);
+static gchar* meh_importer_release_date(const gchar* value);
+
+/* elements names of the fields, indexed by MEH_IMPORTER_FIELD_* */
+static const gchar* meh_importer_fields[MEH_IMPORTER_FIELD_END] = {
+	[MEH_IMPORTER_FIELD_PATH] = "path",
+	[MEH_IMPORTER_FIELD_NAME] = "name",
+	[MEH_IMPORTER_FIELD_DESC] = "desc",
+	[MEH_IMPORTER_FIELD_GENRE] = "genre",
+	[MEH_IMPORTER_FIELD_PUBLISHER] = "publisher",
+	[MEH_IMPORTER_FIELD_DEVELOPER] = "developer",
+	[MEH_IMPORTER_FIELD_RELEASE_DATE] = "releasedate",
+	[MEH_IMPORTER_FIELD_RATING] = "rating",
+	[MEH_IMPORTER_FIELD_PLAYERS] = "players",
+	[MEH_IMPORTER_FIELD_FAVORITE] = "favorite",
+	[MEH_IMPORTER_FIELD_IMAGE] = "image",
+	[MEH_IMPORTER_FIELD_THUMBNAIL] = "thumbnail",
+	[MEH_IMPORTER_FIELD_MARQUEE] = "marquee",
+	[MEH_IMPORTER_FIELD_VIDEO] = "video",
+};
+
+/* resource type of the fields being resources, MEH_EXEC_RES_OTHER for the others. */
+static const int meh_importer_resources[MEH_IMPORTER_FIELD_END] = {
+	[MEH_IMPORTER_FIELD_IMAGE] = MEH_EXEC_RES_COVER,
+	[MEH_IMPORTER_FIELD_THUMBNAIL] = MEH_EXEC_RES_SCREENSHOT,
+	[MEH_IMPORTER_FIELD_MARQUEE] = MEH_EXEC_RES_LOGO,
+	[MEH_IMPORTER_FIELD_VIDEO] = MEH_EXEC_RES_VIDEO,
+};
+
+static const GMarkupParser meh_importer_parser = {
+	meh_importer_start_element,
+	meh_importer_end_element,
+	meh_importer_text,
+	NULL,
+	NULL,
+};
+
+/*
+ * meh_importer_main imports, without any UI, the gamelist in the platform
+ * given by its id or its name. Used by the --import-gamelist flag.
+ * Returns the exit code of mehstation.
+ */
+int meh_importer_main(const gchar* platform, const gchar* filename) {
+	g_assert(platform != NULL);
+
+	if (filename == NULL) {
+		g_critical("Usage: mehstation --import-gamelist <platform> <gamelist.xml>");
+		return 1;
+	}
+
+	Settings settings;
+	meh_settings_load(&settings);
+
+	DB* db = meh_db_open_or_create("database.db", settings);
+	if (db == NULL) {
+		return 2;
+	}
+
+	if (db->read_only) {
+		g_critical("Can't import in a read-only database, see the [database] settings.");
+		meh_db_close(db);
+		return 2;
+	}
+
+	/* the platform is given by its id or its name */
+	int platform_id = -1;
+	GQueue* platforms = meh_db_get_platforms(db);
+	for (unsigned int i = 0; i < g_queue_get_length(platforms); i++) {
+		Platform* p = g_queue_peek_nth(platforms, i);
+		gchar* id = g_strdup_printf("%d", p->id);
+		if (g_strcmp0(id, platform) == 0 || g_ascii_strcasecmp(p->name, platform) == 0) {
+			platform_id = p->id;
+		}
+		g_free(id);
+	}
+	meh_model_platforms_destroy(platforms);
+
+	if (platform_id == -1) {
+		g_critical("Unknown platform '%s'.", platform);
+		meh_db_close(db);
+		return 1;
+	}
+
+	gboolean success = meh_importer_import_gamelist(db, platform_id, filename);
+
+	meh_db_close(db);
+	return success ? 0 : 3;
+}
+
+/*
+ * meh_importer_import_gamelist streams the given gamelist.xml into the
+ * executables of the platform.
+ * On error, the games of the current transaction are not inserted.
+ */
+gboolean meh_importer_import_gamelist(DB* db, int platform_id, const gchar* filename) {
+	g_assert(db != NULL);
+	g_assert(filename != NULL);
+
+	FILE* file = fopen(filename, "rb");
+	if (file == NULL) {
+		g_critical("Can't open the gamelist '%s'.", filename);
+		return FALSE;
+	}
+
+	GamelistImport import;
+	memset(&import, 0, sizeof(GamelistImport));
+	import.db = db;
+	import.platform_id = platform_id;
+	import.field = -1;
+	import.batch_first_id = -1;
+	import.text = g_string_sized_new(1024);
+
+	gchar* dir = g_path_get_dirname(filename);
+	if (g_path_is_absolute(dir)) {
+		import.base_dir = dir;
+	} else {
+		gchar* cwd = g_get_current_dir();
+		import.base_dir = g_strcmp0(dir, ".") == 0 ? g_strdup(cwd) : g_build_filename(cwd, dir, NULL);
+		g_free(cwd);
+		g_free(dir);
+	}
+
+	g_message("Importing '%s' in the platform %d.", filename, platform_id);
+
+	gint64 start = g_get_monotonic_time();
+	gsize bytes = 0;
+
+	gboolean success = meh_db_begin_bulk_insert(db);
+
+	GMarkupParseContext* context = g_markup_parse_context_new(&meh_importer_parser, 0, &import, NULL);
+	gchar* buffer = g_new(gchar, MEH_IMPORTER_CHUNK_SIZE);
+	GError* error = NULL;
+
+	while (success) {
+		gsize read = fread(buffer, 1, MEH_IMPORTER_CHUNK_SIZE, file);
+		if (read == 0) {
+			success = g_markup_parse_context_end_parse(context, &error);
+			break;
+		}
+		bytes += read;
+		success = g_markup_parse_context_parse(context, buffer, read, &error);
+	}
+
+	if (ferror(file)) {
+		g_critical("Can't read the gamelist '%s'.", filename);
+		success = FALSE;
+	}
+
+	if (error != NULL) {
+		g_critical("Can't parse the gamelist '%s': %s", filename, error->message);
+		g_error_free(error);
+	}
+
+	if (success) {
+		success = meh_db_commit_bulk_insert(db, import.batch_first_id);
+	} else {
+		meh_db_rollback(db);
+	}
+
+	gdouble seconds = (g_get_monotonic_time() - start) / (gdouble)G_USEC_PER_SEC;
+	if (seconds <= 0) {
+		seconds = 1.0 / G_USEC_PER_SEC;
+	}
+
+	g_message("%d games read in %.2fs (%.1f MB/s): %d imported (%.0f games/s) with %d resources, %d already known, %d without path.",
+			import.games, seconds, bytes / seconds / (1024.0 * 1024.0),
+			import.imported, import.imported / seconds, import.resources,
+			import.known, import.invalid);
+
+	g_markup_parse_context_free(context);
+	g_free(buffer);
+	fclose(file);
+
+	meh_importer_clear_values(&import);
+	g_string_free(import.text, TRUE);
+	g_free(import.base_dir);
+
+	return success;
+}
+
+static void meh_importer_start_element(GMarkupParseContext* context, const gchar* element_name,
+		const gchar** attribute_names, const gchar** attribute_values, gpointer user_data, GError** error) {
+	GamelistImport* import = (GamelistImport*)user_data;
+
+	if (g_strcmp0(element_name, "game") == 0) {
+		meh_importer_clear_values(import);
+		import->in_game = TRUE;
+		import->field = -1;
+		return;
+	}
+
+	/* only the direct children of a game are read. */
+	if (!import->in_game || import->field != -1) {
+		return;
+	}
+
+	for (int i = 0; i < MEH_IMPORTER_FIELD_END; i++) {
+		if (g_strcmp0(element_name, meh_importer_fields[i]) == 0) {
+			import->field = i;
+			g_string_truncate(import->text, 0);
+			return;
+		}
+	}
+}
+
+static void meh_importer_end_element(GMarkupParseContext* context, const gchar* element_name,
+		gpointer user_data, GError** error) {
+	GamelistImport* import = (GamelistImport*)user_data;
+
+	if (!import->in_game) {
+		return;
+	}
+
+	if (import->field != -1) {
+		if (g_strcmp0(element_name, meh_importer_fields[import->field]) == 0) {
+			gchar* value = g_strstrip(g_strdup(import->text->str));
+			g_free(import->values[import->field]);
+			import->values[import->field] = NULL;
+			if (strlen(value) > 0) {
+				import->values[import->field] = value;
+			} else {
+				g_free(value);
+			}
+			import->field = -1;
+		}
+		return;
+	}
+
+	if (g_strcmp0(element_name, "game") == 0) {
+		import->in_game = FALSE;
+		if (!meh_importer_insert_game(import)) {
+			g_set_error(error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT, "can't insert the game '%s'",
+					import->values[MEH_IMPORTER_FIELD_PATH]);
+		}
+		meh_importer_clear_values(import);
+	}
+}
+
+static void meh_importer_text(GMarkupParseContext* context, const gchar* text, gsize text_len,
+		gpointer user_data, GError** error) {
+	GamelistImport* import = (GamelistImport*)user_data;
+
+	if (import->in_game && import->field != -1) {
+		g_string_append_len(import->text, text, text_len);
+	}
+}
+
+/*
+ * meh_importer_insert_game inserts the game which has just been read,
+ * then commits the transaction if it contains enough games.
+ * Returns FALSE on a DB error.
+ */
+static gboolean meh_importer_insert_game(GamelistImport* import) {
+	g_assert(import != NULL);
+
+	gchar** values = import->values;
+	import->games++;
+
+	gchar* filepath = meh_importer_resolve_path(import->base_dir, values[MEH_IMPORTER_FIELD_PATH]);
+	if (filepath == NULL) {
+		import->invalid++;
+		return TRUE;
+	}
+
+	if (meh_db_get_executable_id(import->db, import->platform_id, filepath) != -1) {
+		import->known++;
+		g_free(filepath);
+		return TRUE;
+	}
+
+	/* without name, the file name without its extension */
+	gchar* display_name = NULL;
+	if (values[MEH_IMPORTER_FIELD_NAME] != NULL) {
+		display_name = g_strdup(values[MEH_IMPORTER_FIELD_NAME]);
+	} else {
+		display_name = g_path_get_basename(filepath);
+		gchar* extension = strrchr(display_name, '.');
+		if (extension != NULL && extension != display_name) {
+			*extension = '\0';
+		}
+	}
+
+	gchar* release_date = meh_importer_release_date(values[MEH_IMPORTER_FIELD_RELEASE_DATE]);
+
+	int executable_id = meh_db_insert_executable(import->db, import->platform_id, display_name, filepath,
+			values[MEH_IMPORTER_FIELD_DESC],
+			values[MEH_IMPORTER_FIELD_GENRE],
+			values[MEH_IMPORTER_FIELD_PUBLISHER],
+			values[MEH_IMPORTER_FIELD_DEVELOPER],
+			release_date,
+			values[MEH_IMPORTER_FIELD_RATING],
+			values[MEH_IMPORTER_FIELD_PLAYERS],
+			g_strcmp0(values[MEH_IMPORTER_FIELD_FAVORITE], "true") == 0);
+
+	g_free(release_date);
+	g_free(display_name);
+	g_free(filepath);
+
+	if (executable_id == -1) {
+		return FALSE;
+	}
+
+	for (int i = 0; i < MEH_IMPORTER_FIELD_END; i++) {
+		if (meh_importer_resources[i] == MEH_EXEC_RES_OTHER || values[i] == NULL) {
+			continue;
+		}
+
+		gchar* resource = meh_importer_resolve_path(import->base_dir, values[i]);
+		gboolean inserted = meh_db_insert_executable_resource(import->db, executable_id, meh_importer_resources[i], resource);
+		g_free(resource);
+
+		if (!inserted) {
+			return FALSE;
+		}
+		import->resources++;
+	}
+
+	import->imported++;
+	if (import->batch_first_id == -1) {
+		import->batch_first_id = executable_id;
+	}
+
+	/* commits by batches to not grow the journal forever */
+	if (++import->batch >= MEH_IMPORTER_BATCH_SIZE) {
+		gboolean committed = meh_db_commit_bulk_insert(import->db, import->batch_first_id);
+		import->batch = 0;
+		import->batch_first_id = -1;
+		if (!committed || !meh_db_begin_bulk_insert(import->db)) {
+			return FALSE;
+		}
+		g_debug("%d games imported.", import->imported);
+	}
+
+	return TRUE;
+}
+
+static void meh_importer_clear_values(GamelistImport* import) {
+	for (int i = 0; i < MEH_IMPORTER_FIELD_END; i++) {
+		g_free(import->values[i]);
+		import->values[i] = NULL;
+	}
+}
+
+/*
+ * meh_importer_resolve_path makes absolute a path of the gamelist,
+ * EmulationStation writes them relative to the gamelist ("./")
+ * or to the home directory ("~/").
+ * Returns NULL for a NULL path, must be freed otherwise.
+ */
+static gchar* meh_importer_resolve_path(const gchar* base_dir, const gchar* path) {
+	if (path == NULL) {
+		return NULL;
+	}
+
+	if (g_str_has_prefix(path, "~/")) {
+		return g_build_filename(g_get_home_dir(), path + 2, NULL);
+	}
+
+	if (g_path_is_absolute(path)) {
+		return g_strdup(path);
+	}
+
+	if (g_str_has_prefix(path, "./")) {
+		path += 2;
+	}
+
+	return g_build_filename(base_dir, path, NULL);
+}
+
+/*
+ * meh_importer_release_date converts the EmulationStation dates
+ * (19910821T000000) to the YYYY-MM-DD format, any other value is kept.
+ * Returns NULL for a NULL value, must be freed otherwise.
+ */
+static gchar* meh_importer_release_date(const gchar* value) {
+	if (value == NULL) {
+		return NULL;
+	}
+
+	if (strlen(value) >= 8) {
+		gboolean digits = TRUE;
+		for (int i = 0; i < 8; i++) {
+			digits = digits && g_ascii_isdigit(value[i]);
+		}
+		if (digits) {
+			return g_strdup_printf("%.4s-%.2s-%.2s", value, value + 4, value + 6);
+		}
+	}
+
+	return g_strdup(value);
+}
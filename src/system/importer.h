@@ -0,0 +1,60 @@
+/*
+ * mehstation - Import of EmulationStation gamelists.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include "system/db.h"
+
+#define MEH_IMPORTER_BATCH_SIZE (5000) /* games inserted per transaction */
+#define MEH_IMPORTER_CHUNK_SIZE (64*1024) /* bytes of the file given at once to the parser */
+
+/*
+ * Elements of a <game> read by the importer.
+ */
+#define MEH_IMPORTER_FIELD_PATH 0
+#define MEH_IMPORTER_FIELD_NAME 1
+#define MEH_IMPORTER_FIELD_DESC 2
+#define MEH_IMPORTER_FIELD_GENRE 3
+#define MEH_IMPORTER_FIELD_PUBLISHER 4
+#define MEH_IMPORTER_FIELD_DEVELOPER 5
+#define MEH_IMPORTER_FIELD_RELEASE_DATE 6
+#define MEH_IMPORTER_FIELD_RATING 7
+#define MEH_IMPORTER_FIELD_PLAYERS 8
+#define MEH_IMPORTER_FIELD_FAVORITE 9
+#define MEH_IMPORTER_FIELD_IMAGE 10
+#define MEH_IMPORTER_FIELD_THUMBNAIL 11
+#define MEH_IMPORTER_FIELD_MARQUEE 12
+#define MEH_IMPORTER_FIELD_VIDEO 13
+#define MEH_IMPORTER_FIELD_END 14
+
+typedef struct {
+	DB* db;
+	int platform_id;
+	/* directory of the gamelist, the relative paths are relative to it. */
+	gchar* base_dir;
+
+	/* parsing state */
+	gboolean in_game;
+	int field; /* field of the element being read, -1 if none */
+	GString* text;
+	gchar* values[MEH_IMPORTER_FIELD_END];
+
+	/* games inserted in the current transaction */
+	int batch;
+	int batch_first_id; /* id of the first of them, -1 if none */
+
+	/* stats */
+	int games;
+	int imported;
+	int known;
+	int invalid;
+	int resources;
+} GamelistImport;
+
+int meh_importer_main(const gchar* platform, const gchar* filename);
+gboolean meh_importer_import_gamelist(DB* db, int platform_id, const gchar* filename);
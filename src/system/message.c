@@ -21,6 +21,17 @@ void meh_message_send(App* app, Screen* screen, int msg_type, void* data) {
 	meh_message_destroy(message);
 }
 
+/*
+ * meh_message_forward sends a received message to another screen,
+ * the message is still owned by the caller.
+ */
+void meh_message_forward(App* app, Screen* screen, Message* message) {
+	g_assert(screen != NULL);
+	g_assert(message != NULL);
+
+	screen->messages_handler(app, screen, message);
+}
+
 void meh_message_destroy(Message* message) {
 	if (message->data != NULL) {
 		g_free(message->data);
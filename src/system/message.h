@@ -12,4 +12,5 @@ struct Screen;
 
 Message* meh_message_new(int message_id, void* data);
 void meh_message_send(struct App* app, struct Screen* screen, int msg_type, void* data);
+void meh_message_forward(struct App* app, struct Screen* screen, Message* message);
 void meh_message_destroy(Message* message);
@@ -0,0 +1,378 @@
+/*
+ * mehstation - Database schema migrations.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ *
+ * The schema version is stored in the `schema` row of the mehstation
+ * table. res/schema.sql creates a version 1 database, every migration
+ * below then brings the schema to the next version. Migrations are only
+ * appended to this list, never modified once released.
+ */
+
+#include <glib.h>
+#include <sqlite3.h>
+#include <stdlib.h>
+
+#include "system/db.h"
+#include "system/migrations.h"
+
+/*
+ * Resource type (MEH_EXEC_RES_*) of the given type name, used by the
+ * migration 12: never change it.
+ */
+#define MEH_MIGRATION_12_KIND(TYPE) "(CASE " TYPE " WHEN 'fanart' THEN 1 WHEN 'screenshot' THEN 2" \
+	" WHEN 'cover' THEN 3 WHEN 'logo' THEN 4 WHEN 'video' THEN 5 ELSE 0 END)"
+
+/*
+ * meh_migrations[i] migrates the schema from the version i+1 to i+2.
+ */
+static const char* meh_migrations[] = {
+	/* 2: indexes for the executables/resources/mapping lookups. The resources
+	 * index covers the columns read when loading an executable. */
+	"CREATE INDEX IF NOT EXISTS executable_platform ON executable (platform_id);"
+	"CREATE INDEX IF NOT EXISTS executable_resource_executable ON executable_resource (executable_id, id, type, filepath);"
+	"CREATE INDEX IF NOT EXISTS mapping_id ON mapping (id);",
+
+	/* 3: stored sort key for the executables list: favorites first then the
+	 * uppercased name. Maintained by triggers since mehstation-config also
+	 * writes in this table. The list query becomes an index walk. */
+	"ALTER TABLE executable ADD COLUMN sort_key TEXT;"
+	"UPDATE executable SET sort_key = (CASE WHEN favorite > 0 THEN '0' ELSE '1' END) || upper(coalesce(display_name, ''));"
+	"CREATE TRIGGER executable_sort_key_insert AFTER INSERT ON executable BEGIN"
+	"  UPDATE executable SET sort_key = (CASE WHEN NEW.favorite > 0 THEN '0' ELSE '1' END) || upper(coalesce(NEW.display_name, '')) WHERE id = NEW.id;"
+	" END;"
+	"CREATE TRIGGER executable_sort_key_update AFTER UPDATE OF display_name, favorite ON executable BEGIN"
+	"  UPDATE executable SET sort_key = (CASE WHEN NEW.favorite > 0 THEN '0' ELSE '1' END) || upper(coalesce(NEW.display_name, '')) WHERE id = NEW.id;"
+	" END;"
+	"DROP INDEX IF EXISTS executable_platform;"
+	"CREATE INDEX executable_platform_sort ON executable (platform_id, sort_key, id);",
+
+	/* 4: the list only reads the slim columns of the executables, the sort
+	 * index covers them to never read the table rows (and their long
+	 * descriptions) while loading the list. */
+	"DROP INDEX IF EXISTS executable_platform_sort;"
+	"CREATE INDEX executable_platform_list ON executable (platform_id, sort_key, id, display_name, favorite, last_played);",
+
+	/* 5: amount of executables of each platform, kept up-to-date by
+	 * triggers to never count them while browsing the platforms. */
+	"ALTER TABLE platform ADD COLUMN executables_count INTEGER NOT NULL DEFAULT 0;"
+	"UPDATE platform SET executables_count = (SELECT count(id) FROM executable WHERE platform_id = platform.id);"
+	"CREATE TRIGGER executable_count_insert AFTER INSERT ON executable BEGIN"
+	"  UPDATE platform SET executables_count = executables_count + 1 WHERE id = NEW.platform_id;"
+	" END;"
+	"CREATE TRIGGER executable_count_delete AFTER DELETE ON executable BEGIN"
+	"  UPDATE platform SET executables_count = executables_count - 1 WHERE id = OLD.platform_id;"
+	" END;"
+	"CREATE TRIGGER executable_count_update AFTER UPDATE OF platform_id ON executable BEGIN"
+	"  UPDATE platform SET executables_count = executables_count - 1 WHERE id = OLD.platform_id;"
+	"  UPDATE platform SET executables_count = executables_count + 1 WHERE id = NEW.platform_id;"
+	" END;",
+
+	/* 6: full-text search index of the executables, an external content
+	 * FTS5 table kept up-to-date by triggers. Prefix indexes for the
+	 * type-ahead search. */
+	"CREATE VIRTUAL TABLE executable_search USING fts5(display_name, genres, developer, publisher,"
+	"  content='executable', content_rowid='id', prefix='1 2 3');"
+	"INSERT INTO executable_search(executable_search) VALUES ('rebuild');"
+	"CREATE TRIGGER executable_search_insert AFTER INSERT ON executable BEGIN"
+	"  INSERT INTO executable_search(rowid, display_name, genres, developer, publisher)"
+	"  VALUES (NEW.id, NEW.display_name, NEW.genres, NEW.developer, NEW.publisher);"
+	" END;"
+	"CREATE TRIGGER executable_search_delete AFTER DELETE ON executable BEGIN"
+	"  INSERT INTO executable_search(executable_search, rowid, display_name, genres, developer, publisher)"
+	"  VALUES ('delete', OLD.id, OLD.display_name, OLD.genres, OLD.developer, OLD.publisher);"
+	" END;"
+	"CREATE TRIGGER executable_search_update AFTER UPDATE OF display_name, genres, developer, publisher ON executable BEGIN"
+	"  INSERT INTO executable_search(executable_search, rowid, display_name, genres, developer, publisher)"
+	"  VALUES ('delete', OLD.id, OLD.display_name, OLD.genres, OLD.developer, OLD.publisher);"
+	"  INSERT INTO executable_search(rowid, display_name, genres, developer, publisher)"
+	"  VALUES (NEW.id, NEW.display_name, NEW.genres, NEW.developer, NEW.publisher);"
+	" END;",
+
+	/* 7: bulk inserts. An index to find an executable of a platform by
+	 * its file, the importers use it to not insert twice the same executable.
+	 * An insert can directly give the sort key, and the search index isn't
+	 * updated row by row while the 'bulk_insert' row exists: the bulk insert
+	 * indexes all its executables at once before committing. */
+	"CREATE INDEX executable_platform_filepath ON executable (platform_id, filepath);"
+	"DROP TRIGGER executable_sort_key_insert;"
+	"CREATE TRIGGER executable_sort_key_insert AFTER INSERT ON executable WHEN NEW.sort_key IS NULL BEGIN"
+	"  UPDATE executable SET sort_key = (CASE WHEN NEW.favorite > 0 THEN '0' ELSE '1' END) || upper(coalesce(NEW.display_name, '')) WHERE id = NEW.id;"
+	" END;"
+	"DROP TRIGGER executable_search_insert;"
+	"CREATE TRIGGER executable_search_insert AFTER INSERT ON executable"
+	"  WHEN NOT EXISTS (SELECT 1 FROM mehstation WHERE \"name\" = 'bulk_insert') BEGIN"
+	"  INSERT INTO executable_search(rowid, display_name, genres, developer, publisher)"
+	"  VALUES (NEW.id, NEW.display_name, NEW.genres, NEW.developer, NEW.publisher);"
+	" END;",
+
+	/* 8: directory scanned for the executables of a platform, the executables
+	 * whose file has disappeared are marked as missing. The scanner stores the
+	 * mtime of every directory scanned to not list again an unchanged one.
+	 * The bulk inserts also count their executables at once. */
+	"ALTER TABLE platform ADD COLUMN rom_path TEXT;"
+	"ALTER TABLE platform ADD COLUMN extensions TEXT;"
+	"ALTER TABLE executable ADD COLUMN missing INTEGER NOT NULL DEFAULT 0;"
+	"CREATE TABLE scan_directory ("
+	"  platform_id INTEGER NOT NULL,"
+	"  path TEXT NOT NULL,"
+	"  mtime INTEGER NOT NULL,"
+	"  PRIMARY KEY (platform_id, path)"
+	");"
+	"DROP TRIGGER executable_count_insert;"
+	"CREATE TRIGGER executable_count_insert AFTER INSERT ON executable"
+	"  WHEN NOT EXISTS (SELECT 1 FROM mehstation WHERE \"name\" = 'bulk_insert') BEGIN"
+	"  UPDATE platform SET executables_count = executables_count + 1 WHERE id = NEW.platform_id;"
+	" END;",
+
+	/* 9: launches of the executables. The play time is in seconds, the
+	 * partial index only contains the executables played at least once
+	 * and gives the recently played ones in order. */
+	"ALTER TABLE executable ADD COLUMN play_count INTEGER NOT NULL DEFAULT 0;"
+	"ALTER TABLE executable ADD COLUMN play_time INTEGER NOT NULL DEFAULT 0;"
+	"CREATE INDEX executable_last_played ON executable (last_played) WHERE last_played > 0;",
+
+	/* 10: version of the catalog, incremented on every change of the data
+	 * in the snapshot of the catalog. The bulk inserts don't increment it
+	 * row by row: their commit updates the count of every platform. */
+	"INSERT INTO mehstation (\"name\", \"value\") VALUES ('catalog_version', '1');"
+	"CREATE TRIGGER catalog_version_platform_insert AFTER INSERT ON platform BEGIN"
+	"  UPDATE mehstation SET \"value\" = \"value\" + 1 WHERE \"name\" = 'catalog_version';"
+	" END;"
+	"CREATE TRIGGER catalog_version_platform_update AFTER UPDATE ON platform BEGIN"
+	"  UPDATE mehstation SET \"value\" = \"value\" + 1 WHERE \"name\" = 'catalog_version';"
+	" END;"
+	"CREATE TRIGGER catalog_version_platform_delete AFTER DELETE ON platform BEGIN"
+	"  UPDATE mehstation SET \"value\" = \"value\" + 1 WHERE \"name\" = 'catalog_version';"
+	" END;"
+	"CREATE TRIGGER catalog_version_executable_insert AFTER INSERT ON executable"
+	"  WHEN NOT EXISTS (SELECT 1 FROM mehstation WHERE \"name\" = 'bulk_insert') BEGIN"
+	"  UPDATE mehstation SET \"value\" = \"value\" + 1 WHERE \"name\" = 'catalog_version';"
+	" END;"
+	"CREATE TRIGGER catalog_version_executable_update AFTER UPDATE OF display_name, favorite, last_played, sort_key, platform_id ON executable BEGIN"
+	"  UPDATE mehstation SET \"value\" = \"value\" + 1 WHERE \"name\" = 'catalog_version';"
+	" END;"
+	"CREATE TRIGGER catalog_version_executable_delete AFTER DELETE ON executable BEGIN"
+	"  UPDATE mehstation SET \"value\" = \"value\" + 1 WHERE \"name\" = 'catalog_version';"
+	" END;"
+	"CREATE TRIGGER catalog_version_resource_insert AFTER INSERT ON executable_resource"
+	"  WHEN NOT EXISTS (SELECT 1 FROM mehstation WHERE \"name\" = 'bulk_insert') BEGIN"
+	"  UPDATE mehstation SET \"value\" = \"value\" + 1 WHERE \"name\" = 'catalog_version';"
+	" END;"
+	"CREATE TRIGGER catalog_version_resource_update AFTER UPDATE ON executable_resource BEGIN"
+	"  UPDATE mehstation SET \"value\" = \"value\" + 1 WHERE \"name\" = 'catalog_version';"
+	" END;"
+	"CREATE TRIGGER catalog_version_resource_delete AFTER DELETE ON executable_resource BEGIN"
+	"  UPDATE mehstation SET \"value\" = \"value\" + 1 WHERE \"name\" = 'catalog_version';"
+	" END;",
+
+	/* 11: log of the changed rows of the catalog, read by the running
+	 * mehstation to apply the changes done by the other connections
+	 * (mehstation-config, the DB worker). The kind is 0 for a platform,
+	 * 1 for an executable and 2 for the resources of an executable. The
+	 * bulk inserts log one change without executable_id by platform,
+	 * see meh_db_commit_bulk_insert. */
+	"CREATE TABLE catalog_change ("
+	"  \"id\" INTEGER PRIMARY KEY AUTOINCREMENT,"
+	"  \"kind\" INTEGER NOT NULL,"
+	"  \"platform_id\" INTEGER,"
+	"  \"executable_id\" INTEGER"
+	");"
+	"CREATE TRIGGER catalog_change_platform_insert AFTER INSERT ON platform BEGIN"
+	"  INSERT INTO catalog_change (\"kind\", \"platform_id\") VALUES (0, NEW.\"id\");"
+	" END;"
+	"CREATE TRIGGER catalog_change_platform_update AFTER UPDATE ON platform BEGIN"
+	"  INSERT INTO catalog_change (\"kind\", \"platform_id\") VALUES (0, NEW.\"id\");"
+	" END;"
+	"CREATE TRIGGER catalog_change_platform_delete AFTER DELETE ON platform BEGIN"
+	"  INSERT INTO catalog_change (\"kind\", \"platform_id\") VALUES (0, OLD.\"id\");"
+	" END;"
+	"CREATE TRIGGER catalog_change_executable_insert AFTER INSERT ON executable"
+	"  WHEN NOT EXISTS (SELECT 1 FROM mehstation WHERE \"name\" = 'bulk_insert') BEGIN"
+	"  INSERT INTO catalog_change (\"kind\", \"platform_id\", \"executable_id\") VALUES (1, NEW.platform_id, NEW.\"id\");"
+	" END;"
+	/* the sort_key is updated by a trigger after an insert or an update, already logged. */
+	"CREATE TRIGGER catalog_change_executable_update AFTER UPDATE ON executable"
+	"  WHEN OLD.sort_key IS NEW.sort_key BEGIN"
+	"  INSERT INTO catalog_change (\"kind\", \"platform_id\", \"executable_id\") VALUES (1, NEW.platform_id, NEW.\"id\");"
+	"  INSERT INTO catalog_change (\"kind\", \"platform_id\", \"executable_id\")"
+	"    SELECT 1, OLD.platform_id, OLD.\"id\" WHERE OLD.platform_id IS NOT NEW.platform_id;"
+	" END;"
+	"CREATE TRIGGER catalog_change_executable_delete AFTER DELETE ON executable BEGIN"
+	"  INSERT INTO catalog_change (\"kind\", \"platform_id\", \"executable_id\") VALUES (1, OLD.platform_id, OLD.\"id\");"
+	" END;"
+	"CREATE TRIGGER catalog_change_resource_insert AFTER INSERT ON executable_resource"
+	"  WHEN NOT EXISTS (SELECT 1 FROM mehstation WHERE \"name\" = 'bulk_insert') BEGIN"
+	"  INSERT INTO catalog_change (\"kind\", \"platform_id\", \"executable_id\")"
+	"    SELECT 2, platform_id, \"id\" FROM executable WHERE \"id\" = NEW.executable_id;"
+	" END;"
+	"CREATE TRIGGER catalog_change_resource_update AFTER UPDATE ON executable_resource BEGIN"
+	"  INSERT INTO catalog_change (\"kind\", \"platform_id\", \"executable_id\")"
+	"    SELECT 2, platform_id, \"id\" FROM executable WHERE \"id\" IN (OLD.executable_id, NEW.executable_id);"
+	" END;"
+	"CREATE TRIGGER catalog_change_resource_delete AFTER DELETE ON executable_resource BEGIN"
+	"  INSERT INTO catalog_change (\"kind\", \"platform_id\", \"executable_id\")"
+	"    SELECT 2, platform_id, \"id\" FROM executable WHERE \"id\" = OLD.executable_id;"
+	" END;",
+
+	/* 12: type of the resources as an integer (MEH_EXEC_RES_*), the lists
+	 * never read nor compare the type names. mehstation-config only writes
+	 * the names: triggers set the kind when it doesn't match the name.
+	 * Setting the kind isn't a change of the catalog, the update triggers of
+	 * the migrations 10 and 11 are recreated to ignore it. */
+	"ALTER TABLE executable_resource ADD COLUMN kind INTEGER NOT NULL DEFAULT 0;"
+	"DROP TRIGGER catalog_version_resource_update;"
+	"DROP TRIGGER catalog_change_resource_update;"
+	"UPDATE executable_resource SET kind = " MEH_MIGRATION_12_KIND("\"type\"") ";"
+	"UPDATE mehstation SET \"value\" = \"value\" + 1 WHERE \"name\" = 'catalog_version';"
+	"CREATE TRIGGER catalog_version_resource_update AFTER UPDATE OF executable_id, \"type\", filepath ON executable_resource BEGIN"
+	"  UPDATE mehstation SET \"value\" = \"value\" + 1 WHERE \"name\" = 'catalog_version';"
+	" END;"
+	"CREATE TRIGGER catalog_change_resource_update AFTER UPDATE OF executable_id, \"type\", filepath ON executable_resource BEGIN"
+	"  INSERT INTO catalog_change (\"kind\", \"platform_id\", \"executable_id\")"
+	"    SELECT 2, platform_id, \"id\" FROM executable WHERE \"id\" IN (OLD.executable_id, NEW.executable_id);"
+	" END;"
+	"CREATE TRIGGER executable_resource_kind_insert AFTER INSERT ON executable_resource"
+	"  WHEN NEW.kind IS NOT " MEH_MIGRATION_12_KIND("NEW.\"type\"") " BEGIN"
+	"  UPDATE executable_resource SET kind = " MEH_MIGRATION_12_KIND("NEW.\"type\"") " WHERE \"id\" = NEW.\"id\";"
+	" END;"
+	"CREATE TRIGGER executable_resource_kind_update AFTER UPDATE OF \"type\" ON executable_resource"
+	"  WHEN NEW.kind IS NOT " MEH_MIGRATION_12_KIND("NEW.\"type\"") " BEGIN"
+	"  UPDATE executable_resource SET kind = " MEH_MIGRATION_12_KIND("NEW.\"type\"") " WHERE \"id\" = NEW.\"id\";"
+	" END;"
+	"DROP INDEX IF EXISTS executable_resource_executable;"
+	"CREATE INDEX executable_resource_list ON executable_resource (executable_id, id, kind, filepath);",
+
+	/* 13: the executables marked as missing by the scanner are not listed
+	 * nor counted anymore. The list queries all filter on missing = 0,
+	 * the list index has the column to still cover them.
+	 * Marking an executable as missing or back is a change of the catalog. */
+	"DROP INDEX executable_platform_list;"
+	"CREATE INDEX executable_platform_list ON executable (platform_id, missing, sort_key, id, display_name, favorite, last_played);"
+	"UPDATE platform SET executables_count = (SELECT count(id) FROM executable WHERE platform_id = platform.id AND missing = 0);"
+	"DROP TRIGGER executable_count_insert;"
+	"CREATE TRIGGER executable_count_insert AFTER INSERT ON executable"
+	"  WHEN NEW.missing = 0 AND NOT EXISTS (SELECT 1 FROM mehstation WHERE \"name\" = 'bulk_insert') BEGIN"
+	"  UPDATE platform SET executables_count = executables_count + 1 WHERE id = NEW.platform_id;"
+	" END;"
+	"DROP TRIGGER executable_count_delete;"
+	"CREATE TRIGGER executable_count_delete AFTER DELETE ON executable WHEN OLD.missing = 0 BEGIN"
+	"  UPDATE platform SET executables_count = executables_count - 1 WHERE id = OLD.platform_id;"
+	" END;"
+	"DROP TRIGGER executable_count_update;"
+	"CREATE TRIGGER executable_count_update AFTER UPDATE OF platform_id, missing ON executable BEGIN"
+	"  UPDATE platform SET executables_count = executables_count - (OLD.missing = 0) WHERE id = OLD.platform_id;"
+	"  UPDATE platform SET executables_count = executables_count + (NEW.missing = 0) WHERE id = NEW.platform_id;"
+	" END;"
+	"DROP TRIGGER catalog_version_executable_update;"
+	"CREATE TRIGGER catalog_version_executable_update AFTER UPDATE OF display_name, favorite, last_played, sort_key, platform_id, missing ON executable BEGIN"
+	"  UPDATE mehstation SET \"value\" = \"value\" + 1 WHERE \"name\" = 'catalog_version';"
+	" END;"
+	"UPDATE mehstation SET \"value\" = \"value\" + 1 WHERE \"name\" = 'catalog_version';",
+};
+
+/*
+ * meh_migrations_schema_version reads the schema version of the given database.
+ * Returns 0 if it can't be read.
+ */
+int meh_migrations_schema_version(DB* db) {
+	g_assert(db != NULL);
+
+	sqlite3_stmt* statement = NULL;
+	const char* sql = "SELECT \"value\" FROM mehstation WHERE \"name\" = 'schema'";
+
+	int return_code = sqlite3_prepare_v2(db->sqlite, sql, -1, &statement, NULL);
+	if (statement == NULL || return_code != SQLITE_OK) {
+		g_critical("Can't execute the query: %s\nError: %s", sql, sqlite3_errmsg(db->sqlite));
+		sqlite3_finalize(statement);
+		return 0;
+	}
+
+	int version = 0;
+	if (sqlite3_step(statement) == SQLITE_ROW) {
+		const char* value = (const char*)sqlite3_column_text(statement, 0);
+		if (value != NULL) {
+			version = atoi(value);
+		}
+	}
+
+	sqlite3_finalize(statement);
+	return version;
+}
+
+/*
+ * meh_migrations_last_version returns the schema version
+ * after having applied every migration.
+ */
+int meh_migrations_last_version() {
+	return G_N_ELEMENTS(meh_migrations) + 1;
+}
+
+/*
+ * meh_migrations_apply applies one migration and stores the new schema version,
+ * in a transaction.
+ */
+static gboolean meh_migrations_apply(DB* db, int version, const char* migration) {
+	g_assert(db != NULL);
+	g_assert(migration != NULL);
+
+	char* error = NULL;
+
+	if (sqlite3_exec(db->sqlite, "BEGIN", NULL, NULL, &error) != SQLITE_OK) {
+		g_critical("Can't start the migration to the schema %d: %s", version, error);
+		sqlite3_free(error);
+		return FALSE;
+	}
+
+	gchar* update = g_strdup_printf("UPDATE mehstation SET \"value\" = '%d' WHERE \"name\" = 'schema'", version);
+
+	if (sqlite3_exec(db->sqlite, migration, NULL, NULL, &error) != SQLITE_OK ||
+		sqlite3_exec(db->sqlite, update, NULL, NULL, &error) != SQLITE_OK) {
+		g_critical("Can't migrate the database to the schema %d: %s", version, error);
+		sqlite3_free(error);
+		g_free(update);
+		sqlite3_exec(db->sqlite, "ROLLBACK", NULL, NULL, NULL);
+		return FALSE;
+	}
+
+	g_free(update);
+
+	if (sqlite3_exec(db->sqlite, "COMMIT", NULL, NULL, &error) != SQLITE_OK) {
+		g_critical("Can't commit the migration to the schema %d: %s", version, error);
+		sqlite3_free(error);
+		sqlite3_exec(db->sqlite, "ROLLBACK", NULL, NULL, NULL);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*
+ * meh_migrations_run applies, in order, every migration the
+ * given database doesn't have yet.
+ */
+gboolean meh_migrations_run(DB* db) {
+	g_assert(db != NULL);
+
+	int version = meh_migrations_schema_version(db);
+	if (version < 1) {
+		g_critical("Unknown schema version in the database.");
+		return FALSE;
+	}
+
+	int last_version = meh_migrations_last_version();
+
+	if (version > last_version) {
+		g_warning("The database schema (%d) is newer than this mehstation (%d).", version, last_version);
+		return TRUE;
+	}
+
+	for (int i = version - 1; i < G_N_ELEMENTS(meh_migrations); i++) {
+		g_message("Migrating the database schema to the version %d.", i + 2);
+		if (!meh_migrations_apply(db, i + 2, meh_migrations[i])) {
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
@@ -0,0 +1,15 @@
+/*
+ * mehstation - Database schema migrations.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ */
+
+#pragma once
+
+#include <glib.h>
+
+struct DB;
+
+int meh_migrations_schema_version(struct DB* db);
+int meh_migrations_last_version();
+gboolean meh_migrations_run(struct DB* db);
@@ -0,0 +1,528 @@
+/*
+ * mehstation - Scan of the platforms ROM directories.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ *
+ * The ROM directory of a platform is walked by a thread pool, each task
+ * listing one directory and queueing its subdirectories. The files found
+ * are then compared to the executables of the platform: the new ones are
+ * inserted, the disappeared ones marked as missing, in bulk transactions.
+ *
+ * The mtime of every directory is stored: it only changes when an entry
+ * is added, removed or renamed in it, so a directory whose mtime hasn't
+ * changed is not listed again, only its known subdirectories are visited.
+ * Rescanning an unchanged library costs a stat per directory.
+ */
+
+#include <string.h>
+#include <sys/stat.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "system/db.h"
+#include "system/scanner.h"
+#include "system/settings.h"
+#include "system/db/models.h"
+
+static void meh_scanner_queue(PlatformScan* scan, const gchar* path);
+static void meh_scanner_list_directory(gpointer data, gpointer user_data);
+static gboolean meh_scanner_keep_file(PlatformScan* scan, const gchar* name);
+static GHashTable* meh_scanner_extensions(const gchar* extensions);
+static GHashTable* meh_scanner_children(GHashTable* known_directories, const gchar* root);
+static int meh_scanner_apply(DB* db, PlatformScan* scan);
+static int meh_scanner_write_changes(DB* db, PlatformScan* scan, GHashTable* compared, GHashTable* present, GPtrArray* removed);
+static gboolean meh_scanner_write(DB* db, int* writes, int* first_id);
+static void meh_scanned_directory_destroy(gpointer data);
+
+/*
+ * meh_scanner_main scans, without any UI, the ROM directories of every
+ * platform. Used by the --scan flag.
+ * Returns the exit code of mehstation.
+ */
+int meh_scanner_main() {
+	Settings settings;
+	meh_settings_load(&settings);
+
+	DB* db = meh_db_open_or_create("database.db", settings);
+	if (db == NULL) {
+		return 2;
+	}
+
+	int changes = meh_scanner_scan_platforms(db);
+
+	meh_db_close(db);
+	return changes >= 0 ? 0 : 3;
+}
+
+/*
+ * meh_scanner_scan_platforms scans the platforms having a ROM directory.
+ * Returns the amount of executables inserted or marked as missing / back,
+ * -1 on error.
+ */
+int meh_scanner_scan_platforms(DB* db) {
+	g_assert(db != NULL);
+
+	if (db->read_only) {
+		g_warning("The platforms can't be scanned in a read-only database.");
+		return -1;
+	}
+
+	GQueue* platforms = meh_db_get_platforms(db);
+	int changes = 0;
+
+	for (unsigned int i = 0; i < g_queue_get_length(platforms); i++) {
+		Platform* platform = g_queue_peek_nth(platforms, i);
+		if (platform->rom_path == NULL || strlen(platform->rom_path) == 0) {
+			continue;
+		}
+
+		int platform_changes = meh_scanner_scan_platform(db, platform);
+		if (platform_changes < 0) {
+			changes = -1;
+			break;
+		}
+		changes += platform_changes;
+	}
+
+	meh_model_platforms_destroy(platforms);
+	return changes;
+}
+
+/*
+ * meh_scanner_scan_platform scans the ROM directory of the platform.
+ * Returns the amount of executables inserted or marked as missing / back,
+ * -1 on error.
+ */
+int meh_scanner_scan_platform(DB* db, const Platform* platform) {
+	g_assert(db != NULL);
+	g_assert(platform != NULL);
+	g_assert(platform->rom_path != NULL);
+
+	/* an unmounted drive must not mark every executable as missing. */
+	if (!g_file_test(platform->rom_path, G_FILE_TEST_IS_DIR)) {
+		g_warning("The ROM directory '%s' of the platform '%s' isn't available, not scanned.", platform->rom_path, platform->name);
+		return 0;
+	}
+
+	gint64 start = g_get_monotonic_time();
+
+	PlatformScan scan;
+	scan.platform = platform;
+	scan.started = g_get_real_time() / G_USEC_PER_SEC;
+	scan.extensions = meh_scanner_extensions(platform->extensions);
+	scan.known_directories = meh_db_get_scan_directories(db, platform->id);
+	if (scan.known_directories == NULL) {
+		if (scan.extensions != NULL) {
+			g_hash_table_destroy(scan.extensions);
+		}
+		return -1;
+	}
+	scan.known_children = meh_scanner_children(scan.known_directories, platform->rom_path);
+	scan.pending = 0;
+	scan.visited = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	scan.directories = g_queue_new();
+	g_mutex_init(&scan.mutex);
+	g_cond_init(&scan.done);
+
+	scan.pool = g_thread_pool_new(meh_scanner_list_directory, &scan, MEH_SCANNER_THREADS, FALSE, NULL);
+
+	/* walks the directories and waits for the end of the walk. */
+	g_mutex_lock(&scan.mutex);
+	meh_scanner_queue(&scan, platform->rom_path);
+	while (scan.pending > 0) {
+		g_cond_wait(&scan.done, &scan.mutex);
+	}
+	g_mutex_unlock(&scan.mutex);
+
+	g_thread_pool_free(scan.pool, FALSE, TRUE);
+
+	gint64 walked = g_get_monotonic_time();
+
+	int changes = meh_scanner_apply(db, &scan);
+
+	g_message("Platform '%s' scanned in %.3fs (walk %.3fs): %d directories, %d changes.",
+			platform->name, (g_get_monotonic_time() - start) / (gdouble)G_USEC_PER_SEC,
+			(walked - start) / (gdouble)G_USEC_PER_SEC,
+			g_queue_get_length(scan.directories), changes);
+
+	g_queue_free_full(scan.directories, meh_scanned_directory_destroy);
+	g_hash_table_destroy(scan.visited);
+	g_hash_table_destroy(scan.known_children);
+	g_hash_table_destroy(scan.known_directories);
+	if (scan.extensions != NULL) {
+		g_hash_table_destroy(scan.extensions);
+	}
+	g_mutex_clear(&scan.mutex);
+	g_cond_clear(&scan.done);
+
+	return changes;
+}
+
+/*
+ * meh_scanner_queue queues the listing of a directory,
+ * the mutex of the scan must be locked.
+ */
+static void meh_scanner_queue(PlatformScan* scan, const gchar* path) {
+	g_assert(scan != NULL);
+	g_assert(path != NULL);
+
+	scan->pending++;
+	g_thread_pool_push(scan->pool, g_strdup(path), NULL);
+}
+
+/*
+ * meh_scanner_list_directory lists one directory, executed by the pool.
+ */
+static void meh_scanner_list_directory(gpointer data, gpointer user_data) {
+	gchar* path = (gchar*)data;
+	PlatformScan* scan = (PlatformScan*)user_data;
+
+	GStatBuf st;
+	gboolean exists = g_stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+	gboolean listed = FALSE;
+
+	ScannedDirectory* directory = NULL;
+	GPtrArray* subdirectories = NULL; /* not owned if they're the known ones */
+
+	if (exists) {
+		directory = g_new0(ScannedDirectory, 1);
+		directory->path = path;
+		directory->mtime = st.st_mtime;
+
+		gint64* known_mtime = g_hash_table_lookup(scan->known_directories, path);
+		if (known_mtime != NULL && *known_mtime == directory->mtime) {
+			/* unchanged: its subdirectories are the known ones. */
+			subdirectories = g_hash_table_lookup(scan->known_children, path);
+		} else {
+			listed = TRUE;
+			directory->listed = TRUE;
+			directory->files = g_ptr_array_new_with_free_func(g_free);
+			subdirectories = g_ptr_array_new_with_free_func(g_free);
+
+			GDir* dir = g_dir_open(path, 0, NULL);
+			const gchar* name = NULL;
+			while (dir != NULL && (name = g_dir_read_name(dir)) != NULL) {
+				gchar* filepath = g_build_filename(path, name, NULL);
+				GStatBuf file_st;
+				if (g_stat(filepath, &file_st) != 0) {
+					g_free(filepath);
+				} else if (S_ISDIR(file_st.st_mode)) {
+					g_ptr_array_add(subdirectories, filepath);
+				} else if (S_ISREG(file_st.st_mode) && meh_scanner_keep_file(scan, name)) {
+					g_ptr_array_add(directory->files, filepath);
+				} else {
+					g_free(filepath);
+				}
+			}
+			if (dir != NULL) {
+				g_dir_close(dir);
+			}
+		}
+	}
+
+	g_mutex_lock(&scan->mutex);
+
+	if (directory != NULL) {
+		/* the stat of Windows has no inodes. */
+#ifndef WINDOWS
+		gchar* inode = g_strdup_printf("%lu:%lu", (unsigned long)st.st_dev, (unsigned long)st.st_ino);
+		if (g_hash_table_contains(scan->visited, inode)) {
+			g_free(inode);
+			meh_scanned_directory_destroy(directory);
+			directory = NULL;
+		} else {
+			g_hash_table_add(scan->visited, inode);
+		}
+#endif
+	}
+
+	if (directory != NULL) {
+		g_queue_push_tail(scan->directories, directory);
+		for (unsigned int i = 0; subdirectories != NULL && i < subdirectories->len; i++) {
+			meh_scanner_queue(scan, g_ptr_array_index(subdirectories, i));
+		}
+	} else if (!exists) {
+		g_free(path);
+	}
+
+	scan->pending--;
+	if (scan->pending == 0) {
+		g_cond_signal(&scan->done);
+	}
+
+	g_mutex_unlock(&scan->mutex);
+
+	if (listed) {
+		g_ptr_array_free(subdirectories, TRUE);
+	}
+}
+
+/*
+ * meh_scanner_keep_file returns whether the file has one of
+ * the extensions of the platform.
+ */
+static gboolean meh_scanner_keep_file(PlatformScan* scan, const gchar* name) {
+	if (scan->extensions == NULL) {
+		return TRUE;
+	}
+
+	const gchar* extension = strrchr(name, '.');
+	if (extension == NULL) {
+		return FALSE;
+	}
+
+	gchar* lower = g_ascii_strdown(extension + 1, -1);
+	gboolean keep = g_hash_table_contains(scan->extensions, lower);
+	g_free(lower);
+
+	return keep;
+}
+
+/*
+ * meh_scanner_extensions parses the extensions of a platform, separated
+ * by spaces or commas, with or without their dot.
+ * Returns NULL if there is none: every file is kept.
+ */
+static GHashTable* meh_scanner_extensions(const gchar* extensions) {
+	if (extensions == NULL) {
+		return NULL;
+	}
+
+	GHashTable* set = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+	gchar** parts = g_strsplit_set(extensions, " ,;", -1);
+	for (int i = 0; parts[i] != NULL; i++) {
+		const gchar* extension = parts[i];
+		if (extension[0] == '.') {
+			extension++;
+		}
+		if (strlen(extension) > 0) {
+			g_hash_table_add(set, g_ascii_strdown(extension, -1));
+		}
+	}
+	g_strfreev(parts);
+
+	if (g_hash_table_size(set) == 0) {
+		g_hash_table_destroy(set);
+		return NULL;
+	}
+
+	return set;
+}
+
+/*
+ * meh_scanner_children builds the subdirectories of every
+ * known directory, from their paths.
+ */
+static GHashTable* meh_scanner_children(GHashTable* known_directories, const gchar* root) {
+	GHashTable* children = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_ptr_array_unref);
+
+	GHashTableIter iter;
+	gpointer key = NULL;
+	g_hash_table_iter_init(&iter, known_directories);
+	while (g_hash_table_iter_next(&iter, &key, NULL)) {
+		const gchar* path = (const gchar*)key;
+		if (g_strcmp0(path, root) == 0) {
+			continue;
+		}
+
+		gchar* parent = g_path_get_dirname(path);
+		GPtrArray* subdirectories = g_hash_table_lookup(children, parent);
+		if (subdirectories == NULL) {
+			subdirectories = g_ptr_array_new_with_free_func(g_free);
+			g_hash_table_insert(children, parent, subdirectories);
+		} else {
+			g_free(parent);
+		}
+		g_ptr_array_add(subdirectories, g_strdup(path));
+	}
+
+	return children;
+}
+
+/*
+ * meh_scanner_apply compares the listed directories to the directories
+ * known in the DB, then writes the differences with the executables.
+ * Returns the amount of executables inserted or marked as missing / back,
+ * -1 on error.
+ */
+static int meh_scanner_apply(DB* db, PlatformScan* scan) {
+	g_assert(db != NULL);
+	g_assert(scan != NULL);
+
+	/* the directories to compare: the listed ones and
+	 * the known ones which have disappeared. */
+	GHashTable* compared = g_hash_table_new(g_str_hash, g_str_equal);
+	GHashTable* present = g_hash_table_new(g_str_hash, g_str_equal);
+	GHashTable* visited = g_hash_table_new(g_str_hash, g_str_equal);
+
+	for (GList* l = scan->directories->head; l != NULL; l = l->next) {
+		ScannedDirectory* directory = l->data;
+		g_hash_table_add(visited, directory->path);
+		if (directory->listed) {
+			g_hash_table_add(compared, directory->path);
+			for (unsigned int i = 0; i < directory->files->len; i++) {
+				g_hash_table_add(present, g_ptr_array_index(directory->files, i));
+			}
+		}
+	}
+
+	GPtrArray* removed = g_ptr_array_new();
+	GHashTableIter iter;
+	gpointer key = NULL;
+	g_hash_table_iter_init(&iter, scan->known_directories);
+	while (g_hash_table_iter_next(&iter, &key, NULL)) {
+		if (!g_hash_table_contains(visited, key)) {
+			g_ptr_array_add(removed, key);
+			g_hash_table_add(compared, key);
+		}
+	}
+
+	/* nothing has changed: the executables aren't even read. */
+	int changes = 0;
+	if (g_hash_table_size(compared) > 0) {
+		changes = meh_scanner_write_changes(db, scan, compared, present, removed);
+	}
+
+	g_ptr_array_free(removed, TRUE);
+	g_hash_table_destroy(visited);
+	g_hash_table_destroy(present);
+	g_hash_table_destroy(compared);
+
+	return changes;
+}
+
+/*
+ * meh_scanner_write_changes inserts the new files, marks as missing the
+ * files gone from the compared directories and saves the directories
+ * for the next scan, in bulk transactions.
+ * Returns the amount of executables inserted or marked as missing / back,
+ * -1 on error.
+ */
+static int meh_scanner_write_changes(DB* db, PlatformScan* scan, GHashTable* compared, GHashTable* present, GPtrArray* removed) {
+	int platform_id = scan->platform->id;
+
+	GHashTable* files = meh_db_get_platform_files(db, platform_id);
+	if (files == NULL) {
+		return -1;
+	}
+
+	if (!meh_db_begin_bulk_insert(db)) {
+		g_hash_table_destroy(files);
+		return -1;
+	}
+
+	int changes = 0;
+	int writes = 0;
+	int first_id = -1;
+	gboolean success = TRUE;
+
+	/* new files and files back */
+	for (GList* l = scan->directories->head; success && l != NULL; l = l->next) {
+		ScannedDirectory* directory = l->data;
+		for (unsigned int i = 0; success && directory->listed && i < directory->files->len; i++) {
+			const gchar* filepath = g_ptr_array_index(directory->files, i);
+			ExecutableFile* file = g_hash_table_lookup(files, filepath);
+
+			if (file == NULL) {
+				gchar* display_name = g_path_get_basename(filepath);
+				gchar* extension = strrchr(display_name, '.');
+				if (extension != NULL && extension != display_name) {
+					*extension = '\0';
+				}
+				int id = meh_db_insert_executable(db, platform_id, display_name, filepath,
+						NULL, NULL, NULL, NULL, NULL, NULL, NULL, FALSE);
+				g_free(display_name);
+				success = id != -1;
+				if (first_id == -1) {
+					first_id = id;
+				}
+			} else if (file->missing) {
+				success = meh_db_set_executable_missing(db, file->id, FALSE);
+			} else {
+				continue;
+			}
+
+			changes++;
+			success = success && meh_scanner_write(db, &writes, &first_id);
+		}
+	}
+
+	/* files gone from the compared directories */
+	GHashTableIter iter;
+	gpointer key = NULL;
+	gpointer value = NULL;
+	g_hash_table_iter_init(&iter, files);
+	while (success && g_hash_table_iter_next(&iter, &key, &value)) {
+		ExecutableFile* file = (ExecutableFile*)value;
+		if (file->missing || g_hash_table_contains(present, key)) {
+			continue;
+		}
+
+		gchar* dirname = g_path_get_dirname(key);
+		gboolean gone = g_hash_table_contains(compared, dirname);
+		g_free(dirname);
+
+		if (gone) {
+			success = meh_db_set_executable_missing(db, file->id, TRUE) && meh_scanner_write(db, &writes, &first_id);
+			changes++;
+		}
+	}
+
+	/* mtimes of the directories for the next scan, the ones modified
+	 * during this second could still change without a new mtime: they'll
+	 * be listed again. */
+	for (GList* l = scan->directories->head; success && l != NULL; l = l->next) {
+		ScannedDirectory* directory = l->data;
+		if (directory->listed) {
+			gint64 mtime = directory->mtime >= scan->started - 1 ? 0 : directory->mtime;
+			success = meh_db_save_scan_directory(db, platform_id, directory->path, mtime) && meh_scanner_write(db, &writes, &first_id);
+		}
+	}
+
+	for (unsigned int i = 0; success && i < removed->len; i++) {
+		success = meh_db_delete_scan_directory(db, platform_id, g_ptr_array_index(removed, i)) && meh_scanner_write(db, &writes, &first_id);
+	}
+
+	if (success) {
+		success = meh_db_commit_bulk_insert(db, first_id);
+	} else {
+		meh_db_rollback(db);
+	}
+
+	g_hash_table_destroy(files);
+
+	if (!success) {
+		g_critical("Can't save the scan of the platform '%s'.", scan->platform->name);
+		return -1;
+	}
+
+	return changes;
+}
+
+/*
+ * meh_scanner_write counts a write of the current bulk transaction,
+ * commits it and starts a new one when it's big enough.
+ */
+static gboolean meh_scanner_write(DB* db, int* writes, int* first_id) {
+	if (++(*writes) < MEH_SCANNER_BATCH_SIZE) {
+		return TRUE;
+	}
+
+	gboolean committed = meh_db_commit_bulk_insert(db, *first_id);
+	*writes = 0;
+	*first_id = -1;
+
+	return committed && meh_db_begin_bulk_insert(db);
+}
+
+static void meh_scanned_directory_destroy(gpointer data) {
+	ScannedDirectory* directory = (ScannedDirectory*)data;
+	g_assert(directory != NULL);
+
+	g_free(directory->path);
+	if (directory->files != NULL) {
+		g_ptr_array_free(directory->files, TRUE);
+	}
+	g_free(directory);
+}
@@ -0,0 +1,54 @@
+/*
+ * mehstation - Scan of the platforms ROM directories.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include "system/db.h"
+#include "system/db/platform.h"
+
+#define MEH_SCANNER_THREADS (4) /* directories listed in parallel */
+#define MEH_SCANNER_BATCH_SIZE (5000) /* writes per transaction */
+
+/*
+ * A directory visited by a scan.
+ */
+typedef struct ScannedDirectory {
+	gchar* path;
+	gint64 mtime;
+	/* FALSE if its mtime hasn't changed since the last scan:
+	 * it has not been listed again and `files` is NULL. */
+	gboolean listed;
+	GPtrArray* files; /* full paths of the executables files, must be freed */
+} ScannedDirectory;
+
+/*
+ * The state of the scan of one platform, shared by the threads
+ * of the pool listing the directories.
+ */
+typedef struct PlatformScan {
+	const Platform* platform;
+	gint64 started; /* unix time */
+
+	/* read-only while the directories are listed */
+	GHashTable* extensions; /* lowercase extensions to keep, NULL to keep every file */
+	GHashTable* known_directories; /* path -> mtime (gint64*) of the last scan */
+	GHashTable* known_children; /* path -> GPtrArray of the known subdirectories */
+
+	GThreadPool* pool;
+
+	/* protected by the mutex */
+	GMutex mutex;
+	GCond done;
+	int pending; /* directories queued and not listed yet */
+	GHashTable* visited; /* "device:inode" of the visited directories, avoids the symlinks loops */
+	GQueue* directories; /* ScannedDirectory* */
+} PlatformScan;
+
+int meh_scanner_main();
+int meh_scanner_scan_platforms(DB* db);
+int meh_scanner_scan_platform(DB* db, const Platform* platform);
@@ -4,33 +4,49 @@
 
 #include "settings.h"
 
+/*
+ * meh_settings_load reads the settings of mehstation.conf, every
+ * setting has its default value if the file can't be read.
+ */
+gboolean meh_settings_load(Settings* settings) {
+	g_assert(settings != NULL);
+
+	if (!meh_settings_read(settings, MEH_SETTINGS_FILE)) {
+		g_warning("Using the default settings.");
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
 /*
  * meh_read_settings opens the given file and read its content
- * to fill the provided settings.
+ * to fill the provided settings. Every setting is filled, with its
+ * default value if the file doesn't exist: returns FALSE then.
  */
 gboolean meh_settings_read(Settings *settings, const char *filename) {
 	g_assert(settings != NULL);
 	g_assert(filename != NULL);
 	g_assert(strlen(filename) > 0);
 
+	GKeyFile* keyfile = g_key_file_new();
+
 	/* Test for the existence of the file. */
 	gboolean exists = g_file_test(filename, G_FILE_TEST_EXISTS);
 	if (!exists) {
 		g_critical("The configuration file doesn't exist.");
-		return FALSE;
-	}
-
-	GKeyFile* keyfile = g_key_file_new();
-	GError* error = NULL;
-	g_key_file_load_from_file(
-			keyfile,
-			filename,
-			G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS,
-			&error);
-
-	if (error != NULL) {
-		g_critical("Error while reading the configuration file: %s", error->message);
-		g_error_free(error);
+	} else {
+		GError* error = NULL;
+		g_key_file_load_from_file(
+				keyfile,
+				filename,
+				G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS,
+				&error);
+
+		if (error != NULL) {
+			g_critical("Error while reading the configuration file: %s", error->message);
+			g_error_free(error);
+		}
 	}
 
 	settings->name = meh_settings_read_string(keyfile, "mehstation", "name", "mehstation 1.0");
@@ -46,9 +62,31 @@ gboolean meh_settings_read(Settings *settings, const char *filename) {
 	settings->fade_duration = meh_settings_read_int(keyfile, "render", "fade_duration", 300);
 	settings->zoom_logo = meh_settings_read_bool(keyfile, "render", "zoom_logo", FALSE);
 
+	settings->db_journal_mode = meh_settings_read_string(keyfile, "database", "journal_mode", "WAL");
+	settings->db_synchronous = meh_settings_read_string(keyfile, "database", "synchronous", "NORMAL");
+	settings->db_cache_size = meh_settings_read_int(keyfile, "database", "cache_size", -8192);
+	settings->db_mmap_size = meh_settings_read_int(keyfile, "database", "mmap_size", 67108864);
+	settings->db_temp_store = meh_settings_read_string(keyfile, "database", "temp_store", "MEMORY");
+	settings->db_read_only = meh_settings_read_bool(keyfile, "database", "read_only", FALSE);
+	settings->db_immutable = meh_settings_read_bool(keyfile, "database", "immutable", FALSE);
+	settings->db_profile = meh_settings_read_bool(keyfile, "database", "profile", FALSE);
+	settings->db_slow_query_ms = meh_settings_read_int(keyfile, "database", "slow_query_ms", 100);
+	settings->db_maintenance_idle = meh_settings_read_int(keyfile, "database", "maintenance_idle", 5);
+
+	settings->catalog_paging_threshold = meh_settings_read_int(keyfile, "catalog", "paging_threshold", 5000);
+	settings->catalog_scan_on_startup = meh_settings_read_bool(keyfile, "catalog", "scan_on_startup", FALSE);
+	settings->catalog_snapshot = meh_settings_read_bool(keyfile, "catalog", "snapshot", TRUE);
+
+	settings->images_decode_threads = meh_settings_read_int(keyfile, "images", "decode_threads", 2);
+	settings->images_prefetch = meh_settings_read_int(keyfile, "images", "prefetch", 3);
+	settings->images_cache_budget = meh_settings_read_int(keyfile, "images", "cache_budget", 128);
+	settings->images_thumbnails = meh_settings_read_string(keyfile, "images", "thumbnails", "thumbnails");
+
 	g_message("Zoom: %d", settings->zoom_logo);
 
-	return TRUE;
+	g_key_file_free(keyfile);
+
+	return exists;
 }
 
 gchar* meh_settings_read_string(GKeyFile* keyfile, const gchar* group_name, const gchar* key, gchar* default_value) {
@@ -2,6 +2,8 @@
 
 #include "glib-2.0/glib.h"
 
+#define MEH_SETTINGS_FILE "mehstation.conf"
+
 typedef struct {
 	/* mehstation */
 	gchar* name;
@@ -16,8 +18,29 @@ typedef struct {
 	guint max_frameskip;
 	guint fade_duration;
 	gboolean zoom_logo;
+	/* database */
+	gchar* db_journal_mode;
+	gchar* db_synchronous;
+	gint db_cache_size;
+	gint db_mmap_size;
+	gchar* db_temp_store;
+	gboolean db_read_only;
+	gboolean db_immutable;
+	gboolean db_profile;
+	gint db_slow_query_ms;
+	gint db_maintenance_idle;
+	/* catalog */
+	guint catalog_paging_threshold;
+	gboolean catalog_scan_on_startup;
+	gboolean catalog_snapshot;
+	/* images */
+	gint images_decode_threads;
+	gint images_prefetch;
+	gint images_cache_budget;
+	gchar* images_thumbnails;
 } Settings;
 
+gboolean meh_settings_load(Settings* settings);
 gboolean meh_settings_read(Settings *settings, const gchar *filename);
 gchar* meh_settings_read_string(GKeyFile* keyfile, const gchar* group_name, const gchar* key, gchar* default_value);
 int meh_settings_read_int(GKeyFile* keyfile, const gchar* group_name, const gchar* key, int default_value);
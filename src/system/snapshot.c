@@ -0,0 +1,393 @@
+/*
+ * mehstation - Memory-mapped snapshot of the catalog.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ *
+ * The platforms and the slim executables with their resources are
+ * written in a binary file next to the database. It's opened with
+ * mmap at startup: the lists are built from it without any query.
+ * The snapshot is only used while its version is the catalog_version
+ * of the DB, which is incremented by triggers on every change of
+ * the data it contains (see the migration 10).
+ */
+
+#include <string.h>
+
+#include "system/snapshot.h"
+#include "system/db/models.h"
+
+G_STATIC_ASSERT(sizeof(SnapshotHeader) == 32);
+G_STATIC_ASSERT(sizeof(SnapshotPlatform) == 40);
+G_STATIC_ASSERT(sizeof(SnapshotExecutable) == 32);
+G_STATIC_ASSERT(sizeof(SnapshotResource) == 12);
+
+static const gchar* meh_snapshot_string(const Snapshot* snapshot, guint32 offset);
+static Platform* meh_snapshot_read_platform(const Snapshot* snapshot, const SnapshotPlatform* record);
+static guint32 meh_snapshot_writer_string(SnapshotWriter* writer, const gchar* str);
+
+/*
+ * meh_snapshot_open maps the given snapshot file, NULL if it doesn't
+ * exist, is invalid or hasn't been written for the given version.
+ */
+Snapshot* meh_snapshot_open(const gchar* filename, gint64 version) {
+	g_assert(filename != NULL);
+
+	GError* error = NULL;
+	GMappedFile* file = g_mapped_file_new(filename, FALSE, &error);
+	if (error != NULL) {
+		g_debug("No catalog snapshot available: %s", error->message);
+		g_error_free(error);
+		return NULL;
+	}
+
+	const gchar* contents = g_mapped_file_get_contents(file);
+	gsize length = g_mapped_file_get_length(file);
+	const SnapshotHeader* header = (const SnapshotHeader*)contents;
+
+	if (length < sizeof(SnapshotHeader) || memcmp(header->magic, MEH_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) {
+		g_warning("The catalog snapshot '%s' is invalid.", filename);
+		g_mapped_file_unref(file);
+		return NULL;
+	}
+
+	if (header->version != version) {
+		g_debug("The catalog snapshot is stale (version %" G_GINT64_FORMAT ", catalog %" G_GINT64_FORMAT ").", header->version, version);
+		g_mapped_file_unref(file);
+		return NULL;
+	}
+
+	guint64 expected = sizeof(SnapshotHeader) +
+		(guint64)header->platforms_count * sizeof(SnapshotPlatform) +
+		(guint64)header->executables_count * sizeof(SnapshotExecutable) +
+		(guint64)header->resources_count * sizeof(SnapshotResource) +
+		header->strings_size;
+
+	if (length != expected || (header->strings_size > 0 && contents[length-1] != '\0')) {
+		g_warning("The catalog snapshot '%s' is truncated.", filename);
+		g_mapped_file_unref(file);
+		return NULL;
+	}
+
+	Snapshot* snapshot = g_new(Snapshot, 1);
+
+	snapshot->file = file;
+	snapshot->version = version;
+	snapshot->header = header;
+	snapshot->platforms = (const SnapshotPlatform*)(contents + sizeof(SnapshotHeader));
+	snapshot->executables = (const SnapshotExecutable*)(snapshot->platforms + header->platforms_count);
+	snapshot->resources = (const SnapshotResource*)(snapshot->executables + header->executables_count);
+	snapshot->strings = (const gchar*)(snapshot->resources + header->resources_count);
+
+	/* the records ranges are checked once here. */
+	for (guint32 i = 0; i < header->platforms_count; i++) {
+		const SnapshotPlatform* platform = &snapshot->platforms[i];
+		if ((guint64)platform->first_executable + platform->executables > header->executables_count) {
+			g_warning("The catalog snapshot '%s' is invalid.", filename);
+			meh_snapshot_close(snapshot);
+			return NULL;
+		}
+	}
+
+	for (guint32 i = 0; i < header->executables_count; i++) {
+		const SnapshotExecutable* executable = &snapshot->executables[i];
+		if ((guint64)executable->first_resource + executable->resources > header->resources_count) {
+			g_warning("The catalog snapshot '%s' is invalid.", filename);
+			meh_snapshot_close(snapshot);
+			return NULL;
+		}
+	}
+
+	g_message("Catalog snapshot opened: %u platforms, %u executables, %u resources.",
+			header->platforms_count, header->executables_count, header->resources_count);
+
+	return snapshot;
+}
+
+void meh_snapshot_close(Snapshot* snapshot) {
+	if (snapshot == NULL) {
+		return;
+	}
+
+	g_mapped_file_unref(snapshot->file);
+	g_free(snapshot);
+}
+
+/*
+ * meh_snapshot_string returns the string stored at the given
+ * offset of the strings table, NULL for an invalid offset.
+ */
+static const gchar* meh_snapshot_string(const Snapshot* snapshot, guint32 offset) {
+	if (offset >= snapshot->header->strings_size) {
+		return NULL;
+	}
+	return snapshot->strings + offset;
+}
+
+static Platform* meh_snapshot_read_platform(const Snapshot* snapshot, const SnapshotPlatform* record) {
+	return meh_model_platform_new(record->id,
+			meh_snapshot_string(snapshot, record->name),
+			meh_snapshot_string(snapshot, record->command),
+			meh_snapshot_string(snapshot, record->icon),
+			meh_snapshot_string(snapshot, record->background),
+			record->executables_count,
+			meh_snapshot_string(snapshot, record->rom_path),
+			meh_snapshot_string(snapshot, record->extensions));
+}
+
+/*
+ * meh_snapshot_get_platforms returns the platforms ordered by name.
+ */
+GQueue* meh_snapshot_get_platforms(const Snapshot* snapshot) {
+	g_assert(snapshot != NULL);
+
+	GQueue* platforms = g_queue_new();
+	for (guint32 i = 0; i < snapshot->header->platforms_count; i++) {
+		g_queue_push_tail(platforms, meh_snapshot_read_platform(snapshot, &snapshot->platforms[i]));
+	}
+	return platforms;
+}
+
+/*
+ * meh_snapshot_get_platform returns the given platform, NULL if unknown.
+ */
+Platform* meh_snapshot_get_platform(const Snapshot* snapshot, int platform_id) {
+	g_assert(snapshot != NULL);
+
+	for (guint32 i = 0; i < snapshot->header->platforms_count; i++) {
+		if (snapshot->platforms[i].id == platform_id) {
+			return meh_snapshot_read_platform(snapshot, &snapshot->platforms[i]);
+		}
+	}
+	return NULL;
+}
+
+/*
+ * meh_snapshot_get_platform_executables returns the slim executables of the
+ * given platform with their resources, in the list order, NULL if the platform
+ * is unknown.
+ */
+GQueue* meh_snapshot_get_platform_executables(const Snapshot* snapshot, int platform_id) {
+	g_assert(snapshot != NULL);
+
+	const SnapshotPlatform* platform = NULL;
+	for (guint32 i = 0; i < snapshot->header->platforms_count; i++) {
+		if (snapshot->platforms[i].id == platform_id) {
+			platform = &snapshot->platforms[i];
+			break;
+		}
+	}
+
+	if (platform == NULL) {
+		return NULL;
+	}
+
+	CatalogBuilder* builder = meh_model_catalog_builder_new(platform->executables);
+
+	for (guint32 i = 0; i < platform->executables; i++) {
+		const SnapshotExecutable* record = &snapshot->executables[platform->first_executable + i];
+
+		meh_model_catalog_builder_add_executable(builder, record->id,
+				meh_snapshot_string(snapshot, record->display_name),
+				record->favorite > 0 ? TRUE : FALSE,
+				record->last_played);
+
+		for (guint32 j = 0; j < record->resources; j++) {
+			const SnapshotResource* resource = &snapshot->resources[record->first_resource + j];
+			meh_model_catalog_builder_add_resource(builder, resource->id,
+					resource->type,
+					meh_snapshot_string(snapshot, resource->filepath));
+		}
+	}
+
+	GQueue* executables = meh_model_catalog_builder_finish(builder);
+
+	return executables;
+}
+
+/*
+ * meh_snapshot_writer_new starts a snapshot of the given catalog version.
+ * The platforms must be added first, then the executables grouped by
+ * platform, each one followed by its resources.
+ */
+SnapshotWriter* meh_snapshot_writer_new(gint64 version) {
+	SnapshotWriter* writer = g_new(SnapshotWriter, 1);
+
+	writer->version = version;
+	writer->platforms = g_array_new(FALSE, TRUE, sizeof(SnapshotPlatform));
+	writer->executables = g_array_new(FALSE, TRUE, sizeof(SnapshotExecutable));
+	writer->resources = g_array_new(FALSE, TRUE, sizeof(SnapshotResource));
+	writer->strings = g_string_new(NULL);
+	writer->offsets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	writer->platforms_index = g_hash_table_new(g_direct_hash, g_direct_equal);
+	writer->current_platform = -1;
+	writer->executable_added = FALSE;
+
+	return writer;
+}
+
+void meh_snapshot_writer_destroy(SnapshotWriter* writer) {
+	if (writer == NULL) {
+		return;
+	}
+
+	g_array_free(writer->platforms, TRUE);
+	g_array_free(writer->executables, TRUE);
+	g_array_free(writer->resources, TRUE);
+	g_string_free(writer->strings, TRUE);
+	g_hash_table_destroy(writer->offsets);
+	g_hash_table_destroy(writer->platforms_index);
+	g_free(writer);
+}
+
+/*
+ * meh_snapshot_writer_string stores the string in the strings
+ * table if it's not already there, returns its offset.
+ */
+static guint32 meh_snapshot_writer_string(SnapshotWriter* writer, const gchar* str) {
+	if (str == NULL) {
+		return MEH_SNAPSHOT_NULL;
+	}
+
+	gpointer offset = NULL;
+	if (g_hash_table_lookup_extended(writer->offsets, str, NULL, &offset)) {
+		return GPOINTER_TO_UINT(offset);
+	}
+
+	guint32 new_offset = writer->strings->len;
+	g_string_append_len(writer->strings, str, strlen(str) + 1);
+	g_hash_table_insert(writer->offsets, g_strdup(str), GUINT_TO_POINTER(new_offset));
+
+	return new_offset;
+}
+
+void meh_snapshot_writer_add_platform(SnapshotWriter* writer, const Platform* platform) {
+	g_assert(writer != NULL);
+	g_assert(platform != NULL);
+
+	SnapshotPlatform record;
+	memset(&record, 0, sizeof(SnapshotPlatform));
+
+	record.id = platform->id;
+	record.name = meh_snapshot_writer_string(writer, platform->name);
+	record.command = meh_snapshot_writer_string(writer, platform->command);
+	record.icon = meh_snapshot_writer_string(writer, platform->icon);
+	record.background = meh_snapshot_writer_string(writer, platform->background);
+	record.rom_path = meh_snapshot_writer_string(writer, platform->rom_path);
+	record.extensions = meh_snapshot_writer_string(writer, platform->extensions);
+	record.executables_count = platform->executables_count;
+	record.first_executable = 0;
+	record.executables = 0;
+
+	g_array_append_val(writer->platforms, record);
+	g_hash_table_insert(writer->platforms_index, GINT_TO_POINTER(platform->id), GUINT_TO_POINTER(writer->platforms->len));
+}
+
+/*
+ * meh_snapshot_writer_add_executable adds an executable to the given platform.
+ * Returns FALSE if it has been ignored: unknown platform or executables of
+ * the platform not consecutive.
+ */
+gboolean meh_snapshot_writer_add_executable(SnapshotWriter* writer, int platform_id, int id,
+		const gchar* display_name, gboolean favorite, gint64 last_played) {
+	g_assert(writer != NULL);
+
+	writer->executable_added = FALSE;
+
+	SnapshotPlatform* platform = NULL;
+	if (writer->current_platform >= 0) {
+		platform = &g_array_index(writer->platforms, SnapshotPlatform, writer->current_platform);
+	}
+
+	if (platform == NULL || platform->id != platform_id) {
+		/* the executables of a new platform start. */
+		int index = GPOINTER_TO_UINT(g_hash_table_lookup(writer->platforms_index, GINT_TO_POINTER(platform_id))) - 1;
+		if (index < 0) {
+			return FALSE;
+		}
+		platform = &g_array_index(writer->platforms, SnapshotPlatform, index);
+		if (platform->executables > 0) {
+			return FALSE;
+		}
+		writer->current_platform = index;
+		platform->first_executable = writer->executables->len;
+	}
+
+	SnapshotExecutable record;
+	memset(&record, 0, sizeof(SnapshotExecutable));
+
+	record.last_played = last_played;
+	record.id = id;
+	record.display_name = meh_snapshot_writer_string(writer, display_name);
+	record.favorite = favorite ? 1 : 0;
+	record.first_resource = writer->resources->len;
+	record.resources = 0;
+
+	g_array_append_val(writer->executables, record);
+	platform->executables++;
+	writer->executable_added = TRUE;
+
+	return TRUE;
+}
+
+/*
+ * meh_snapshot_writer_add_resource adds a resource to the last executable
+ * added, ignored if this executable has been ignored.
+ */
+void meh_snapshot_writer_add_resource(SnapshotWriter* writer, int id, int type, const gchar* filepath) {
+	g_assert(writer != NULL);
+
+	if (!writer->executable_added) {
+		return;
+	}
+
+	SnapshotResource record;
+	record.id = id;
+	record.type = type;
+	record.filepath = meh_snapshot_writer_string(writer, filepath);
+
+	g_array_append_val(writer->resources, record);
+	g_array_index(writer->executables, SnapshotExecutable, writer->executables->len - 1).resources++;
+}
+
+/*
+ * meh_snapshot_writer_save writes the snapshot in the given file. The file is
+ * replaced atomically: a snapshot already mapped stays valid.
+ */
+gboolean meh_snapshot_writer_save(SnapshotWriter* writer, const gchar* filename) {
+	g_assert(writer != NULL);
+	g_assert(filename != NULL);
+
+	SnapshotHeader header;
+	memset(&header, 0, sizeof(SnapshotHeader));
+
+	memcpy(header.magic, MEH_SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = writer->version;
+	header.platforms_count = writer->platforms->len;
+	header.executables_count = writer->executables->len;
+	header.resources_count = writer->resources->len;
+	header.strings_size = writer->strings->len;
+
+	GByteArray* content = g_byte_array_sized_new(sizeof(SnapshotHeader) +
+			writer->platforms->len * sizeof(SnapshotPlatform) +
+			writer->executables->len * sizeof(SnapshotExecutable) +
+			writer->resources->len * sizeof(SnapshotResource) +
+			writer->strings->len);
+
+	g_byte_array_append(content, (const guint8*)&header, sizeof(SnapshotHeader));
+	g_byte_array_append(content, (const guint8*)writer->platforms->data, writer->platforms->len * sizeof(SnapshotPlatform));
+	g_byte_array_append(content, (const guint8*)writer->executables->data, writer->executables->len * sizeof(SnapshotExecutable));
+	g_byte_array_append(content, (const guint8*)writer->resources->data, writer->resources->len * sizeof(SnapshotResource));
+	g_byte_array_append(content, (const guint8*)writer->strings->str, writer->strings->len);
+
+	GError* error = NULL;
+	g_file_set_contents(filename, (const gchar*)content->data, content->len, &error);
+	g_byte_array_free(content, TRUE);
+
+	if (error != NULL) {
+		g_warning("Can't write the catalog snapshot '%s': %s", filename, error->message);
+		g_error_free(error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
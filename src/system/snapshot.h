@@ -0,0 +1,103 @@
+/*
+ * mehstation - Memory-mapped snapshot of the catalog.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include "system/db/platform.h"
+
+#define MEH_SNAPSHOT_MAGIC "MEHSNAP2"
+#define MEH_SNAPSHOT_NULL G_MAXUINT32 /* offset of a NULL string */
+
+/*
+ * The snapshot file is, in the native byte order:
+ * a header, the platforms records ordered by name, the executables
+ * records grouped by platform in the list order, the resources records
+ * grouped by executable, then the strings table: NUL-terminated strings
+ * referenced by their offset in the table.
+ */
+typedef struct SnapshotHeader {
+	gchar magic[8];
+	gint64 version; /* catalog_version of the DB when the snapshot has been written */
+	guint32 platforms_count;
+	guint32 executables_count;
+	guint32 resources_count;
+	guint32 strings_size;
+} SnapshotHeader;
+
+typedef struct SnapshotPlatform {
+	gint32 id;
+	guint32 name;
+	guint32 command;
+	guint32 icon;
+	guint32 background;
+	guint32 rom_path;
+	guint32 extensions;
+	gint32 executables_count;
+	guint32 first_executable; /* index of its first executable record */
+	guint32 executables; /* amount of executables records */
+} SnapshotPlatform;
+
+typedef struct SnapshotExecutable {
+	gint64 last_played;
+	gint32 id;
+	guint32 display_name;
+	gint32 favorite;
+	guint32 first_resource; /* index of its first resource record */
+	guint32 resources; /* amount of resources records */
+	guint32 padding;
+} SnapshotExecutable;
+
+typedef struct SnapshotResource {
+	gint32 id;
+	guint32 type; /* MEH_EXEC_RES_* */
+	guint32 filepath;
+} SnapshotResource;
+
+/*
+ * A snapshot opened with mmap.
+ */
+typedef struct Snapshot {
+	GMappedFile* file;
+	gint64 version;
+
+	/* pointers in the mapped file */
+	const SnapshotHeader* header;
+	const SnapshotPlatform* platforms;
+	const SnapshotExecutable* executables;
+	const SnapshotResource* resources;
+	const gchar* strings;
+} Snapshot;
+
+/*
+ * Builds a snapshot in memory before saving it, see meh_db_write_snapshot.
+ */
+typedef struct SnapshotWriter {
+	gint64 version;
+	GArray* platforms; /* SnapshotPlatform */
+	GArray* executables; /* SnapshotExecutable */
+	GArray* resources; /* SnapshotResource */
+	GString* strings;
+	GHashTable* offsets; /* string -> offset in the table, the same string is stored once */
+	GHashTable* platforms_index; /* platform id -> index of its record + 1 */
+	int current_platform; /* index of the platform of the last executable added, -1 if none */
+	gboolean executable_added; /* FALSE if the last executable has been ignored */
+} SnapshotWriter;
+
+Snapshot* meh_snapshot_open(const gchar* filename, gint64 version);
+void meh_snapshot_close(Snapshot* snapshot);
+GQueue* meh_snapshot_get_platforms(const Snapshot* snapshot);
+Platform* meh_snapshot_get_platform(const Snapshot* snapshot, int platform_id);
+GQueue* meh_snapshot_get_platform_executables(const Snapshot* snapshot, int platform_id);
+
+SnapshotWriter* meh_snapshot_writer_new(gint64 version);
+void meh_snapshot_writer_add_platform(SnapshotWriter* writer, const Platform* platform);
+gboolean meh_snapshot_writer_add_executable(SnapshotWriter* writer, int platform_id, int id,
+		const gchar* display_name, gboolean favorite, gint64 last_played);
+void meh_snapshot_writer_add_resource(SnapshotWriter* writer, int id, int type, const gchar* filepath);
+gboolean meh_snapshot_writer_save(SnapshotWriter* writer, const gchar* filename);
+void meh_snapshot_writer_destroy(SnapshotWriter* writer);
@@ -4,25 +4,187 @@
 
 #include "view/image.h"
 
+static SDL_Surface* meh_image_downscale(SDL_Surface* surface, int width, int height);
+
 /*
  * meh_image_load_file loads the given file as a texture.
  * The texture should be freed by the caller.
  */
 SDL_Texture* meh_image_load_file(SDL_Renderer* renderer, const char* filename) {
+	return meh_image_load_file_scaled(renderer, filename, 0, 0);
+}
+
+/*
+ * meh_image_load_file_scaled loads the given file as a texture
+ * downscaled to cover a widget of the given size in pixels.
+ * The texture should be freed by the caller.
+ */
+SDL_Texture* meh_image_load_file_scaled(SDL_Renderer* renderer, const char* filename, int width, int height) {
 	g_assert(renderer != NULL);
 
+	SDL_Surface* surface = meh_image_decode_file_scaled(filename, width, height);
+	if (surface == NULL) {
+		return NULL;
+	}
+
+	SDL_Texture* texture = meh_image_create_texture(renderer, surface, filename);
+	SDL_FreeSurface(surface);
+
+	return texture;
+}
+
+/*
+ * meh_image_decode_file decodes the given file in a surface in the pixel
+ * format of the textures, their creation is then only a copy. It doesn't
+ * use the renderer: it can be called from any thread.
+ * The surface should be freed by the caller.
+ */
+SDL_Surface* meh_image_decode_file(const char* filename) {
 	SDL_Surface* surface = IMG_Load(filename);
 	if (surface == NULL) {
 		g_critical("Can't load the image '%s' : %s", filename, IMG_GetError());
 		return NULL;
 	}
-	
-	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+
+	if (surface->format->format == SDL_PIXELFORMAT_ARGB8888) {
+		return surface;
+	}
+
+	SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+	SDL_FreeSurface(surface);
+
+	if (converted == NULL) {
+		g_critical("Can't convert the image '%s' : %s", filename, SDL_GetError());
+	}
+
+	return converted;
+}
+
+/*
+ * meh_image_decode_file_scaled decodes the given file like meh_image_decode_file
+ * then downscales it to the smallest size still covering `width` x `height`
+ * pixels: both sides are scaled by the same factor, the image keeps its
+ * aspect ratio. It's never upscaled, 0 keeps the size of the file.
+ */
+SDL_Surface* meh_image_decode_file_scaled(const char* filename, int width, int height) {
+	SDL_Surface* surface = meh_image_decode_file(filename);
+	if (surface == NULL || width <= 0 || height <= 0) {
+		return surface;
+	}
+
+	int scaled_width = 0, scaled_height = 0;
+	meh_image_fit_size(surface->w, surface->h, width, height, &scaled_width, &scaled_height);
+	if (scaled_width == surface->w && scaled_height == surface->h) {
+		return surface;
+	}
+
+	SDL_Surface* scaled = meh_image_downscale(surface, scaled_width, scaled_height);
+	if (scaled == NULL) {
+		g_warning("Can't downscale the image '%s', using its full size: %s", filename, SDL_GetError());
+		return surface;
+	}
+
 	SDL_FreeSurface(surface);
+	return scaled;
+}
 
+/*
+ * meh_image_fit_size computes the size of an image of `image_width` x
+ * `image_height` downscaled to cover `width` x `height`, keeping its ratio.
+ */
+void meh_image_fit_size(int image_width, int image_height, int width, int height, int* scaled_width, int* scaled_height) {
+	g_assert(scaled_width != NULL);
+	g_assert(scaled_height != NULL);
+
+	*scaled_width = image_width;
+	*scaled_height = image_height;
+
+	if (image_width <= 0 || image_height <= 0 || width <= 0 || height <= 0) {
+		return;
+	}
+
+	double scale = MAX((double)width / image_width, (double)height / image_height);
+	if (scale >= 1.0) {
+		return;
+	}
+
+	*scaled_width = MAX(1, (int)(image_width * scale + 0.5));
+	*scaled_height = MAX(1, (int)(image_height * scale + 0.5));
+}
+
+/*
+ * meh_image_downscale creates a smaller copy of the ARGB8888 surface: each pixel
+ * is the average of the pixels it covers, weighted by their alpha to not
+ * darken the edges of the transparent images.
+ */
+static SDL_Surface* meh_image_downscale(SDL_Surface* surface, int width, int height) {
+	g_assert(surface != NULL);
+	g_assert(surface->format->format == SDL_PIXELFORMAT_ARGB8888);
+	g_assert(width > 0 && width <= surface->w);
+	g_assert(height > 0 && height <= surface->h);
+
+	SDL_Surface* scaled = SDL_CreateRGBSurface(0, width, height, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+	if (scaled == NULL) {
+		return NULL;
+	}
+
+	if (SDL_LockSurface(surface) != 0) {
+		SDL_FreeSurface(scaled);
+		return NULL;
+	}
+
+	const Uint8* src_pixels = (const Uint8*)surface->pixels;
+	Uint8* dst_pixels = (Uint8*)scaled->pixels;
+
+	for (int y = 0; y < height; y++) {
+		int src_y0 = (int)((gint64)y * surface->h / height);
+		int src_y1 = MAX(src_y0 + 1, (int)((gint64)(y + 1) * surface->h / height));
+		Uint32* dst_row = (Uint32*)(dst_pixels + y * scaled->pitch);
+
+		for (int x = 0; x < width; x++) {
+			int src_x0 = (int)((gint64)x * surface->w / width);
+			int src_x1 = MAX(src_x0 + 1, (int)((gint64)(x + 1) * surface->w / width));
+
+			guint64 a = 0, r = 0, g = 0, b = 0;
+			for (int sy = src_y0; sy < src_y1; sy++) {
+				const Uint32* src_row = (const Uint32*)(src_pixels + sy * surface->pitch);
+				for (int sx = src_x0; sx < src_x1; sx++) {
+					Uint32 pixel = src_row[sx];
+					guint64 alpha = pixel >> 24;
+					a += alpha;
+					r += ((pixel >> 16) & 0xFF) * alpha;
+					g += ((pixel >> 8) & 0xFF) * alpha;
+					b += (pixel & 0xFF) * alpha;
+				}
+			}
+
+			guint64 count = (guint64)(src_x1 - src_x0) * (src_y1 - src_y0);
+			Uint32 pixel = (Uint32)((a + count / 2) / count) << 24;
+			if (a > 0) {
+				pixel |= (Uint32)((r + a / 2) / a) << 16 | (Uint32)((g + a / 2) / a) << 8 | (Uint32)((b + a / 2) / a);
+			}
+			dst_row[x] = pixel;
+		}
+	}
+
+	SDL_UnlockSurface(surface);
+
+	return scaled;
+}
+
+/*
+ * meh_image_create_texture creates a texture from the given decoded
+ * image, must be called from the main thread.
+ * The texture should be freed by the caller.
+ */
+SDL_Texture* meh_image_create_texture(SDL_Renderer* renderer, SDL_Surface* surface, const char* filename) {
+	g_assert(renderer != NULL);
+	g_assert(surface != NULL);
+
+	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
 	if (texture == NULL) {
 		g_critical("Unable to create a texture from the image '%s' : %s", filename, SDL_GetError());
 	}
-	
+
 	return texture;
 }
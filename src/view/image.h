@@ -3,3 +3,8 @@
 #include "SDL2/SDL.h"
 
 SDL_Texture* meh_image_load_file(SDL_Renderer* renderer, const char* filename);
+SDL_Texture* meh_image_load_file_scaled(SDL_Renderer* renderer, const char* filename, int width, int height);
+SDL_Surface* meh_image_decode_file(const char* filename);
+SDL_Surface* meh_image_decode_file_scaled(const char* filename, int width, int height);
+void meh_image_fit_size(int image_width, int image_height, int width, int height, int* scaled_width, int* scaled_height);
+SDL_Texture* meh_image_create_texture(SDL_Renderer* renderer, SDL_Surface* surface, const char* filename);
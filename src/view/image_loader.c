@@ -0,0 +1,287 @@
+/*
+ * mehstation - Decoding of the images in background.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ *
+ * The image files are decoded by a pool of threads, the main thread never
+ * waits for them: a screen pushes a request and receives later its texture
+ * as a MEH_MSG_IMAGE_RESULT message. Only the creation of the texture
+ * from the decoded image is done in the main thread.
+ * The images are downscaled by the threads to the size they are displayed
+ * at: the textures of the full size artworks would fill the GPU memory.
+ * The images to display are decoded before the prefetched ones, then the
+ * most recent requests first: they are the ones of what the user is looking
+ * at. A request not needed anymore can be cancelled, it's not decoded if it
+ * has not started yet.
+ */
+
+#include <stdio.h>
+#include <glib.h>
+
+#include "system/app.h"
+#include "system/consts.h"
+#include "system/message.h"
+#include "view/image.h"
+#include "view/image_loader.h"
+#include "view/screen.h"
+#include "view/thumbnail_cache.h"
+
+static void meh_image_loader_decode(gpointer data, gpointer user_data);
+static void meh_image_loader_warm_file(const gchar* filename);
+static ImageRequest* meh_image_loader_push(ImageLoader* loader, Screen* screen, const gchar* filename, int tag, int priority,
+		int width, int height, gboolean warm_only);
+static gint meh_image_loader_compare(gconstpointer a, gconstpointer b, gpointer user_data);
+static void meh_image_request_destroy(ImageRequest* request);
+
+/*
+ * meh_image_loader_new starts a pool of `threads` threads decoding the images,
+ * one less than the amount of processors (at least 1) if `threads` is 0.
+ * The downscaled images are cached in `thumbnails_directory`, if not empty.
+ */
+ImageLoader* meh_image_loader_new(int threads, const gchar* thumbnails_directory) {
+	if (threads <= 0) {
+		threads = g_get_num_processors() - 1;
+	}
+	threads = CLAMP(threads, 1, MEH_IMAGE_LOADER_MAX_THREADS);
+
+	ImageLoader* loader = g_new(ImageLoader, 1);
+
+	loader->results = g_async_queue_new();
+	loader->requests = g_hash_table_new(NULL, NULL);
+	loader->last_request_id = 0;
+	loader->thumbnails = meh_thumbnail_cache_new(thumbnails_directory);
+	loader->pool = g_thread_pool_new(meh_image_loader_decode, loader, threads, FALSE, NULL);
+	g_thread_pool_set_sort_function(loader->pool, meh_image_loader_compare, NULL);
+
+	g_message("Images decoded by %d threads.", threads);
+
+	return loader;
+}
+
+/*
+ * meh_image_loader_destroy stops the decoding threads, the requests
+ * not decoded nor dispatched yet are lost.
+ */
+void meh_image_loader_destroy(ImageLoader* loader) {
+	if (loader == NULL) {
+		return;
+	}
+
+	/* the requests still queued are dropped, the running ones are waited. */
+	g_thread_pool_free(loader->pool, TRUE, TRUE);
+
+	/* every request not dispatched is in the table, decoded or not. */
+	GHashTableIter iter;
+	gpointer value;
+	g_hash_table_iter_init(&iter, loader->requests);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		meh_image_request_destroy(value);
+	}
+	g_hash_table_destroy(loader->requests);
+
+	g_async_queue_unref(loader->results);
+	meh_thumbnail_cache_destroy(loader->thumbnails);
+
+	g_free(loader);
+}
+
+/*
+ * meh_image_loader_decode decodes the image of a request, in a thread of the pool.
+ */
+static void meh_image_loader_decode(gpointer data, gpointer user_data) {
+	ImageRequest* request = (ImageRequest*)data;
+	ImageLoader* loader = (ImageLoader*)user_data;
+	g_assert(request != NULL);
+	g_assert(loader != NULL);
+
+	if (request->warm_only) {
+		meh_image_loader_warm_file(request->filename);
+	} else if (!g_atomic_int_get(&request->cancelled)) {
+		request->surface = meh_thumbnail_cache_decode(loader->thumbnails, request->filename, request->width, request->height);
+	}
+
+	g_async_queue_push(loader->results, request);
+}
+
+/*
+ * meh_image_loader_warm_file reads the start of the file for the
+ * next opening of the file to not wait for the disk.
+ */
+static void meh_image_loader_warm_file(const gchar* filename) {
+	FILE* file = fopen(filename, "rb");
+	if (file == NULL) {
+		g_debug("Can't warm the file '%s'", filename);
+		return;
+	}
+
+	gchar* buffer = g_malloc(MEH_IMAGE_LOADER_WARM_BYTES);
+	if (fread(buffer, 1, MEH_IMAGE_LOADER_WARM_BYTES, file) == 0) {
+		g_debug("Nothing read to warm the file '%s'", filename);
+	}
+	g_free(buffer);
+
+	fclose(file);
+}
+
+/*
+ * meh_image_loader_compare orders the queued requests: by priority
+ * then the most recent first.
+ */
+static gint meh_image_loader_compare(gconstpointer a, gconstpointer b, gpointer user_data) {
+	const ImageRequest* first = (const ImageRequest*)a;
+	const ImageRequest* second = (const ImageRequest*)b;
+
+	if (first->priority != second->priority) {
+		return first->priority > second->priority ? -1 : 1;
+	}
+	if (first->id == second->id) {
+		return 0;
+	}
+	return first->id > second->id ? -1 : 1;
+}
+
+/*
+ * meh_image_loader_load requests the decoding of the given file for the given
+ * screen, the texture will be sent to the screen in a MEH_MSG_IMAGE_RESULT,
+ * NULL if the image can't be loaded. `tag` is free to use by the screen.
+ * The image is downscaled in the thread to cover `width` x `height` pixels,
+ * e.g. the size of its widget on the window, 0 to keep the size of the file.
+ * Returns the request id.
+ */
+guint meh_image_loader_load(ImageLoader* loader, Screen* screen, const gchar* filename, int tag, int priority, int width, int height) {
+	g_assert(loader != NULL);
+	g_assert(screen != NULL);
+	g_assert(filename != NULL);
+
+	return meh_image_loader_push(loader, screen, filename, tag, priority, width, height, FALSE)->id;
+}
+
+/*
+ * meh_image_loader_promote gives the display priority to a prefetch
+ * request not dispatched yet. The queue can't be sorted again: the request
+ * is replaced by a new one. Returns the id of the request to wait for.
+ */
+guint meh_image_loader_promote(ImageLoader* loader, guint id) {
+	g_assert(loader != NULL);
+
+	ImageRequest* request = g_hash_table_lookup(loader->requests, GUINT_TO_POINTER(id));
+	if (request == NULL || request->priority >= MEH_IMAGE_PRIORITY_DISPLAY) {
+		return id;
+	}
+
+	g_atomic_int_set(&request->cancelled, TRUE);
+	return meh_image_loader_push(loader, request->screen, request->filename, request->tag, MEH_IMAGE_PRIORITY_DISPLAY,
+			request->width, request->height, FALSE)->id;
+}
+
+/*
+ * meh_image_loader_warm reads in background the start of the given file, for
+ * example a video which will be opened soon. Nothing is sent back.
+ */
+void meh_image_loader_warm(ImageLoader* loader, const gchar* filename) {
+	g_assert(loader != NULL);
+	g_assert(filename != NULL);
+
+	meh_image_loader_push(loader, NULL, filename, 0, MEH_IMAGE_PRIORITY_PREFETCH, 0, 0, TRUE);
+}
+
+/*
+ * meh_image_loader_push queues a new request, it's filled before
+ * being given to the threads.
+ */
+static ImageRequest* meh_image_loader_push(ImageLoader* loader, Screen* screen, const gchar* filename, int tag, int priority,
+		int width, int height, gboolean warm_only) {
+	ImageRequest* request = g_new0(ImageRequest, 1);
+	request->id = ++loader->last_request_id;
+	request->screen = screen;
+	request->tag = tag;
+	request->priority = priority;
+	request->warm_only = warm_only;
+	request->filename = g_strdup(filename);
+	request->width = MAX(width, 0);
+	request->height = MAX(height, 0);
+	request->cancelled = FALSE;
+	request->surface = NULL;
+	request->texture = NULL;
+
+	g_hash_table_insert(loader->requests, GUINT_TO_POINTER(request->id), request);
+	g_thread_pool_push(loader->pool, request, NULL);
+
+	return request;
+}
+
+/*
+ * meh_image_loader_cancel cancels the given request: its result won't be
+ * sent, it's not decoded if it has not started yet. Does nothing if the
+ * result has already been dispatched.
+ */
+void meh_image_loader_cancel(ImageLoader* loader, guint id) {
+	g_assert(loader != NULL);
+
+	ImageRequest* request = g_hash_table_lookup(loader->requests, GUINT_TO_POINTER(id));
+	if (request != NULL) {
+		g_atomic_int_set(&request->cancelled, TRUE);
+	}
+}
+
+/*
+ * meh_image_loader_cancel_screen cancels every request of the given screen,
+ * called when the screen is destroyed.
+ */
+void meh_image_loader_cancel_screen(ImageLoader* loader, Screen* screen) {
+	g_assert(loader != NULL);
+	g_assert(screen != NULL);
+
+	GHashTableIter iter;
+	gpointer value;
+	g_hash_table_iter_init(&iter, loader->requests);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		ImageRequest* request = (ImageRequest*)value;
+		if (request->screen == screen) {
+			g_atomic_int_set(&request->cancelled, TRUE);
+		}
+	}
+}
+
+/*
+ * meh_image_loader_dispatch_results creates the textures of the decoded images
+ * and sends them to their screens, must be called from the main loop. The
+ * textures not taken by their screen and the requests are freed once dispatched.
+ */
+void meh_image_loader_dispatch_results(ImageLoader* loader, App* app) {
+	g_assert(loader != NULL);
+	g_assert(app != NULL);
+
+	ImageRequest* request = NULL;
+	while ((request = g_async_queue_try_pop(loader->results)) != NULL) {
+		g_hash_table_remove(loader->requests, GUINT_TO_POINTER(request->id));
+
+		if (!request->cancelled && !request->warm_only) {
+			if (request->surface != NULL) {
+				request->texture = meh_image_create_texture(app->window->sdl_renderer, request->surface, request->filename);
+			}
+
+			Message* message = meh_message_new(MEH_MSG_IMAGE_RESULT, request);
+			meh_message_forward(app, request->screen, message);
+
+			/* the request isn't a simple allocation. */
+			message->data = NULL;
+			meh_message_destroy(message);
+		}
+
+		meh_image_request_destroy(request);
+	}
+}
+
+static void meh_image_request_destroy(ImageRequest* request) {
+	g_assert(request != NULL);
+
+	if (request->surface != NULL) {
+		SDL_FreeSurface(request->surface);
+	}
+	if (request->texture != NULL) {
+		SDL_DestroyTexture(request->texture);
+	}
+	g_free(request->filename);
+	g_free(request);
+}
@@ -0,0 +1,63 @@
+/*
+ * mehstation - Decoding of the images in background.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+
+#define MEH_IMAGE_LOADER_MAX_THREADS (8)
+#define MEH_IMAGE_LOADER_WARM_BYTES (256*1024) /* read of a file to have its header in the page cache */
+
+#define MEH_IMAGE_PRIORITY_PREFETCH 0 /* might be displayed soon */
+#define MEH_IMAGE_PRIORITY_DISPLAY 1 /* displayed as soon as decoded */
+
+struct App;
+struct Screen;
+struct ThumbnailCache;
+
+/*
+ * A request to decode an image file, filled with its texture by the main
+ * thread then sent to the requesting screen as the data of a MEH_MSG_IMAGE_RESULT.
+ */
+typedef struct ImageRequest {
+	guint id;
+	struct Screen* screen; /* screen receiving the result */
+	int tag; /* given by the screen to recognize the result, e.g. a resource id */
+	int priority; /* MEH_IMAGE_PRIORITY_*, the highest decoded first */
+	gboolean warm_only; /* only reads the start of the file, nothing is sent */
+	gchar* filename;
+	int width; /* size in pixels the image is downscaled to cover, 0 to keep the size of the file */
+	int height;
+
+	/* set by the main thread, read by the decoding threads. */
+	gint cancelled;
+
+	/* results */
+	SDL_Surface* surface; /* decoded by a thread, NULL on error */
+	SDL_Texture* texture; /* created by the main thread, set to NULL by the screen taking its ownership */
+} ImageRequest;
+
+typedef struct ImageLoader {
+	GThreadPool* pool;
+	/* ImageRequest* decoded, to dispatch. */
+	GAsyncQueue* results;
+	/* every ImageRequest* not dispatched yet, by id, only used in the main thread. */
+	GHashTable* requests;
+	/* last id given to a request, only used in the main thread. */
+	guint last_request_id;
+	/* downscaled images on disk, used by the threads, NULL if disabled. */
+	struct ThumbnailCache* thumbnails;
+} ImageLoader;
+
+ImageLoader* meh_image_loader_new(int threads, const gchar* thumbnails_directory);
+void meh_image_loader_destroy(ImageLoader* loader);
+guint meh_image_loader_load(ImageLoader* loader, struct Screen* screen, const gchar* filename, int tag, int priority, int width, int height);
+guint meh_image_loader_promote(ImageLoader* loader, guint id);
+void meh_image_loader_warm(ImageLoader* loader, const gchar* filename);
+void meh_image_loader_cancel(ImageLoader* loader, guint id);
+void meh_image_loader_cancel_screen(ImageLoader* loader, struct Screen* screen);
+void meh_image_loader_dispatch_results(ImageLoader* loader, struct App* app);
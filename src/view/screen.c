@@ -2,6 +2,7 @@
 #include <glib.h>
 
 #include "system/transition.h"
+#include "view/image_loader.h"
 #include "view/widget_text.h"
 #include "view/screen.h"
 #include "view/window.h"
@@ -22,6 +23,11 @@ Screen* meh_screen_new(Window* window) {
 void meh_screen_destroy(Screen* screen) {
 	g_assert(screen != NULL);
 
+	/* the images still decoding are for nobody now. */
+	if (screen->window != NULL && screen->window->image_loader != NULL) {
+		meh_image_loader_cancel_screen(screen->window->image_loader, screen);
+	}
+
 	if (screen->data != NULL) {
 		if (screen->destroy_data != NULL) {
 			screen->destroy_data(screen);
@@ -86,13 +86,10 @@ static gchar* find_video_filename(Executable* executable) {
 		return "";
 	}
 
-	for (unsigned int i = 0; i < g_queue_get_length(executable->resources); i++) {
-		ExecutableResource* res = g_queue_peek_nth(executable->resources, i);
-		if (res != NULL) {
-			if (g_strcmp0(res->type, "video") == 0) {
-				return res->filepath;
-			}
-		}
+	int count = 0;
+	ExecutableResource* videos = meh_model_executable_get_resources(executable, MEH_EXEC_RES_VIDEO, MEH_EXEC_RES_VIDEO, &count);
+	if (count > 0) {
+		return videos[0].filepath;
 	}
 
 	return "";
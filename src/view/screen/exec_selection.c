@@ -18,7 +18,7 @@ void meh_exec_selection_prepare(App* app, Screen* screen, ExecutableListData* da
 	for (int i = 0; i < MEH_EXEC_LIST_SIZE; i++) {
 		WidgetText* text = meh_widget_text_new(app->small_font, "", 55, 130+(i*32), 350, 30, white, FALSE);
 		text->uppercase = TRUE; /* executables name in uppercase */
-		g_queue_push_tail(data->executable_widgets, text);
+		g_ptr_array_add(data->executable_widgets, text);
 	}
 }
 
@@ -30,10 +30,10 @@ void meh_exec_selection_destroy(Screen* screen, ExecutableListData* data) {
 	meh_widget_rect_destroy(data->selection_widget);
 
 	/* Executables */
-	for (unsigned int i = 0; i < g_queue_get_length(data->executable_widgets); i++) {
-		meh_widget_text_destroy( g_queue_peek_nth( data->executable_widgets, i) );
+	for (unsigned int i = 0; i < data->executable_widgets->len; i++) {
+		meh_widget_text_destroy( g_ptr_array_index( data->executable_widgets, i) );
 	}
-	g_queue_free(data->executable_widgets);
+	g_ptr_array_free(data->executable_widgets, TRUE);
 }
 
 void meh_exec_selection_render(App* app, Screen* screen, ExecutableListData* data) {
@@ -41,7 +41,7 @@ void meh_exec_selection_render(App* app, Screen* screen, ExecutableListData* dat
 	meh_widget_rect_render(app->window, data->selection_widget);
 
 	/* render all the executables names. */
-	for (unsigned int i = 0; i < g_queue_get_length(data->executable_widgets); i++) {
-		meh_widget_text_render(app->window, g_queue_peek_nth(data->executable_widgets, i));
+	for (unsigned int i = 0; i < data->executable_widgets->len; i++) {
+		meh_widget_text_render(app->window, g_ptr_array_index(data->executable_widgets, i));
 	}
 }
@@ -11,11 +11,14 @@
 #include "system/app.h"
 #include "system/consts.h"
 #include "system/db.h"
+#include "system/db_worker.h"
 #include "system/input.h"
 #include "system/message.h"
 #include "system/transition.h"
 #include "system/db/models.h"
 #include "view/image.h"
+#include "view/image_loader.h"
+#include "view/texture_cache.h"
 #include "view/widget_text.h"
 #include "view/screen.h"
 #include "view/screen/fade.h"
@@ -23,14 +26,32 @@
 #include "view/screen/exec_selection.h"
 #include "view/screen/launch.h"
 #include "view/screen/popup.h"
+#include "view/screen/search.h"
 
 static void meh_exec_create_widgets(App* app, Screen* screen, ExecutableListData* data);
 static void meh_exec_list_destroy_resources(Screen* screen);
 static void meh_exec_list_load_resources(App* app, Screen* screen);
 static void meh_exec_list_start_executable(App* app, Screen* screen);
 static void meh_exec_list_select_resources(Screen* screen);
+static void meh_exec_list_pick_resources(ExecutableListData* data, Executable* executable,
+		int* background, int* cover, int* logo, int* screenshots);
+static GArray* meh_exec_list_prefetch_indexes(App* app, ExecutableListData* data);
+static void meh_exec_list_free_texture(ExecutableListData* data, int rid);
+static void meh_exec_list_release_textures(ExecutableListData* data, GHashTable* wanted);
 static void meh_exec_list_start_bg_anim(Screen* screen);
 static void meh_exec_list_resolve_tex(Screen* screen);
+static void meh_exec_list_image_result(App* app, Screen* screen, ImageRequest* request);
+static void meh_exec_list_place_cover(ExecutableListData* data);
+static void meh_exec_list_free_executable_textures(ExecutableListData* data, Executable* executable);
+static void meh_exec_list_window_move(App* app, Screen* screen);
+static void meh_exec_list_destroy_executable(ExecutableListData* data, Executable* executable);
+static gboolean meh_exec_list_hydrate(App* app, ExecutableListData* data, int idx);
+static void meh_exec_list_window_reset(ExecutableListData* data, GQueue* executables, int start);
+static void meh_exec_list_db_result(App* app, Screen* screen, DBRequest* request);
+static void meh_exec_list_apply_changes(App* app, Screen* screen);
+static gboolean meh_exec_list_is_applied_change(gpointer key, gpointer value, gpointer data);
+static void meh_exec_list_apply_executables(App* app, Screen* screen, GHashTable* changed);
+static int meh_exec_list_find_position(ExecutableListData* data, const Executable* executable);
 
 Screen* meh_exec_list_new(App* app, int platform_id) {
 	g_assert(app != NULL);
@@ -51,20 +72,32 @@ Screen* meh_exec_list_new(App* app, int platform_id) {
 	data->platform = meh_db_get_platform(app->db, platform_id);
 	g_assert(data->platform != NULL);
 
-	/* get the executables */
-	data->executables = meh_db_get_platform_executables(app->db, data->platform, TRUE);
-	data->executables_length = g_queue_get_length(data->executables);
-	data->cache_executables_id = g_queue_new();
+	/* the executables are loaded by the DB worker, the list
+	 * is filled when receiving the result (see meh_exec_list_db_result). */
+	data->executables = g_ptr_array_new();
+	data->executables_length = 0;
+	data->paging = FALSE;
+	data->window_start = 0;
+	data->load_request = meh_db_worker_load_executable_list(app->db_worker, platform_id, app->settings.catalog_paging_threshold);
+	data->reselect_executable = -1;
+	data->catalog_change_id = app->catalog_change_id;
+	data->applied_changes = g_hash_table_new_full(NULL, NULL, NULL, g_free);
+	data->hydrated_executables = g_queue_new();
 	data->selected_executable = 0;
 
 	/* display resources */
-	data->textures = NULL;
+	data->textures = g_hash_table_new_full(g_int_hash, g_int_equal, g_free, NULL);
+	data->texture_cache = app->window->texture_cache;
+	data->image_requests = g_hash_table_new_full(g_int_hash, g_int_equal, g_free, NULL);
+	data->resources_seed = g_random_int();
+	data->scroll_direction = 0;
+	data->warmed_videos = g_hash_table_new(NULL, NULL);
 	data->background = -1;
 	data->cover = -1;
 	data->logo = -1;
 	data->screenshots[0] = data->screenshots[1] = data->screenshots[2] = -1;
 
-	data->executable_widgets = g_queue_new();
+	data->executable_widgets = g_ptr_array_new();
 
 	data->exec_list_video = NULL;
 
@@ -207,7 +240,11 @@ void meh_exec_list_destroy_data(Screen* screen) {
 	ExecutableListData* data = meh_exec_list_get_data(screen);
 	if (data != NULL) {
 		meh_model_platform_destroy(data->platform);
-		meh_model_executables_destroy(data->executables);
+		g_queue_free(data->hydrated_executables);
+		for (unsigned int i = 0; i < data->executables->len; i++) {
+			meh_model_executable_destroy(g_ptr_array_index(data->executables, i));
+		}
+		g_ptr_array_free(data->executables, TRUE);
 
 		/* Destroy the widgets */
 		meh_exec_selection_destroy(screen, data);
@@ -236,18 +273,16 @@ void meh_exec_list_destroy_data(Screen* screen) {
 
 		meh_widget_text_destroy(data->description_widget);
 
-		/* Free the executables id cache. */
-		for (unsigned int i = 0; i < g_queue_get_length(data->cache_executables_id); i++) {
-			g_free(g_queue_peek_nth(data->cache_executables_id, i));
-		}
-		g_queue_free(data->cache_executables_id);
-
 		/* destroy the video overlay */
 		meh_exec_list_video_destroy(data->exec_list_video);
 		data->exec_list_video = NULL;
 
-		/* we must free the textures cache */
+		/* we must free the textures cache, the images still
+		 * decoding have been cancelled with the screen. */
 		meh_exec_list_destroy_resources(screen);
+		g_hash_table_destroy(data->image_requests);
+		g_hash_table_destroy(data->warmed_videos);
+		g_hash_table_destroy(data->applied_changes);
 	}
 }
 
@@ -269,8 +304,8 @@ static void meh_exec_list_destroy_resources(Screen* screen) {
 		int* key = g_list_nth_data(keys, i);
 		SDL_Texture* texture = g_hash_table_lookup(data->textures, key);
 		if (texture != NULL) {
-			g_debug("Freeing the texture id %d", *key);
-			SDL_DestroyTexture(texture);
+			g_debug("Releasing the texture id %d", *key);
+			meh_texture_cache_release(data->texture_cache, texture);
 		}
 	}
 
@@ -279,106 +314,77 @@ static void meh_exec_list_destroy_resources(Screen* screen) {
 }
 
 /*
- * meh_exec_list_is_in_delta checks whether the given index is in the delta
- * of the current selection.
- *
- * Ex:
- *
- * 1            With a delta of 3, the values 9, 1, 2, 4, 5, 6 are included
- * 2            in the delta.
- * 3 <--
- * 4            This method has been created for cache cleaning.
- * 5
- * 6
- * 7
- * 8
- * 9
+ * meh_exec_list_release_textures gives back to the texture cache the
+ * textures of the executables neither displayed nor prefetched, it keeps
+ * them while its budget allows it. The previous background stays until
+ * the new one is received.
  */
-static gboolean meh_exec_list_is_in_delta(ExecutableListData* data, int idx) {
-	int top_limit = idx - MEH_EXEC_LIST_DELTA;
-	int bottom_limit = idx + MEH_EXEC_LIST_DELTA;
-
-	/* Special case, if we outbound on low and high, we are included. */
-	if (bottom_limit > data->executables_length && top_limit < 0) {
-		return TRUE;
-	}
+static void meh_exec_list_release_textures(ExecutableListData* data, GHashTable* wanted) {
+	g_assert(data != NULL);
+	g_assert(wanted != NULL);
 
-	int cursor = data->selected_executable;
-	int j = 0;
-	for (j = 0; j < MEH_EXEC_LIST_DELTA+1; j++) {
-		if (cursor > data->executables_length) {
-			cursor = 0;
-		}
-		if (idx == cursor) {
-			return TRUE;
+	GList* keys = g_hash_table_get_keys(data->textures);
+	for (GList* it = keys; it != NULL; it = it->next) {
+		int rid = *(int*)it->data;
+		if (!g_hash_table_contains(wanted, &rid) &&
+				g_hash_table_lookup(data->textures, &rid) != data->background_widget->texture) {
+			meh_exec_list_free_texture(data, rid);
 		}
-		cursor++;
 	}
+	g_list_free(keys);
+}
 
-	cursor = data->selected_executable;
-	j = 0;
-	for (j = 0; j < MEH_EXEC_LIST_DELTA+1; j++) {
-		if (cursor < 0) {
-			cursor = data->executables_length-1;
-		}
-		if (idx == cursor) {
-			return TRUE;
-		}
-		cursor--;
+/*
+ * meh_exec_list_free_executable_textures frees the textures loaded for the
+ * resources of the given executable. The widgets still using one of
+ * these textures are reset.
+ */
+static void meh_exec_list_free_executable_textures(ExecutableListData* data, Executable* executable) {
+	g_assert(data != NULL);
+	g_assert(executable != NULL);
+
+	if (data->textures == NULL || executable->resources == NULL) {
+		return;
 	}
 
-	return FALSE;
+	for (int i = 0; i < executable->resources_count; i++) {
+		meh_exec_list_free_texture(data, executable->resources[i].id);
+	}
 }
 
 /*
- * meh_exec_list_delete_some_cache looks for which cache we could
- * free without impacting the user experience.
+ * meh_exec_list_free_texture frees the texture of the given resource
+ * if it's loaded. The widgets still using it are reset.
  */
-static void meh_exec_list_delete_some_cache(Screen* screen) {
-	g_assert(screen != NULL);	
-
-	ExecutableListData* data = meh_exec_list_get_data(screen);
+static void meh_exec_list_free_texture(ExecutableListData* data, int rid) {
+	g_assert(data != NULL);
 
-	/* Get the current executable */
-	Executable* current_executable = g_queue_peek_nth(data->executables, data->selected_executable);
-	if (current_executable == NULL || current_executable->resources == NULL) {
+	SDL_Texture* texture = g_hash_table_lookup(data->textures, &rid);
+	if (texture == NULL) { /* can be null because we don't load all the resources */
 		return;
 	}
 
-	int watchdog = 20; /* Avoid an infinite loop. */
-	while (g_queue_get_length(data->cache_executables_id) > MEH_EXEC_LIST_MAX_CACHE && watchdog > 0) {
-		int* idx = g_queue_pop_head(data->cache_executables_id);
-		if (*idx != current_executable->id &&
-			!meh_exec_list_is_in_delta(data, *idx)) { /* do not free the resources of the current selection */
-			/* executable for which we want to free the resources */
-			Executable* exec_to_clear_for = g_queue_peek_nth(data->executables, *idx);
-			if (exec_to_clear_for != NULL && exec_to_clear_for->resources != NULL) {
-				g_debug("Cache cleaning of the resources of %s", exec_to_clear_for->display_name);
-				/* free the resources of this executable */
-				for (unsigned int i = 0; i < g_queue_get_length(exec_to_clear_for->resources); i++) {
-					ExecutableResource* resource = g_queue_peek_nth(exec_to_clear_for->resources, i);
-					if (resource == NULL) {
-						continue;
-					}
-
-					/* free the associated texture */
-					SDL_Texture* texture = g_hash_table_lookup(data->textures, &(resource->id));
-					if (texture != NULL) { /* can be null because we don't load all the resources */
-						SDL_DestroyTexture(texture);
-						g_hash_table_remove(data->textures, &(resource->id));
-						g_debug("Cache clean of %s ID %d", resource->type, resource->id);
-					}
-				}
-			}
-			/* finally free the data of the entry in the cache */
-			g_free(idx);
-		} else {
-			/* we can't delete it, it's the current selection
-			 * re-add it into the cache list. */
-			g_queue_push_tail(data->cache_executables_id, idx);
+	if (data->background_widget->texture == texture) {
+		data->background_widget->texture = NULL;
+	}
+	if (data->background == rid) {
+		data->background = -1;
+	}
+	if (data->cover_widget->texture == texture) {
+		data->cover_widget->texture = NULL;
+	}
+	if (data->logo_widget->texture == texture) {
+		data->logo_widget->texture = NULL;
+	}
+	for (int j = 0; j < 3; j++) {
+		if (data->screenshots_widget[j]->texture == texture) {
+			data->screenshots_widget[j]->texture = NULL;
 		}
-		watchdog--;
 	}
+
+	meh_texture_cache_release(data->texture_cache, texture);
+	g_hash_table_remove(data->textures, &rid);
+	g_debug("Released the texture of the resource ID %d", rid);
 }
 
 /*
@@ -390,7 +396,7 @@ static void meh_exec_list_select_resources(Screen* screen) {
 
 	ExecutableListData* data = meh_exec_list_get_data(screen);
 
-	Executable* executable = g_queue_peek_nth(data->executables, data->selected_executable);
+	Executable* executable = meh_exec_list_get_executable(data, data->selected_executable);
 	if (executable == NULL || executable->resources == NULL) {
 		return;
 	}
@@ -405,82 +411,76 @@ static void meh_exec_list_select_resources(Screen* screen) {
 	data->cover_widget->texture = data->logo_widget->texture = NULL;
 	data->screenshots_widget[0]->texture = data->screenshots_widget[1]->texture = data->screenshots_widget[2]->texture = NULL;
 
-	/*
-	 * Select a random resource if any and tries to not take a cover nor a logo if possible.
-	 */
-	int length = g_queue_get_length(executable->resources);
-	if (length == 0) {
-		return;
+	int background = -1;
+	meh_exec_list_pick_resources(data, executable, &background, &data->cover, &data->logo, data->screenshots);
+
+	/* without any, the previous background stays. */
+	if (background > -1) {
+		data->background = background;
 	}
 
-	int watchdog = 5; /* don't do too many tries. */
-	ExecutableResource* resource = NULL;
-	while (watchdog > 0) {
-		int rand = g_random_int_range(0, length);
+	g_debug("Selected background: %d, cover: %d, logo: %d", data->background, data->cover, data->logo);
+}
 
-		resource = g_queue_peek_nth(executable->resources, rand);
-		if (resource == NULL) {
-			return;
-		}
+/*
+ * meh_exec_list_pick_resources picks the resources to display for the given
+ * executable, -1 for the missing ones. The random ones are picked with the
+ * same seed for an executable: the prefetched resources are the displayed ones.
+ */
+static void meh_exec_list_pick_resources(ExecutableListData* data, Executable* executable,
+		int* background, int* cover, int* logo, int* screenshots) {
+	g_assert(data != NULL);
+	g_assert(executable != NULL);
 
-		if (g_strcmp0(resource->type, "video") != 0 &&
-				g_strcmp0(resource->type, "cover") != 0 && g_strcmp0(resource->type, "logo") != 0) {
-			/* We found something that's not a cover, nor a video and nor a logo, perfect. */
-			break;
-		} else {
-			if (g_queue_get_length(executable->resources) == 1) {
-				/* We only found a cover or a logo, but we have only one resource, so we can also stop here. */
-				break;
-			}
-		}
+	*background = *cover = *logo = -1;
+	screenshots[0] = screenshots[1] = screenshots[2] = -1;
+
+	GRand* rand = g_rand_new_with_seed(data->resources_seed ^ (guint32)executable->id);
 
-		watchdog--;
+	/*
+	 * Select a random background, not a cover nor a logo if possible.
+	 * The resources are grouped by type: no need to look for them.
+	 */
+	int count = 0;
+	ExecutableResource* resources = meh_model_executable_get_resources(executable, MEH_EXEC_RES_OTHER, MEH_EXEC_RES_SCREENSHOT, &count);
+	if (count == 0) {
+		resources = meh_model_executable_get_resources(executable, MEH_EXEC_RES_COVER, MEH_EXEC_RES_LOGO, &count);
 	}
 
-	if (resource != NULL) {
-		data->background = resource->id;
-		g_debug("Selected background : %d.", resource->id);
+	if (count > 0) {
+		*background = resources[g_rand_int_range(rand, 0, count)].id;
 	}
 
 	/*
-	 * Select a cover and logo.
-	 * Also, creates a list of indexes of screenshots/fanarts.
+	 * Select a cover and logo: the last ones of their type.
 	 */
 
-	GQueue* shots_and_fanarts = g_queue_new();
-
-	for (unsigned int i = 0; i < g_queue_get_length(executable->resources); i++) {
-		ExecutableResource* res = g_queue_peek_nth(executable->resources, i);
-		if (res != NULL) {
-			if (g_strcmp0(res->type, "cover") == 0) {
-				data->cover = res->id;
-				g_debug("Selected cover: %d", res->id);
-			} else if (g_strcmp0(res->type, "logo") == 0) {
-				data->logo = res->id;
-				g_debug("Selected logo: %d", res->id);
-			} else if (g_strcmp0(res->type, "screenshot") == 0 ||
-					   g_strcmp0(res->type, "fanart") == 0) {
-				int *value = g_new(int, 1);
-				*value = res->id;
-				g_queue_push_tail(shots_and_fanarts, value);
-			}
-		}
+	resources = meh_model_executable_get_resources(executable, MEH_EXEC_RES_COVER, MEH_EXEC_RES_COVER, &count);
+	if (count > 0) {
+		*cover = resources[count-1].id;
 	}
 
-	/* selects some screenshots or fanarts */
-	for (unsigned int i = 0; i < 3 && g_queue_get_length(shots_and_fanarts) > 0; i++) { /* 3 max or no more values in the queue */
-		int idx = g_random_int_range(0, g_queue_get_length(shots_and_fanarts));
-
-		int *value = g_queue_pop_nth(shots_and_fanarts, idx);
-		data->screenshots[i] = *value;
-		g_free(value);
+	resources = meh_model_executable_get_resources(executable, MEH_EXEC_RES_LOGO, MEH_EXEC_RES_LOGO, &count);
+	if (count > 0) {
+		*logo = resources[count-1].id;
 	}
 
-	/* empty the left values */
-	for (unsigned int i = 0; i < g_queue_get_length(shots_and_fanarts); i++) {
-		g_free(g_queue_peek_nth(shots_and_fanarts, i));
+	/* selects some different screenshots or fanarts */
+	resources = meh_model_executable_get_resources(executable, MEH_EXEC_RES_FANART, MEH_EXEC_RES_SCREENSHOT, &count);
+	for (int i = 0; i < 3 && i < count; i++) { /* 3 max or no more values */
+		int id = -1;
+		gboolean selected = TRUE;
+		while (selected) {
+			id = resources[g_rand_int_range(rand, 0, count)].id;
+			selected = FALSE;
+			for (int j = 0; j < i; j++) {
+				selected = selected || screenshots[j] == id;
+			}
+		}
+		screenshots[i] = id;
 	}
-	g_queue_free(shots_and_fanarts);
+
+	g_rand_free(rand);
 }
 
 /*
@@ -492,6 +492,229 @@ ExecutableListData* meh_exec_list_get_data(Screen* screen) {
 	return data;
 }
 
+/*
+ * meh_exec_list_get_executable returns the executable at the given index of
+ * the list. Returns NULL if the index is out of the list or, in paging
+ * mode, if this executable isn't loaded.
+ */
+Executable* meh_exec_list_get_executable(ExecutableListData* data, int idx) {
+	g_assert(data != NULL);
+
+	int window_idx = idx - data->window_start;
+	if (idx < 0 || window_idx < 0 || window_idx >= (int)data->executables->len) {
+		return NULL;
+	}
+
+	return g_ptr_array_index(data->executables, window_idx);
+}
+
+/*
+ * meh_exec_list_destroy_executable destroys an executable removed from
+ * the loaded ones, with its textures.
+ */
+static void meh_exec_list_destroy_executable(ExecutableListData* data, Executable* executable) {
+	g_assert(data != NULL);
+	g_assert(executable != NULL);
+
+	meh_exec_list_free_executable_textures(data, executable);
+	g_queue_remove(data->hydrated_executables, executable);
+	meh_model_executable_destroy(executable);
+}
+
+/*
+ * meh_exec_list_hydrate loads the details of the executable at the given
+ * index of the list. Only the MEH_EXEC_LIST_MAX_HYDRATED most recently
+ * used executables keep their details.
+ */
+static gboolean meh_exec_list_hydrate(App* app, ExecutableListData* data, int idx) {
+	g_assert(app != NULL);
+	g_assert(data != NULL);
+
+	Executable* executable = meh_exec_list_get_executable(data, idx);
+	if (executable == NULL) {
+		return FALSE;
+	}
+
+	/* already hydrated, only mark it as the most recently used. */
+	if (executable->hydrated) {
+		g_queue_remove(data->hydrated_executables, executable);
+		g_queue_push_head(data->hydrated_executables, executable);
+		return TRUE;
+	}
+
+	if (!meh_db_hydrate_executable(app->db, executable)) {
+		return FALSE;
+	}
+	g_queue_push_head(data->hydrated_executables, executable);
+
+	while (g_queue_get_length(data->hydrated_executables) > MEH_EXEC_LIST_MAX_HYDRATED) {
+		Executable* evicted = g_queue_pop_tail(data->hydrated_executables);
+		meh_model_executable_dehydrate(evicted);
+	}
+
+	return TRUE;
+}
+
+/*
+ * meh_exec_list_window_reset replaces the loaded executables by the given
+ * ones, the first of them being at the index `start` of the list.
+ * Takes the ownership of the executables, the queue is freed.
+ */
+static void meh_exec_list_window_reset(ExecutableListData* data, GQueue* executables, int start) {
+	g_assert(data != NULL);
+	g_assert(executables != NULL);
+
+	for (unsigned int i = 0; i < data->executables->len; i++) {
+		meh_exec_list_destroy_executable(data, g_ptr_array_index(data->executables, i));
+	}
+	g_ptr_array_set_size(data->executables, 0);
+
+	for (GList* it = executables->head; it != NULL; it = it->next) {
+		g_ptr_array_add(data->executables, it->data);
+	}
+	g_queue_free(executables);
+
+	data->window_start = start;
+}
+
+/*
+ * meh_exec_list_window_trim releases the loaded executables
+ * which are not in the given page or in its neighbours.
+ */
+static void meh_exec_list_window_trim(ExecutableListData* data, int page) {
+	g_assert(data != NULL);
+
+	int first = MAX(page - 1, 0) * MEH_EXEC_LIST_SIZE;
+	int end = (page + 2) * MEH_EXEC_LIST_SIZE;
+
+	/* before the previous page */
+	int count = MIN(MAX(first - data->window_start, 0), (int)data->executables->len);
+	for (int i = 0; i < count; i++) {
+		meh_exec_list_destroy_executable(data, g_ptr_array_index(data->executables, i));
+	}
+	g_ptr_array_remove_range(data->executables, 0, count);
+	data->window_start += count;
+
+	/* after the next page */
+	count = MIN(MAX(data->window_start + (int)data->executables->len - end, 0), (int)data->executables->len);
+	for (int i = data->executables->len - count; i < (int)data->executables->len; i++) {
+		meh_exec_list_destroy_executable(data, g_ptr_array_index(data->executables, i));
+	}
+	g_ptr_array_set_size(data->executables, data->executables->len - count);
+}
+
+/*
+ * meh_exec_list_window_move, in paging mode, loads the page of the selected
+ * executable and its two neighbours, then releases the other pages.
+ * The adjacent pages are read with keyset queries starting from the loaded
+ * executables. A jump to another page is only possible to the first or to
+ * the last page (wraparounds), use meh_exec_list_jump_to_executable otherwise.
+ */
+static void meh_exec_list_window_move(App* app, Screen* screen) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	ExecutableListData* data = meh_exec_list_get_data(screen);
+
+	if (!data->paging || data->executables_length == 0) {
+		return;
+	}
+
+	int page = data->selected_executable / MEH_EXEC_LIST_SIZE;
+	int last_page = (data->executables_length - 1) / MEH_EXEC_LIST_SIZE;
+	int length = data->executables->len;
+	int first_loaded_page = data->window_start / MEH_EXEC_LIST_SIZE;
+	int last_loaded_page = (data->window_start + length - 1) / MEH_EXEC_LIST_SIZE;
+
+	/* not adjacent to the loaded pages, reload from the first or the last page. */
+	if (length == 0 || page < first_loaded_page - 1 || page > last_loaded_page + 1) {
+		if (page == last_page && page != 0) {
+			GQueue* executables = meh_db_get_executables_before(app->db, data->platform, -1,
+											data->executables_length - page * MEH_EXEC_LIST_SIZE);
+			meh_exec_list_window_reset(data, executables, data->executables_length - g_queue_get_length(executables));
+		} else {
+			if (page != 0) {
+				g_warning("Can't jump to the page %d of the executables, going back to the first page.", page);
+				data->selected_executable = page = 0;
+			}
+			GQueue* executables = meh_db_get_executables_from(app->db, data->platform, -1, MEH_EXEC_LIST_SIZE);
+			meh_exec_list_window_reset(data, executables, 0);
+		}
+	}
+
+	if (data->executables->len == 0) {
+		return;
+	}
+
+	/* previous page(s) */
+	int first = MAX(page - 1, 0) * MEH_EXEC_LIST_SIZE;
+	if (data->window_start > first) {
+		Executable* head = g_ptr_array_index(data->executables, 0);
+		GQueue* executables = meh_db_get_executables_before(app->db, data->platform, head->id, data->window_start - first);
+		int i = 0;
+		for (GList* it = executables->head; it != NULL; it = it->next) {
+			g_ptr_array_insert(data->executables, i++, it->data);
+		}
+		data->window_start -= g_queue_get_length(executables);
+		g_queue_free(executables);
+	}
+
+	/* next page(s) */
+	int end = MIN((page + 2) * MEH_EXEC_LIST_SIZE, data->executables_length);
+	int loaded_end = data->window_start + data->executables->len;
+	if (loaded_end < end) {
+		Executable* tail = g_ptr_array_index(data->executables, data->executables->len - 1);
+		GQueue* executables = meh_db_get_executables_after(app->db, data->platform, tail->id, end - loaded_end);
+		for (GList* it = executables->head; it != NULL; it = it->next) {
+			g_ptr_array_add(data->executables, it->data);
+		}
+		g_queue_free(executables);
+	}
+
+	meh_exec_list_window_trim(data, page);
+}
+
+/*
+ * meh_exec_list_jump_to_executable moves the selection on the executable
+ * with the given id, reading its new position from the DB in paging mode.
+ */
+void meh_exec_list_jump_to_executable(App* app, Screen* screen, int executable_id) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	ExecutableListData* data = meh_exec_list_get_data(screen);
+
+	int position = -1;
+
+	if (data->paging) {
+		position = meh_db_get_executable_position(app->db, data->platform, executable_id);
+		if (position < 0) {
+			return;
+		}
+		/* load from this executable, its neighbours will
+		 * be loaded by the cursor move. */
+		GQueue* executables = meh_db_get_executables_from(app->db, data->platform, executable_id, MEH_EXEC_LIST_SIZE);
+		meh_exec_list_window_reset(data, executables, position);
+	} else {
+		for (unsigned int i = 0; i < data->executables->len; i++) {
+			Executable* executable = g_ptr_array_index(data->executables, i);
+			if (executable->id == executable_id) {
+				position = i;
+				break;
+			}
+		}
+		if (position < 0) {
+			return;
+		}
+	}
+
+	int prev_selected = data->selected_executable;
+	data->selected_executable = position;
+
+	meh_exec_list_after_cursor_move(app, screen, prev_selected);
+	meh_exec_list_refresh_executables_widget(app, screen);
+}
+
 int meh_exec_list_messages_handler(App* app, Screen* screen, Message* message) {
 	g_assert(app != NULL);
 	g_assert(screen != NULL);
@@ -510,6 +733,23 @@ int meh_exec_list_messages_handler(App* app, Screen* screen, Message* message) {
 		case MEH_MSG_UPDATE:
 			{
 				meh_exec_list_update(screen);
+				/* also updated under the popup and the launch screen, which
+				 * use one of the executables: the changes would free it. */
+				if (app->current_screen == screen) {
+					meh_exec_list_apply_changes(app, screen);
+				}
+			}
+			break;
+		case MEH_MSG_DB_RESULT:
+			{
+				DBRequest* request = (DBRequest*)message->data;
+				meh_exec_list_db_result(app, screen, request);
+			}
+			break;
+		case MEH_MSG_IMAGE_RESULT:
+			{
+				ImageRequest* request = (ImageRequest*)message->data;
+				meh_exec_list_image_result(app, screen, request);
 			}
 			break;
 		case MEH_MSG_RENDER:
@@ -528,83 +768,554 @@ int meh_exec_list_messages_handler(App* app, Screen* screen, Message* message) {
 }
 
 /*
- * meh_exec_list_load_resources loads the resources of the currently
- * selected game.
+ * meh_exec_list_loaded fills the list with the executables
+ * loaded by the DB worker.
  */
-static void meh_exec_list_load_resources(App* app, Screen* screen) {
-	g_assert(app != NULL);	
+static void meh_exec_list_loaded(App* app, Screen* screen, DBRequest* request) {
+	g_assert(app != NULL);
 	g_assert(screen != NULL);
+	g_assert(request != NULL);
 
 	ExecutableListData* data = meh_exec_list_get_data(screen);
 
-	if (data->executables == NULL || data->executables_length == 0) {
+	data->load_request = 0;
+
+	if (!request->success) {
+		g_critical("Can't load the executables of '%s'.", data->platform->name);
 		return;
 	}
-	
-	Executable* executable = g_queue_peek_nth(data->executables, data->selected_executable);
-	if (executable == NULL || executable->resources == NULL) {
-		return;
+
+	data->executables_length = request->count;
+
+	/* too many executables, the DB worker only counted them:
+	 * the pages are loaded while moving in the list. */
+	if (request->executables == NULL) {
+		g_message("Paging the %d executables of '%s'.", data->executables_length, data->platform->name);
+		data->paging = TRUE;
+		/* loaded again, the pages of the previous load are outdated. */
+		meh_exec_list_window_reset(data, g_queue_new(), 0);
+		data->selected_executable = 0;
+	} else {
+		/* take the ownership of the executables */
+		meh_exec_list_window_reset(data, request->executables, 0);
+		request->executables = NULL;
+		data->paging = FALSE;
+		data->executables_length = data->executables->len;
 	}
 
-	/* Create the hash table if not existing */
-	if (data->textures == NULL) {
-		data->textures = g_hash_table_new(g_int_hash, g_int_equal);
+	if (data->selected_executable >= data->executables_length) {
+		data->selected_executable = MAX(data->executables_length - 1, 0);
 	}
 
-	/* Loads the textures described in the executable resources
-	 * if it's not already in the cache */
-	for (unsigned int i = 0; i < g_queue_get_length(executable->resources); i++) {
-		ExecutableResource* resource = g_queue_peek_nth(executable->resources, i);
-		if (resource == NULL) {
+	meh_exec_list_after_cursor_move(app, screen, -1);
+	meh_exec_list_refresh_executables_widget(app, screen);
+
+	/* loaded again after some changes: select again the same executable. */
+	if (data->reselect_executable != -1) {
+		meh_exec_list_jump_to_executable(app, screen, data->reselect_executable);
+		data->reselect_executable = -1;
+	}
+}
+
+/*
+ * meh_exec_list_apply_changes applies to the list the changes of the
+ * executables of the platform done in the database since the last ones
+ * applied, keeping the selected executable. A few changed executables are
+ * read again one by one, keeping the textures of the others. The list is
+ * reloaded by the DB worker after a bulk insert, after many changes
+ * or in paging mode.
+ */
+static void meh_exec_list_apply_changes(App* app, Screen* screen) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	ExecutableListData* data = meh_exec_list_get_data(screen);
+
+	/* the changes are applied once loaded, the load may already contain some. */
+	if (data->catalog_change_id == app->catalog_change_id || data->load_request != 0) {
+		return;
+	}
+
+	GQueue* changes = meh_db_get_catalog_changes(app->db, data->catalog_change_id);
+	data->catalog_change_id = app->catalog_change_id;
+
+	/* id of the changed executables -> whether their resources have changed. */
+	GHashTable* changed = g_hash_table_new(NULL, NULL);
+	gboolean reload = changes == NULL;
+
+	for (GList* it = changes != NULL ? changes->head : NULL; it != NULL; it = it->next) {
+		CatalogChange* change = it->data;
+		if (change->kind == MEH_CATALOG_CHANGE_PLATFORM || change->platform_id != data->platform->id) {
 			continue;
 		}
 
-		/* ensure that it's an image */
-		if (g_strcmp0(resource->type, "video") == 0) {
+		/* bulk insert in the platform */
+		if (change->executable_id == -1) {
+			reload = TRUE;
 			continue;
 		}
 
-		/* Load only the needed resources. */
-		int rid = resource->id;
-		if (rid != data->background && rid != data->cover && rid != data->logo &&
-			rid != data->screenshots[0] && rid != data->screenshots[1] &&
-			rid != data->screenshots[2]) {
+		/* already applied by the screen when written by the DB worker. */
+		gint64* applied = g_hash_table_lookup(data->applied_changes, GINT_TO_POINTER(change->executable_id));
+		if (applied != NULL && change->id <= *applied) {
 			continue;
 		}
 
-		/* Look whether or not it's already in the cache. */
-		if (g_hash_table_lookup(data->textures, &(resource->id)) != NULL) {
-			g_debug("Not reloading the %s ID %d", resource->type, resource->id);
-			continue;
+		gboolean resources = GPOINTER_TO_INT(g_hash_table_lookup(changed, GINT_TO_POINTER(change->executable_id)));
+		resources |= change->kind == MEH_CATALOG_CHANGE_RESOURCES;
+		g_hash_table_replace(changed, GINT_TO_POINTER(change->executable_id), GINT_TO_POINTER(resources));
+	}
+
+	if (changes != NULL) {
+		g_queue_free_full(changes, g_free);
+	}
+
+	/* the changes applied by the screen up to now are seen. */
+	g_hash_table_foreach_remove(data->applied_changes, meh_exec_list_is_applied_change, &data->catalog_change_id);
+
+	int count = g_hash_table_size(changed);
+	if (reload || (count > 0 && (data->paging || count > MEH_EXEC_LIST_MAX_CHANGES))) {
+		g_debug("Reloading the executables of '%s' after %d changes.", data->platform->name, count);
+		Executable* selected = meh_exec_list_get_executable(data, data->selected_executable);
+		data->reselect_executable = selected != NULL ? selected->id : -1;
+		data->load_request = meh_db_worker_load_executable_list(app->db_worker, data->platform->id,
+										app->settings.catalog_paging_threshold);
+	} else if (count > 0) {
+		meh_exec_list_apply_executables(app, screen, changed);
+	}
+
+	g_hash_table_destroy(changed);
+}
+
+static gboolean meh_exec_list_is_applied_change(gpointer key, gpointer value, gpointer data) {
+	return *(gint64*)value <= *(gint64*)data;
+}
+
+/*
+ * meh_exec_list_find_position returns the position of the given executable
+ * in the loaded executables, in the order of the database, found by
+ * binary search: the executables before it are lower.
+ */
+static int meh_exec_list_find_position(ExecutableListData* data, const Executable* executable) {
+	g_assert(data != NULL);
+	g_assert(executable != NULL);
+
+	int low = 0;
+	int high = data->executables->len;
+	while (low < high) {
+		int middle = low + (high - low) / 2;
+		if (meh_model_executable_compare(g_ptr_array_index(data->executables, middle), executable) < 0) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+/*
+ * meh_exec_list_apply_executables reads again the changed executables of
+ * the given table (see meh_exec_list_apply_changes) then inserts, replaces
+ * or removes them in the list. The textures of an executable are only freed
+ * if it is removed or if its resources have changed.
+ */
+static void meh_exec_list_apply_executables(App* app, Screen* screen, GHashTable* changed) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+	g_assert(changed != NULL);
+
+	ExecutableListData* data = meh_exec_list_get_data(screen);
+
+	Executable* selected = meh_exec_list_get_executable(data, data->selected_executable);
+	int selected_id = selected != NULL ? selected->id : -1;
+
+	/* the executables read again, inserted once the old ones removed. */
+	GPtrArray* inserted = g_ptr_array_new();
+
+	GHashTableIter iter;
+	gpointer key, value;
+	g_hash_table_iter_init(&iter, changed);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		int id = GPOINTER_TO_INT(key);
+
+		Executable* executable = meh_db_get_executable(app->db, id);
+		if (executable != NULL && executable->platform_id != data->platform->id) {
+			/* moved to another platform */
+			meh_model_executable_destroy(executable);
+			executable = NULL;
 		}
 
-		g_debug("Loading the %s ID %d", resource->type, resource->id);
-		SDL_Texture* texture = meh_image_load_file(app->window->sdl_renderer, resource->filepath);
-		if (texture != NULL) {
-			int* id = g_new(int, 1); *id = resource->id;
-			g_hash_table_insert(data->textures, id, texture);
+		for (unsigned int i = 0; i < data->executables->len; i++) {
+			Executable* old = g_ptr_array_index(data->executables, i);
+			if (old->id != id) {
+				continue;
+			}
+
+			g_ptr_array_remove_index(data->executables, i);
+			if (executable == NULL || GPOINTER_TO_INT(value)) {
+				meh_exec_list_destroy_executable(data, old);
+			} else {
+				/* the textures are indexed by resource id, the new one uses them. */
+				g_queue_remove(data->hydrated_executables, old);
+				meh_model_executable_destroy(old);
+			}
+			break;
+		}
+
+		if (executable != NULL) {
+			g_ptr_array_add(inserted, executable);
 		}
 	}
 
-	/* Add to the cache the information that we've load some resources for this executable
-	 * only if it's not already present.
-	 * We loosely test all the values because no set in glib
-	 * (we could use the hash table for that, but meh). - remy */
-	gboolean existing = FALSE;
-	for (unsigned int i = 0; i < g_queue_get_length(data->cache_executables_id); i++) {
-		int* val = g_queue_peek_nth(data->cache_executables_id, i);
-		if (*val == data->selected_executable) {
-			existing = TRUE;
+	/* the whole list is loaded and ordered: each one is inserted at its
+	 * position found in memory rather than counted in the database. */
+	for (unsigned int i = 0; i < inserted->len; i++) {
+		Executable* executable = g_ptr_array_index(inserted, i);
+		g_ptr_array_insert(data->executables, meh_exec_list_find_position(data, executable), executable);
+	}
+	g_ptr_array_free(inserted, TRUE);
+
+	data->executables_length = data->executables->len;
+
+	/* select again the same executable, the one at its place if it has been deleted. */
+	int prev_selected = data->selected_executable;
+	for (int i = 0; i < data->executables_length; i++) {
+		Executable* executable = g_ptr_array_index(data->executables, i);
+		if (executable->id == selected_id) {
+			data->selected_executable = i;
 			break;
 		}
 	}
-	if (!existing) {
-		int* idx = g_new(int, 1); *idx = data->selected_executable;
-		g_queue_push_tail(data->cache_executables_id, idx);
+
+	if (data->selected_executable >= data->executables_length) {
+		data->selected_executable = MAX(data->executables_length - 1, 0);
 	}
 
-	return;
-} 
+	meh_exec_list_refresh_executables_widget(app, screen);
+	meh_exec_list_after_cursor_move(app, screen, prev_selected);
+}
+
+/*
+ * meh_exec_list_favorite_updated applies the new favorite value of an
+ * executable written by the DB worker, re-positioning it in the list.
+ */
+static void meh_exec_list_favorite_updated(App* app, Screen* screen, DBRequest* request) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+	g_assert(request != NULL);
+
+	ExecutableListData* data = meh_exec_list_get_data(screen);
+
+	if (!request->success) {
+		g_critical("Can't update the favorite value of the executable %d.", request->executable_id);
+		return;
+	}
+
+	/* the list is up-to-date with this change, it must not be applied again
+	 * when seen in the catalog: in paging mode, the list would be reloaded. */
+	gint64* applied = g_new(gint64, 1);
+	*applied = request->catalog_change_id;
+	g_hash_table_replace(data->applied_changes, GINT_TO_POINTER(request->executable_id), applied);
+
+	/* only a window of the list is loaded, the executable
+	 * may move outside of it: reload around its new position. */
+	if (data->paging) {
+		meh_exec_list_jump_to_executable(app, screen, request->executable_id);
+		return;
+	}
+
+	/* retrieves the one which will move in the list */
+	int idx = 0;
+	while (idx < (int)data->executables->len &&
+			((Executable*)g_ptr_array_index(data->executables, idx))->id != request->executable_id) {
+		idx++;
+	}
+
+	if (idx == (int)data->executables->len) {
+		return;
+	}
+
+	Executable* to_move = g_ptr_array_remove_index(data->executables, idx);
+	to_move->favorite = request->favorite;
+
+	/* find the good position for the moved executable, in the
+	 * order of the database: the favorites first, then by name. */
+	int position = meh_exec_list_find_position(data, to_move);
+
+	/* re-add it to the good position */
+	g_ptr_array_insert(data->executables, position, to_move);
+
+	/* the selection follows the moved executable */
+	int prev_selected = data->selected_executable;
+	if (prev_selected == idx) {
+		data->selected_executable = position;
+	}
+
+	/* redraw the executables list texts */
+	meh_exec_list_refresh_executables_widget(app, screen);
+
+	/* move and redraw the selection */
+	meh_exec_list_after_cursor_move(app, screen, prev_selected);
+}
+
+/*
+ * meh_exec_list_db_result receives the results of the DB worker requests.
+ */
+static void meh_exec_list_db_result(App* app, Screen* screen, DBRequest* request) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+	g_assert(request != NULL);
+
+	ExecutableListData* data = meh_exec_list_get_data(screen);
+
+	switch (request->type) {
+		case MEH_DB_REQUEST_LOAD_EXECUTABLE_LIST:
+			if (request->id == data->load_request) {
+				meh_exec_list_loaded(app, screen, request);
+			}
+			break;
+		case MEH_DB_REQUEST_SET_EXECUTABLE_FAVORITE:
+			meh_exec_list_favorite_updated(app, screen, request);
+			break;
+	}
+}
+
+/*
+ * meh_exec_list_want_resources adds to `wanted` and `order` the images
+ * of the executable amongst the picked resources. `wanted` maps
+ * a resource id to its first index in `picked`.
+ */
+static void meh_exec_list_want_resources(Executable* executable, int* picked, int picked_count,
+		GHashTable* wanted, GPtrArray* order) {
+	int count = 0;
+	ExecutableResource* images = meh_model_executable_get_resources(executable, MEH_EXEC_RES_OTHER, MEH_EXEC_RES_LOGO, &count);
+	for (int i = 0; i < count; i++) {
+		ExecutableResource* resource = &images[i];
+		for (int j = 0; j < picked_count; j++) {
+			if (picked[j] == resource->id && !g_hash_table_contains(wanted, &(resource->id))) {
+				g_hash_table_insert(wanted, &(resource->id), GINT_TO_POINTER(j));
+				g_ptr_array_add(order, resource);
+				break;
+			}
+		}
+	}
+}
+
+/*
+ * meh_exec_list_image_size returns in pixels the size of the widget displaying
+ * the picked resource at the given index: the background, the cover, the logo
+ * then the screenshots. The cover can be a portrait or a landscape: its image
+ * covers both to keep its ratio.
+ */
+void meh_exec_list_image_size(Window* window, int picked_index, int* width, int* height) {
+	g_assert(window != NULL);
+	g_assert(width != NULL);
+	g_assert(height != NULL);
+
+	float w = 0, h = 0;
+	switch (picked_index) {
+		case MEH_EXEC_LIST_PICKED_BACKGROUND:
+			w = MEH_FAKE_WIDTH+50; h = MEH_FAKE_HEIGHT+50;
+			break;
+		case MEH_EXEC_LIST_PICKED_COVER:
+			w = 300; h = 300;
+			break;
+		case MEH_EXEC_LIST_PICKED_LOGO:
+			w = 440; h = 100;
+			break;
+		default:
+			w = 190; h = 80;
+			break;
+	}
+
+	*width = (int)meh_window_convert_width(window, w);
+	*height = (int)meh_window_convert_height(window, h);
+}
+
+/*
+ * meh_exec_list_request_image requests the decoding of the image of the resource
+ * if it's neither loaded, decoding nor in the texture cache. A prefetched image
+ * displayed before being decoded is requested again with the display priority.
+ */
+static void meh_exec_list_request_image(App* app, Screen* screen, ExecutableResource* resource, int picked_index, int priority) {
+	ExecutableListData* data = meh_exec_list_get_data(screen);
+	ImageLoader* loader = app->window->image_loader;
+
+	/* Look whether or not it's already loaded, decoding or in the cache. */
+	if (g_hash_table_lookup(data->textures, &(resource->id)) != NULL) {
+		return;
+	}
+
+	guint request_id = GPOINTER_TO_UINT(g_hash_table_lookup(data->image_requests, &(resource->id)));
+	if (request_id != 0 && priority != MEH_IMAGE_PRIORITY_DISPLAY) {
+		return;
+	}
+
+	/* e.g. the same file used by another executable. */
+	int width = 0, height = 0;
+	meh_exec_list_image_size(app->window, picked_index, &width, &height);
+
+	SDL_Texture* texture = meh_texture_cache_get(data->texture_cache, resource->filepath, width, height);
+	if (texture != NULL) {
+		if (request_id != 0) {
+			meh_image_loader_cancel(loader, request_id);
+			g_hash_table_remove(data->image_requests, &(resource->id));
+		}
+		int* id = g_new(int, 1); *id = resource->id;
+		g_hash_table_insert(data->textures, id, texture);
+		return;
+	}
+
+	if (request_id != 0) {
+		request_id = meh_image_loader_promote(loader, request_id);
+	} else {
+		g_debug("Loading the %s ID %d%s", meh_model_exec_res_type_name(resource->type), resource->id,
+				priority == MEH_IMAGE_PRIORITY_PREFETCH ? " (prefetch)" : "");
+		request_id = meh_image_loader_load(loader, screen, resource->filepath, resource->id, priority, width, height);
+	}
+
+	int* id = g_new(int, 1); *id = resource->id;
+	g_hash_table_insert(data->image_requests, id, GUINT_TO_POINTER(request_id));
+}
+
+/*
+ * meh_exec_list_warm_video reads in background the start of the video
+ * of the executable, opened with the executable is selected.
+ */
+static void meh_exec_list_warm_video(App* app, ExecutableListData* data, Executable* executable) {
+	int count = 0;
+	ExecutableResource* videos = meh_model_executable_get_resources(executable, MEH_EXEC_RES_VIDEO, MEH_EXEC_RES_VIDEO, &count);
+	if (count == 0 || g_hash_table_contains(data->warmed_videos, GINT_TO_POINTER(videos[0].id))) {
+		return;
+	}
+
+	g_hash_table_add(data->warmed_videos, GINT_TO_POINTER(videos[0].id));
+	meh_image_loader_warm(app->window->image_loader, videos[0].filepath);
+}
+
+/*
+ * meh_exec_list_add_prefetch_index adds the index to the prefetched ones,
+ * through the ends of the list: the cursor goes around it.
+ */
+static void meh_exec_list_add_prefetch_index(ExecutableListData* data, GArray* indexes, int idx) {
+	idx = ((idx % data->executables_length) + data->executables_length) % data->executables_length;
+	if (idx == data->selected_executable) {
+		return;
+	}
+	for (guint i = 0; i < indexes->len; i++) {
+		if (g_array_index(indexes, int, i) == idx) {
+			return;
+		}
+	}
+	g_array_append_val(indexes, idx);
+}
+
+/*
+ * meh_exec_list_prefetch_indexes returns the indexes of the executables to
+ * prefetch, the most likely to be selected next first: the neighbours of
+ * the selection, more of them in the scrolling direction, then the first
+ * executables of the pages reached with L and R.
+ */
+static GArray* meh_exec_list_prefetch_indexes(App* app, ExecutableListData* data) {
+	g_assert(app != NULL);
+	g_assert(data != NULL);
+
+	GArray* indexes = g_array_new(FALSE, FALSE, sizeof(int));
+
+	int n = app->settings.images_prefetch;
+	if (n <= 0 || data->executables_length <= 1) {
+		return indexes;
+	}
+
+	int direction = data->scroll_direction != 0 ? data->scroll_direction : 1;
+	int behind = data->scroll_direction != 0 ? MAX(1, n / 2) : n;
+	for (int distance = 1; distance <= n; distance++) {
+		meh_exec_list_add_prefetch_index(data, indexes, data->selected_executable + distance * direction);
+		if (distance <= behind) {
+			meh_exec_list_add_prefetch_index(data, indexes, data->selected_executable - distance * direction);
+		}
+	}
+
+	/* see the L and R buttons */
+	int page = data->selected_executable / MEH_EXEC_LIST_SIZE;
+	int next_page = (page + 1) * MEH_EXEC_LIST_SIZE;
+	int previous_page = page > 0 ? (page - 1) * MEH_EXEC_LIST_SIZE : data->executables_length - 1;
+	meh_exec_list_add_prefetch_index(data, indexes, next_page < data->executables_length ? next_page : 0);
+	meh_exec_list_add_prefetch_index(data, indexes, previous_page);
+
+	return indexes;
+}
+
+/*
+ * meh_exec_list_load_resources requests the decoding of the resources of
+ * the currently selected game and of the prefetched ones around it, the
+ * textures are received in meh_exec_list_image_result. The images
+ * requested before and not needed anymore are cancelled.
+ */
+static void meh_exec_list_load_resources(App* app, Screen* screen) {
+	g_assert(app != NULL);	
+	g_assert(screen != NULL);
+
+	ExecutableListData* data = meh_exec_list_get_data(screen);
+
+	/* the resource ids displayed or prefetched, to their index in the picked ones. */
+	GHashTable* wanted = g_hash_table_new(g_int_hash, g_int_equal);
+	GPtrArray* displayed = g_ptr_array_new();
+	GPtrArray* prefetched = g_ptr_array_new();
+
+	Executable* executable = meh_exec_list_get_executable(data, data->selected_executable);
+	if (executable != NULL && executable->resources != NULL) {
+		int picked[6] = { data->background, data->cover, data->logo,
+						  data->screenshots[0], data->screenshots[1], data->screenshots[2] };
+		meh_exec_list_want_resources(executable, picked, 6, wanted, displayed);
+	}
+
+	GArray* indexes = meh_exec_list_prefetch_indexes(app, data);
+	for (guint i = 0; i < indexes->len; i++) {
+		Executable* neighbour = meh_exec_list_get_executable(data, g_array_index(indexes, int, i));
+		if (neighbour == NULL || neighbour->resources == NULL) { /* not loaded in paging mode */
+			continue;
+		}
+
+		int picked[6];
+		meh_exec_list_pick_resources(data, neighbour, &picked[0], &picked[1], &picked[2], &picked[3]);
+		meh_exec_list_want_resources(neighbour, picked, 6, wanted, prefetched);
+		meh_exec_list_warm_video(app, data, neighbour);
+	}
+	g_array_free(indexes, TRUE);
+
+	/* the cursor has moved faster than the decoding. */
+	GHashTableIter iter;
+	gpointer key, value;
+	g_hash_table_iter_init(&iter, data->image_requests);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		if (!g_hash_table_contains(wanted, key)) {
+			meh_image_loader_cancel(app->window->image_loader, GPOINTER_TO_UINT(value));
+			g_hash_table_iter_remove(&iter);
+		}
+	}
+
+	meh_exec_list_release_textures(data, wanted);
+
+	for (guint i = 0; i < displayed->len; i++) {
+		ExecutableResource* resource = g_ptr_array_index(displayed, i);
+		meh_exec_list_request_image(app, screen, resource,
+				GPOINTER_TO_INT(g_hash_table_lookup(wanted, &(resource->id))), MEH_IMAGE_PRIORITY_DISPLAY);
+	}
+
+	/* the most recent requests are decoded first: the
+	 * most likely to be selected are requested last. */
+	for (guint i = prefetched->len; i > 0 && !meh_texture_cache_is_full(data->texture_cache); i--) {
+		ExecutableResource* resource = g_ptr_array_index(prefetched, i - 1);
+		meh_exec_list_request_image(app, screen, resource,
+				GPOINTER_TO_INT(g_hash_table_lookup(wanted, &(resource->id))), MEH_IMAGE_PRIORITY_PREFETCH);
+	}
+
+	g_ptr_array_free(prefetched, TRUE);
+	g_ptr_array_free(displayed, TRUE);
+	g_hash_table_destroy(wanted);
+}
 
 /*
  * meh_exec_list_start_executable launches the currently selected executable.
@@ -613,10 +1324,10 @@ static void meh_exec_list_start_executable(App* app, Screen* screen) {
 	ExecutableListData* data = meh_exec_list_get_data(screen);
 
 	/* get the executable selected */
-	Executable* executable = g_queue_peek_nth(data->executables, data->selected_executable);
+	Executable* executable = meh_exec_list_get_executable(data, data->selected_executable);
 
 	/* no executables to launch. */
-	if (executable == NULL) {
+	if (executable == NULL || !meh_exec_list_hydrate(app, data, data->selected_executable)) {
 		return;
 	}
 
@@ -626,8 +1337,6 @@ static void meh_exec_list_start_executable(App* app, Screen* screen) {
 
 	// TODO(remy): here we could clean resources to free some more ram.
 
-	meh_exec_list_delete_some_cache(screen);
-
 	/* end the transitions for when we're coming back */
 	meh_transitions_end(screen->transitions);
 }
@@ -637,13 +1346,36 @@ static void meh_exec_list_start_executable(App* app, Screen* screen) {
  * after a jump in the executable list.
  */
 void meh_exec_list_after_cursor_move(App* app, Screen* screen, int prev_selected_exec) {
+	ExecutableListData* data = meh_exec_list_get_data(screen);
+
+	meh_exec_list_window_move(app, screen);
+
+	/* the direction of the scrolling, going around the list too. */
+	int length = data->executables_length;
+	if (prev_selected_exec >= 0 && prev_selected_exec != data->selected_executable && length > 0) {
+		int delta = data->selected_executable - prev_selected_exec;
+		if (delta > length / 2) {
+			delta -= length;
+		} else if (delta < -length / 2) {
+			delta += length;
+		}
+		data->scroll_direction = delta > 0 ? 1 : -1;
+	}
+
+	/* the details of the prefetched neighbours are loaded too for
+	 * when the cursor will move on them, the farthest first: the
+	 * selected one must be the most recently used. */
+	GArray* indexes = meh_exec_list_prefetch_indexes(app, data);
+	for (int i = MIN((int)indexes->len, MEH_EXEC_LIST_MAX_HYDRATED - 1) - 1; i >= 0; i--) {
+		meh_exec_list_hydrate(app, data, g_array_index(indexes, int, i));
+	}
+	g_array_free(indexes, TRUE);
+	meh_exec_list_hydrate(app, data, data->selected_executable);
+
 	meh_exec_list_select_resources(screen);
 	meh_exec_list_load_resources(app, screen);
-	meh_exec_list_delete_some_cache(screen);
 	meh_exec_list_resolve_tex(screen);
 
-	ExecutableListData* data = meh_exec_list_get_data(screen);
-
 	/* stops every transitions */
 	meh_transitions_end(screen->transitions);
 	meh_screen_update_transitions(screen);
@@ -658,8 +1390,7 @@ void meh_exec_list_after_cursor_move(App* app, Screen* screen, int prev_selected
 	meh_screen_add_rect_transitions(screen, data->selection_widget);
 
 	/*
-	 * look whether the image is a portrait / landscape image
-	 * and change the size of the description / cover in function
+	 * place the logo, the cover and the description
 	 */
 
 	if (data->logo == -1) {
@@ -674,36 +1405,13 @@ void meh_exec_list_after_cursor_move(App* app, Screen* screen, int prev_selected
 		meh_screen_add_image_transitions(screen, data->logo_widget);
 	}
 
-	if (data->cover == -1 || data->cover_widget->texture == NULL) {
-		/* no cover, use the full width for the description */
-		data->description_widget->w = 650;
-		data->cover_widget->texture = NULL;
-	} else {
-		/* detect the landscape/portrait mode */
-		int w = 0,h = 0;
-		SDL_QueryTexture(data->cover_widget->texture, NULL, NULL, &w, &h);
-		if (w >= h) {
-			/* landscape */
-			data->cover_widget->x.value = 930;
-			data->cover_widget->w.value = 300;
-			data->cover_widget->h.value = 200;
-			data->logo_widget->w.value = 340;
-			data->description_widget->w = 340;
-		} else {
-			/* portrait */
-			data->cover_widget->x.value = 1030;
-			data->cover_widget->w.value = 200;
-			data->cover_widget->h.value = 300;
-			data->logo_widget->w.value = 440;
-			data->description_widget->w = 440;
-		}
-	}
+	meh_exec_list_place_cover(data);
 
 	/* 
 	 * refreshes the text widgets about game info.
 	 */
 
-	Executable* current_executable = g_queue_peek_nth(data->executables, data->selected_executable);
+	Executable* current_executable = meh_exec_list_get_executable(data, data->selected_executable);
 	if (current_executable != NULL) {
 		data->genres_widget->text = current_executable->genres;
 		meh_widget_text_reload(app->window, data->genres_widget);
@@ -786,8 +1494,8 @@ void meh_exec_list_after_cursor_move(App* app, Screen* screen, int prev_selected
 
 	meh_widget_text_reset_move(data->description_widget);
 
-	for (unsigned int i = 0; i < g_queue_get_length(data->executable_widgets); i++) {
-		meh_widget_text_reset_move(g_queue_peek_nth(data->executable_widgets, i));
+	for (unsigned int i = 0; i < data->executable_widgets->len; i++) {
+		meh_widget_text_reset_move(g_ptr_array_index(data->executable_widgets, i));
 	}
 }
 
@@ -801,17 +1509,15 @@ void meh_exec_list_refresh_executables_widget(App* app, Screen* screen) {
 	int page = (data->selected_executable / (MEH_EXEC_LIST_SIZE));
 
 	/* for every executable text widget */
-	for (unsigned int i = 0; i < g_queue_get_length(data->executable_widgets); i++) {
-		WidgetText* text = g_queue_peek_nth(data->executable_widgets, i);
+	for (unsigned int i = 0; i < data->executable_widgets->len; i++) {
+		WidgetText* text = g_ptr_array_index(data->executable_widgets, i);
 		text->text = "";
 		
 		/* look for the executable text if any */
 		int executable_idx = page*(MEH_EXEC_LIST_SIZE) + i;
-		if (executable_idx <= data->executables_length) {
-			Executable* executable = g_queue_peek_nth(data->executables, executable_idx);
-			if (executable != NULL) {
-				text->text = executable->display_name;
-			}
+		Executable* executable = meh_exec_list_get_executable(data, executable_idx);
+		if (executable != NULL) {
+			text->text = executable->display_name;
 		}
 
 		/* reload the text texture. */
@@ -824,7 +1530,7 @@ static void meh_exec_list_open_popup(App* app, Screen* screen) {
 	g_assert(screen != NULL);
 
 	ExecutableListData* data = meh_exec_list_get_data(screen);
-	Executable* executable = g_queue_peek_nth(data->executables, data->selected_executable);
+	Executable* executable = meh_exec_list_get_executable(data, data->selected_executable);
 
 	if (executable == NULL) {
 		return;
@@ -837,6 +1543,23 @@ static void meh_exec_list_open_popup(App* app, Screen* screen) {
 	 * will go back to it later. */
 }
 
+static void meh_exec_list_open_search(App* app, Screen* screen) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	ExecutableListData* data = meh_exec_list_get_data(screen);
+
+	if (data->executables_length == 0) {
+		return;
+	}
+
+	/* create the child screen */
+	Screen* search_screen = meh_screen_search_new(app, screen, data->platform->id);
+	meh_app_set_current_screen(app, search_screen, TRUE);
+	/* NOTE we don't free the memory of the current screen, the search screen
+	 * will go back to it later. */
+}
+
 /*
  * meh_exec_list_button_pressed is called when we received a button pressed
  * message.
@@ -868,6 +1591,10 @@ void meh_exec_list_button_pressed(App* app, Screen* screen, int pressed_button)
 			/* start the popup */
 			meh_exec_list_open_popup(app, screen);
 			break;
+		case MEH_INPUT_BUTTON_SELECT:
+			/* search an executable */
+			meh_exec_list_open_search(app, screen);
+			break;
 		case MEH_INPUT_BUTTON_A:
 			/* launch the game */
 			meh_exec_list_start_executable(app, screen);
@@ -902,7 +1629,7 @@ void meh_exec_list_button_pressed(App* app, Screen* screen, int pressed_button)
 			{
 				int page = (data->selected_executable / (MEH_EXEC_LIST_SIZE)) + 1;
 				data->selected_executable = page * MEH_EXEC_LIST_SIZE;
-				if (data->selected_executable > data->executables_length) {
+				if (data->selected_executable >= data->executables_length) {
 					data->selected_executable = 0;
 				}
 				meh_exec_list_after_cursor_move(app, screen, prev_selected_exec);
@@ -925,7 +1652,7 @@ int meh_exec_list_update(Screen* screen) {
 	/* updates the text of the selected game */
 
 	int selected = data->selected_executable % (MEH_EXEC_LIST_SIZE);
-	WidgetText* t = g_queue_peek_nth(data->executable_widgets, selected);
+	WidgetText* t = selected < (int)data->executable_widgets->len ? g_ptr_array_index(data->executable_widgets, selected) : NULL;
 	if (t != NULL) {
 		meh_widget_text_update(screen, t);
 	}
@@ -944,6 +1671,79 @@ int meh_exec_list_update(Screen* screen) {
 	return 0;
 }
 
+/*
+ * meh_exec_list_place_cover looks whether the cover is a portrait / landscape
+ * image and changes the size of the description / cover in function. Called
+ * again when the cover is received: it's decoded in background.
+ */
+static void meh_exec_list_place_cover(ExecutableListData* data) {
+	g_assert(data != NULL);
+
+	if (data->cover == -1 || data->cover_widget->texture == NULL) {
+		/* no cover, use the full width for the description */
+		data->description_widget->w = 650;
+		data->cover_widget->texture = NULL;
+	} else {
+		/* detect the landscape/portrait mode, the
+		 * image has been downscaled keeping its ratio. */
+		int w = 0,h = 0;
+		SDL_QueryTexture(data->cover_widget->texture, NULL, NULL, &w, &h);
+		if (w >= h) {
+			/* landscape */
+			data->cover_widget->x.value = 930;
+			data->cover_widget->w.value = 300;
+			data->cover_widget->h.value = 200;
+			data->logo_widget->w.value = 340;
+			data->description_widget->w = 340;
+		} else {
+			/* portrait */
+			data->cover_widget->x.value = 1030;
+			data->cover_widget->w.value = 200;
+			data->cover_widget->h.value = 300;
+			data->logo_widget->w.value = 440;
+			data->description_widget->w = 440;
+		}
+	}
+}
+
+/*
+ * meh_exec_list_image_result receives an image decoded in background:
+ * a resource of the selected executable.
+ */
+static void meh_exec_list_image_result(App* app, Screen* screen, ImageRequest* request) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+	g_assert(request != NULL);
+
+	ExecutableListData* data = meh_exec_list_get_data(screen);
+
+	int rid = request->tag;
+	if (GPOINTER_TO_UINT(g_hash_table_lookup(data->image_requests, &rid)) != request->id) {
+		return;
+	}
+	g_hash_table_remove(data->image_requests, &rid);
+
+	if (request->texture == NULL) {
+		/* can't be loaded, don't keep the previous background. */
+		if (rid == data->background) {
+			data->background_widget->texture = NULL;
+		}
+		return;
+	}
+
+	/* the texture is now owned by the cache. */
+	int* id = g_new(int, 1); *id = rid;
+	g_hash_table_insert(data->textures, id, meh_texture_cache_add(data->texture_cache, request->filename, request->width, request->height, request->texture));
+	request->texture = NULL;
+
+	meh_exec_list_resolve_tex(screen);
+	if (rid == data->cover) {
+		/* the description is narrower next to the cover. */
+		meh_exec_list_place_cover(data);
+		meh_widget_text_reload(app->window, data->description_widget);
+	}
+}
+
 /*
  * meh_exec_list_resolve_tex resolves all the tex index
  * to real textures for object referencing them.
@@ -953,8 +1753,16 @@ static void meh_exec_list_resolve_tex(Screen* screen) {
 
 	ExecutableListData* data = meh_exec_list_get_data(screen);
 
+	if (data->textures == NULL) {
+		return;
+	}
+
+	/* the previous background stays until the new one is decoded. */
 	if (data->background > -1) {
-		data->background_widget->texture = g_hash_table_lookup(data->textures, &(data->background));
+		SDL_Texture* background = g_hash_table_lookup(data->textures, &(data->background));
+		if (background != NULL) {
+			data->background_widget->texture = background;
+		}
 	}
 	if (data->cover > -1) {
 		data->cover_widget->texture = g_hash_table_lookup(data->textures, &(data->cover));
@@ -981,7 +1789,7 @@ int meh_exec_list_render(App* app, Screen* screen, gboolean flip) {
 	
 	ExecutableListData* data = meh_exec_list_get_data(screen);
 
-	Executable* current_executable = g_queue_peek_nth(data->executables, data->selected_executable);
+	Executable* current_executable = meh_exec_list_get_executable(data, data->selected_executable);
 
 	/* background */
 	meh_widget_image_render(app->window, data->background_widget);
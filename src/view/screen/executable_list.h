@@ -10,26 +10,47 @@
 
 #include "system/message.h"
 #include "view/screen.h"
+#include "view/texture_cache.h"
 #include "view/widget_rect.h"
 #include "view/screen/exec_list_video.h"
 
 /* cross-reference */
 struct App;
 
-#define MEH_EXEC_LIST_MAX_CACHE (7)
-#define MEH_EXEC_LIST_DELTA (3) /* Don't delete the cache of the object around the cursor */
+#define MEH_EXEC_LIST_MAX_HYDRATED (16) /* Maximum amount of executables with their details loaded */
 
 #define MEH_EXEC_LIST_SIZE (17) /* Maximum amount of executables displayed */
+#define MEH_EXEC_LIST_MAX_CHANGES (200) /* Above, the changed executables are not applied one by one, the list is reloaded */
+
+/* Indexes of the resources picked for an executable */
+#define MEH_EXEC_LIST_PICKED_BACKGROUND 0
+#define MEH_EXEC_LIST_PICKED_COVER 1
+#define MEH_EXEC_LIST_PICKED_LOGO 2
+#define MEH_EXEC_LIST_PICKED_SCREENSHOT 3 /* to 5 */
 
 typedef struct ExecutableListData {
 	Platform* platform;
-	GQueue* executables; /* List of Executable*, must be freed. */
-	int executables_length;
+	GPtrArray* executables; /* Array of Executable*, must be freed. In paging mode, only the loaded window. */
+	int executables_length; /* Amount of executables of the platform. */
 	int selected_executable;
-	GHashTable* textures; /* Hash int->SDL_Texture*, each SDL_Texture* must be freed. */
 
-	GQueue *cache_executables_id; /* Contains the executables for which we have load the resources
-									 The first loaded is the first in the queue. */
+	guint load_request; /* id of the DB worker request loading the executables, 0 once loaded. */
+	int reselect_executable; /* id of the executable to select once loaded, -1 if none. */
+	gint64 catalog_change_id; /* last change of the catalog applied to the list. */
+	GHashTable* applied_changes; /* Hash executable id (int) -> gint64* id of its last change already applied
+									by the screen itself (favorite), skipped by meh_exec_list_apply_changes. */
+	gboolean paging; /* Only the pages around the selected executable are loaded. */
+	int window_start; /* Index in the list of the first executable of `executables`. */
+	GHashTable* textures; /* Hash resource id (int) -> SDL_Texture* of the texture cache, each must be released. */
+	TextureCache* texture_cache; /* Of the window, must not be freed. */
+	GHashTable* image_requests; /* Hash resource id (int) -> id of the image loader request decoding it. */
+	guint32 resources_seed; /* The random resources of an executable are picked with this seed and its id:
+							   the same ones are prefetched then displayed. */
+	int scroll_direction; /* 1 scrolling down, -1 up, 0 unknown: more executables are prefetched in this direction. */
+	GHashTable* warmed_videos; /* Set of the resource ids of the videos already read in advance. */
+
+	GQueue* hydrated_executables; /* Executable* of `executables` with their details loaded,
+									 the most recently used first. */
 	int background; /* Index of the background in the textures cache */
 	int cover; /* Index of the cover in the textures cache. */
 	int logo; /* Index of the logo in the textures cache. */
@@ -69,7 +90,7 @@ typedef struct ExecutableListData {
 
 	ExecListVideo* exec_list_video;
 
-	GQueue* executable_widgets;
+	GPtrArray* executable_widgets; /* WidgetText* of the displayed executables. */
 } ExecutableListData;
 
 Screen* meh_exec_list_new(struct App* app, int platform_id);
@@ -79,5 +100,8 @@ void meh_exec_list_button_pressed(struct App* app, Screen* screen, int pressed_b
 int meh_exec_list_update(Screen* screen);;
 int meh_exec_list_render(struct App* app, Screen* screen, gboolean flip);
 ExecutableListData* meh_exec_list_get_data(Screen* screen);
+Executable* meh_exec_list_get_executable(ExecutableListData* data, int idx);
+void meh_exec_list_jump_to_executable(App* app, Screen* screen, int executable_id);
 void meh_exec_list_after_cursor_move(App* app, Screen* screen, int prev_selected_exec);
 void meh_exec_list_refresh_executables_widget(App* app, Screen* screen);
+void meh_exec_list_image_size(Window* window, int picked_index, int* width, int* height);
@@ -115,6 +115,14 @@ int meh_screen_fade_messages_handler(struct App* app, Screen* screen, Message* m
 				meh_screen_fade_update(app, screen);
 			}
 			break;
+		case MEH_MSG_DB_RESULT:
+			{
+				/* both screens could be waiting for a result */
+				FadeData* data = meh_screen_fade_get_data(screen);
+				meh_message_forward(app, data->src_screen, message);
+				meh_message_forward(app, data->dst_screen, message);
+			}
+			break;
 		case MEH_MSG_RENDER:
 			{
 				meh_screen_fade_render(app, screen);
@@ -134,6 +134,12 @@ int meh_main_popup_messages_handler(struct App* app, Screen* screen, Message* me
 				meh_main_popup_update(app, screen);
 			}
 			break;
+		case MEH_MSG_DB_RESULT:
+			{
+				MainPopupData* data = meh_main_popup_get_data(screen);
+				meh_message_forward(app, data->src_screen, message);
+			}
+			break;
 		case MEH_MSG_RENDER:
 			{
 				meh_main_popup_render(app, screen);
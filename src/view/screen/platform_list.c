@@ -8,18 +8,29 @@
 
 #include "system/app.h"
 #include "system/consts.h"
+#include "system/db_worker.h"
 #include "system/input.h"
 #include "system/message.h"
 #include "system/transition.h"
 #include "system/db/models.h"
+#include "view/image_loader.h"
+#include "view/texture_cache.h"
 #include "view/screen.h"
 #include "view/widget_text.h"
 #include "view/screen/executable_list.h"
 #include "view/screen/fade.h"
 #include "view/screen/platform_list.h"
+#include "view/screen/recent.h"
 #include "view/screen/main_popup.h"
 
 static void meh_screen_platform_change_platform(App* app, Screen* screen);
+static void meh_screen_platform_list_place_icons(Screen* screen);
+static SDL_Texture* meh_screen_platform_list_load_icon(App* app, Screen* screen, Platform* platform);
+static void meh_screen_platform_list_image_result(Screen* screen, ImageRequest* request);
+static void meh_screen_platform_list_free_icon(Screen* screen, Platform* platform, SDL_Texture* texture);
+static void meh_screen_platform_list_apply_changes(App* app, Screen* screen);
+static void meh_screen_platform_list_apply_platform(App* app, Screen* screen, int platform_id);
+static void meh_screen_platform_list_maintain(App* app);
 
 Screen* meh_screen_platform_list_new(App* app) {
 	Screen* screen = meh_screen_new(app->window);
@@ -30,10 +41,19 @@ Screen* meh_screen_platform_list_new(App* app) {
 
 	/* init the custom data. */
 	PlatformListData* data = g_new(PlatformListData, 1);	
-	data->platforms = meh_db_get_platforms(app->db);
+	data->catalog_change_id = app->catalog_change_id;
+	data->platforms = g_ptr_array_new();
+	GQueue* platforms = meh_db_get_platforms(app->db);
+	for (GList* it = platforms != NULL ? platforms->head : NULL; it != NULL; it = it->next) {
+		g_ptr_array_add(data->platforms, it->data);
+	}
+	if (platforms != NULL) {
+		g_queue_free(platforms);
+	}
 	data->selected_platform = 0;
 
 	data->background = NULL;
+	data->background_request = 0;
 	data->background_widget = meh_widget_image_new(NULL, 0, 0, MEH_FAKE_WIDTH, MEH_FAKE_HEIGHT);
 
 	/*
@@ -52,39 +72,23 @@ Screen* meh_screen_platform_list_new(App* app) {
 	data->no_platforms_widget = meh_widget_text_new(app->big_font, "No platforms configured", 150, 330, 500, 50, white, FALSE);
 
 	/* Platforms */
-	data->icons_widgets = g_queue_new();
-	data->platforms_icons = g_queue_new();
+	data->icons_widgets = g_ptr_array_new();
+	data->platforms_icons = g_ptr_array_new();
+	data->icon_requests = g_hash_table_new(NULL, NULL);
 
 	/* Load the data / icons / widgets of every platforms */
-	for (unsigned int i = 0; i < g_queue_get_length(data->platforms); i++) {
-		Platform* platform = g_queue_peek_nth(data->platforms, i);
+	for (unsigned int i = 0; i < data->platforms->len; i++) {
+		Platform* platform = g_ptr_array_index(data->platforms, i);
 
 		/* load the platform icon */
-		SDL_Texture* p_texture = NULL;
-		if (platform->icon == NULL || strlen(platform->icon) == 0) {
-			/* create a texture with just the text of the platform */
-			p_texture = meh_font_render_on_texture(
-							app->window->sdl_renderer,
-							app->small_font,
-							platform->name,
-							white,
-							TRUE
-						);
-		} else {
-			/* load the icon */
-			p_texture = meh_image_load_file(app->window->sdl_renderer, platform->icon);
-		}
-
-		if (p_texture == NULL) {
-			g_critical("Can't load the icon of the platform %s" ,platform->name);
-		}
+		SDL_Texture* p_texture = meh_screen_platform_list_load_icon(app, screen, platform);
 
 		/* store the texture */
-		g_queue_push_tail(data->platforms_icons, p_texture);
+		g_ptr_array_add(data->platforms_icons, p_texture);
 
 		/* create the platform widget */
 		WidgetImage* platform_widget = meh_widget_image_new(p_texture, 100, 285 + (i*200), 150, 150);
-		g_queue_push_tail(data->icons_widgets, platform_widget);
+		g_ptr_array_add(data->icons_widgets, platform_widget);
 	}
 
 	/* background hovers */
@@ -106,6 +110,148 @@ Screen* meh_screen_platform_list_new(App* app) {
 	return screen;
 }
 
+/*
+ * meh_screen_platform_list_load_icon returns the icon of the platform from the
+ * texture cache or requests its decoding, received in
+ * meh_screen_platform_list_image_result, and returns NULL.
+ * Without icon, creates and returns a texture with just its name.
+ * The icon must be freed with meh_screen_platform_list_free_icon.
+ */
+static SDL_Texture* meh_screen_platform_list_load_icon(App* app, Screen* screen, Platform* platform) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+	g_assert(platform != NULL);
+
+	PlatformListData* data = meh_screen_platform_list_get_data(screen);
+	SDL_Color white = { 255, 255, 255, 255 };
+
+	/* the previous icon of this platform isn't needed anymore. */
+	gpointer previous = g_hash_table_lookup(data->icon_requests, GINT_TO_POINTER(platform->id));
+	if (previous != NULL) {
+		meh_image_loader_cancel(app->window->image_loader, GPOINTER_TO_UINT(previous));
+		g_hash_table_remove(data->icon_requests, GINT_TO_POINTER(platform->id));
+	}
+
+	SDL_Texture* p_texture = NULL;
+	if (platform->icon == NULL || strlen(platform->icon) == 0) {
+		/* create a texture with just the text of the platform */
+		p_texture = meh_font_render_on_texture(
+						app->window->sdl_renderer,
+						app->small_font,
+						platform->name,
+						white,
+						TRUE
+					);
+	} else {
+		int width = 0, height = 0;
+		meh_screen_platform_list_icon_size(app->window, &width, &height);
+		if ((p_texture = meh_texture_cache_get(app->window->texture_cache, platform->icon, width, height)) == NULL) {
+			/* decode the icon in background */
+			guint request_id = meh_image_loader_load(app->window->image_loader, screen, platform->icon, platform->id,
+					MEH_IMAGE_PRIORITY_DISPLAY, width, height);
+			g_hash_table_insert(data->icon_requests, GINT_TO_POINTER(platform->id), GUINT_TO_POINTER(request_id));
+			return NULL;
+		}
+	}
+
+	if (p_texture == NULL) {
+		g_critical("Can't load the icon of the platform %s" ,platform->name);
+	}
+
+	return p_texture;
+}
+
+/*
+ * meh_screen_platform_list_icon_size returns in pixels
+ * the size at which the icons are displayed.
+ */
+void meh_screen_platform_list_icon_size(Window* window, int* width, int* height) {
+	g_assert(window != NULL);
+
+	*width = (int)meh_window_convert_width(window, 150);
+	*height = (int)meh_window_convert_height(window, 150);
+}
+
+/*
+ * meh_screen_platform_list_background_size returns in pixels
+ * the size at which the backgrounds are displayed.
+ */
+void meh_screen_platform_list_background_size(Window* window, int* width, int* height) {
+	g_assert(window != NULL);
+
+	*width = (int)meh_window_convert_width(window, MEH_FAKE_WIDTH);
+	*height = (int)meh_window_convert_height(window, MEH_FAKE_HEIGHT);
+}
+
+/*
+ * meh_screen_platform_list_image_result receives an image decoded in
+ * background: the icon of a platform or the background.
+ */
+static void meh_screen_platform_list_image_result(Screen* screen, ImageRequest* request) {
+	g_assert(screen != NULL);
+	g_assert(request != NULL);
+
+	PlatformListData* data = meh_screen_platform_list_get_data(screen);
+
+	if (request->id == data->background_request) {
+		data->background_request = 0;
+		meh_texture_cache_release(screen->window->texture_cache, data->background);
+		data->background = NULL;
+		if (request->texture != NULL) {
+			data->background = meh_texture_cache_add(screen->window->texture_cache, request->filename, request->width, request->height, request->texture);
+			request->texture = NULL;
+		}
+		data->background_widget->texture = data->background;
+		return;
+	}
+
+	/* the icon of a platform, tagged with its id. */
+	int platform_id = request->tag;
+	if (GPOINTER_TO_UINT(g_hash_table_lookup(data->icon_requests, GINT_TO_POINTER(platform_id))) != request->id) {
+		return;
+	}
+	g_hash_table_remove(data->icon_requests, GINT_TO_POINTER(platform_id));
+
+	if (request->texture == NULL) {
+		g_critical("Can't load the icon of the platform %d", platform_id);
+		return;
+	}
+
+	for (unsigned int i = 0; i < data->platforms->len; i++) {
+		Platform* platform = g_ptr_array_index(data->platforms, i);
+		if (platform->id != platform_id) {
+			continue;
+		}
+
+		SDL_Texture* texture = meh_texture_cache_add(screen->window->texture_cache, request->filename, request->width, request->height, request->texture);
+		request->texture = NULL;
+
+		WidgetImage* widget = g_ptr_array_index(data->icons_widgets, i);
+		g_ptr_array_index(data->platforms_icons, i) = texture;
+		widget->texture = texture;
+		break;
+	}
+}
+
+/*
+ * meh_screen_platform_list_free_icon frees the icon of the platform:
+ * its name rendered or the icon file, owned by the texture cache.
+ */
+static void meh_screen_platform_list_free_icon(Screen* screen, Platform* platform, SDL_Texture* texture) {
+	g_assert(screen != NULL);
+	g_assert(platform != NULL);
+
+	if (texture == NULL) {
+		return;
+	}
+
+	if (platform->icon == NULL || strlen(platform->icon) == 0) {
+		SDL_DestroyTexture(texture);
+	} else {
+		meh_texture_cache_release(screen->window->texture_cache, texture);
+	}
+}
+
 /*
  * meh_screen_platform_list_destroy_data role is to delete the typed data of the screen
  */
@@ -115,30 +261,33 @@ void meh_screen_platform_list_destroy_data(Screen* screen) {
 	PlatformListData* data = meh_screen_platform_list_get_data(screen);
 	if (data != NULL) {
 		/* free platforms icons texture */
-		for (unsigned int i = 0; i < g_queue_get_length(data->platforms_icons); i++) {
-			SDL_Texture* text = g_queue_peek_nth(data->platforms_icons, i);
-			SDL_DestroyTexture(text);
+		for (unsigned int i = 0; i < data->platforms_icons->len; i++) {
+			meh_screen_platform_list_free_icon(screen, g_ptr_array_index(data->platforms, i),
+					g_ptr_array_index(data->platforms_icons, i));
 		}
-		g_queue_free(data->platforms_icons);
+		g_ptr_array_free(data->platforms_icons, TRUE);
+		/* the images still decoding have been cancelled with the screen. */
+		g_hash_table_destroy(data->icon_requests);
 
 		/* free platforms widget */
-		for (unsigned int i = 0; i < g_queue_get_length(data->icons_widgets); i++) {
-			WidgetImage* widget = g_queue_peek_nth(data->icons_widgets, i);
+		for (unsigned int i = 0; i < data->icons_widgets->len; i++) {
+			WidgetImage* widget = g_ptr_array_index(data->icons_widgets, i);
 			meh_widget_image_destroy(widget);
 		}
-		g_queue_free(data->icons_widgets);
+		g_ptr_array_free(data->icons_widgets, TRUE);
 
 		/* free platform models */
-		meh_model_platforms_destroy(data->platforms);
+		for (unsigned int i = 0; i < data->platforms->len; i++) {
+			meh_model_platform_destroy(g_ptr_array_index(data->platforms, i));
+		}
+		g_ptr_array_free(data->platforms, TRUE);
 
 		/* various widgets */
 		meh_widget_text_destroy(data->title);
 		meh_widget_text_destroy(data->no_platforms_widget);
 
 		/* background */
-		if (data->background != NULL) {
-			SDL_DestroyTexture(data->background);
-		}
+		meh_texture_cache_release(screen->window->texture_cache, data->background);
 		meh_widget_image_destroy(data->background_widget);
 
 		meh_widget_rect_destroy(data->background_hover);
@@ -174,8 +323,17 @@ int meh_screen_platform_list_messages_handler(App* app, Screen* screen, Message*
 		case MEH_MSG_UPDATE:
 			{
 				meh_screen_platform_list_update(screen);
+				meh_screen_platform_list_apply_changes(app, screen);
+				meh_screen_platform_list_maintain(app);
 			}
 			break;
+		case MEH_MSG_IMAGE_RESULT:
+			{
+				ImageRequest* request = (ImageRequest*)message->data;
+				meh_screen_platform_list_image_result(screen, request);
+			}
+			break;
+
 		case MEH_MSG_RENDER:
 			{
 				if (message->data == NULL) {
@@ -202,13 +360,25 @@ static void meh_screen_platform_list_start_popup(App* app, Screen* screen) {
 	 * will go back to it later. */
 }
 
+static void meh_screen_platform_list_start_recent(App* app, Screen* screen) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	/* create the child screen */
+	Screen* recent_screen = meh_screen_recent_new(app, screen);
+	meh_app_set_current_screen(app, recent_screen, TRUE);
+	/* NOTE we don't free the memory of the current screen, the recently
+	 * played screen will go back to it later. */
+}
+
 static void meh_screen_platform_list_start_platform(App* app, Screen* screen) {
 	g_assert(app != NULL);
 	g_assert(screen != NULL);
 
 	/* get the platform */
 	PlatformListData* data = meh_screen_platform_list_get_data(screen);
-	Platform* platform = g_queue_peek_nth(data->platforms, data->selected_platform);
+	Platform* platform = data->selected_platform < data->platforms->len ?
+		g_ptr_array_index(data->platforms, data->selected_platform) : NULL;
 
 	if (platform != NULL) {
 		/* create the child screen */
@@ -238,6 +408,9 @@ void meh_screen_platform_list_button_pressed(App* app, Screen* screen, int press
 		case MEH_INPUT_BUTTON_START:
 			meh_screen_platform_list_start_popup(app, screen);
 			break;
+		case MEH_INPUT_BUTTON_SELECT:
+			meh_screen_platform_list_start_recent(app, screen);
+			break;
 		case MEH_INPUT_BUTTON_A:
 			meh_screen_platform_list_start_platform(app, screen);
 			break;
@@ -251,14 +424,14 @@ void meh_screen_platform_list_button_pressed(App* app, Screen* screen, int press
 			break;
 		case MEH_INPUT_BUTTON_UP:
 			if (data->selected_platform == 0) {
-				data->selected_platform = g_queue_get_length(meh_screen_platform_list_get_data(screen)->platforms)-1;
+				data->selected_platform = data->platforms->len-1;
 			} else {
 				data->selected_platform -= 1;
 			}
 			meh_screen_platform_change_platform(app, screen);
 			break;
 		case MEH_INPUT_BUTTON_DOWN:
-			if (data->selected_platform == g_queue_get_length(meh_screen_platform_list_get_data(screen)->platforms)-1) {
+			if (data->selected_platform == data->platforms->len-1) {
 				data->selected_platform = 0;
 			} else {
 				data->selected_platform += 1;
@@ -273,15 +446,67 @@ static void meh_screen_platform_change_platform(App* app, Screen* screen) {
 
 	PlatformListData* data = meh_screen_platform_list_get_data(screen);
 
-	if (g_queue_get_length(data->platforms) == 0) {
+	if (data->platforms->len == 0) {
 		return;
 	}
 
-	Platform* platform = g_queue_peek_nth(data->platforms, data->selected_platform);
+	Platform* platform = g_ptr_array_index(data->platforms, data->selected_platform);
 	g_assert(platform != NULL);
 
 	/* animate icons */
-	for (unsigned int i = 0; i < g_queue_get_length(data->icons_widgets); i++) {
+	meh_screen_platform_list_place_icons(screen);
+
+	/* platform name */
+	data->platform_name->text = platform->name;
+	meh_widget_text_reload(app->window, data->platform_name);
+	data->platform_name->x = meh_transition_start(MEH_TRANSITION_CUBIC, MEH_FAKE_WIDTH+200, 320, 300);
+	meh_screen_add_text_transitions(screen, data->platform_name);
+
+	/* executables count, maintained in the DB. */
+	int count_exec = platform->executables_count;
+	g_free(data->executables_count->text);
+	data->executables_count->text = g_strdup_printf("%d executable%s", count_exec, count_exec > 1 ? "s": "");
+	meh_widget_text_reload(app->window, data->executables_count);
+	data->executables_count->x = meh_transition_start(MEH_TRANSITION_CUBIC, MEH_FAKE_WIDTH+200, 325, 550);
+	meh_screen_add_text_transitions(screen, data->executables_count);
+
+	/* background image, from the texture cache or decoded in
+	 * background: the last one stays displayed until it's received. */
+	if (platform->background != NULL) {
+		if (data->background_request != 0) {
+			meh_image_loader_cancel(app->window->image_loader, data->background_request);
+			data->background_request = 0;
+		}
+
+		SDL_Texture* background = NULL;
+		if (strlen(platform->background) != 0) {
+			int width = 0, height = 0;
+			meh_screen_platform_list_background_size(app->window, &width, &height);
+			background = meh_texture_cache_get(app->window->texture_cache, platform->background, width, height);
+			if (background == NULL) {
+				data->background_request = meh_image_loader_load(app->window->image_loader, screen, platform->background, platform->id,
+						MEH_IMAGE_PRIORITY_DISPLAY, width, height);
+			}
+		}
+
+		if (data->background_request == 0) {
+			meh_texture_cache_release(app->window->texture_cache, data->background);
+			data->background = background;
+			data->background_widget->texture = background;
+		}
+	}
+}
+
+/*
+ * meh_screen_platform_list_place_icons moves the icons of the
+ * platforms around the selected one.
+ */
+static void meh_screen_platform_list_place_icons(Screen* screen) {
+	g_assert(screen != NULL);
+
+	PlatformListData* data = meh_screen_platform_list_get_data(screen);
+
+	for (unsigned int i = 0; i < data->icons_widgets->len; i++) {
 		int y = 285;
 		if (i < data->selected_platform) {
 			y += (i - data->selected_platform) * 200;
@@ -289,37 +514,212 @@ static void meh_screen_platform_change_platform(App* app, Screen* screen) {
 			y -= (data->selected_platform - i) * 200;
 		}
 
-		WidgetImage* image = g_queue_peek_nth(data->icons_widgets, i);
+		WidgetImage* image = g_ptr_array_index(data->icons_widgets, i);
 		image->y = meh_transition_start(MEH_TRANSITION_CUBIC, image->y.value, y, 200);
 		meh_screen_add_image_transitions(screen, image);
+	}
+}
 
+/*
+ * meh_screen_platform_list_apply_changes applies to the list the
+ * changes of the platforms done in the database since the last ones
+ * applied, keeping the selected platform.
+ */
+static void meh_screen_platform_list_apply_changes(App* app, Screen* screen) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	PlatformListData* data = meh_screen_platform_list_get_data(screen);
+
+	if (data->catalog_change_id == app->catalog_change_id) {
+		return;
 	}
 
-	/* platform name */
-	data->platform_name->text = platform->name;
+	Platform* selected = data->selected_platform < data->platforms->len ?
+		g_ptr_array_index(data->platforms, data->selected_platform) : NULL;
+	int selected_id = selected != NULL ? selected->id : -1;
+
+	/* ids of the changed platforms */
+	GHashTable* changed = g_hash_table_new(NULL, NULL);
+
+	GQueue* changes = meh_db_get_catalog_changes(app->db, data->catalog_change_id);
+	if (changes != NULL) {
+		for (GList* it = changes->head; it != NULL; it = it->next) {
+			CatalogChange* change = it->data;
+			if (change->kind == MEH_CATALOG_CHANGE_PLATFORM) {
+				g_hash_table_add(changed, GINT_TO_POINTER(change->platform_id));
+			}
+		}
+		g_queue_free_full(changes, g_free);
+	} else {
+		/* some changes are unknown, every platform is read again. */
+		g_debug("Reading again every platform.");
+		GQueue* platforms = meh_db_get_platforms(app->db);
+		for (GList* it = platforms != NULL ? platforms->head : NULL; it != NULL; it = it->next) {
+			Platform* platform = it->data;
+			g_hash_table_add(changed, GINT_TO_POINTER(platform->id));
+		}
+		if (platforms != NULL) {
+			meh_model_platforms_destroy(platforms);
+		}
+		for (unsigned int i = 0; i < data->platforms->len; i++) {
+			Platform* platform = g_ptr_array_index(data->platforms, i);
+			g_hash_table_add(changed, GINT_TO_POINTER(platform->id));
+		}
+	}
+
+	data->catalog_change_id = app->catalog_change_id;
+
+	if (g_hash_table_size(changed) == 0) {
+		g_hash_table_destroy(changed);
+		return;
+	}
+
+	GHashTableIter iter;
+	gpointer key;
+	g_hash_table_iter_init(&iter, changed);
+	while (g_hash_table_iter_next(&iter, &key, NULL)) {
+		meh_screen_platform_list_apply_platform(app, screen, GPOINTER_TO_INT(key));
+	}
+
+	g_hash_table_destroy(changed);
+
+	/* select again the same platform, the closest one if it has been deleted. */
+	unsigned int length = data->platforms->len;
+	unsigned int previous = data->selected_platform;
+
+	for (unsigned int i = 0; i < length; i++) {
+		Platform* platform = g_ptr_array_index(data->platforms, i);
+		if (platform->id == selected_id) {
+			data->selected_platform = i;
+		}
+	}
+
+	if (data->selected_platform >= length) {
+		data->selected_platform = length > 0 ? length - 1 : 0;
+	}
+
+	if (length == 0) {
+		/* the name of the platform widget was the one of a deleted platform. */
+		data->platform_name->text = "";
+		meh_widget_text_reload(app->window, data->platform_name);
+		g_free(data->executables_count->text);
+		data->executables_count->text = g_strdup("");
+		meh_widget_text_reload(app->window, data->executables_count);
+		return;
+	}
+
+	selected = g_ptr_array_index(data->platforms, data->selected_platform);
+	if (selected->id != selected_id || data->selected_platform != previous) {
+		meh_screen_platform_change_platform(app, screen);
+		return;
+	}
+
+	/* same platform: only refresh its texts, without animation. */
+	meh_screen_platform_list_place_icons(screen);
+
+	data->platform_name->text = selected->name;
 	meh_widget_text_reload(app->window, data->platform_name);
-	data->platform_name->x = meh_transition_start(MEH_TRANSITION_CUBIC, MEH_FAKE_WIDTH+200, 320, 300);
-	meh_screen_add_text_transitions(screen, data->platform_name);
 
-	/* executables count */
-	int count_exec = meh_db_count_platform_executables(app->db, platform);
+	int count_exec = selected->executables_count;
 	g_free(data->executables_count->text);
 	data->executables_count->text = g_strdup_printf("%d executable%s", count_exec, count_exec > 1 ? "s": "");
 	meh_widget_text_reload(app->window, data->executables_count);
-	data->executables_count->x = meh_transition_start(MEH_TRANSITION_CUBIC, MEH_FAKE_WIDTH+200, 325, 550);
-	meh_screen_add_text_transitions(screen, data->executables_count);
+}
 
-	/* background image */
-	if (platform->background != NULL) {
-		/* start by destroying the last one if any */
-		if (data->background != NULL) {
-			SDL_DestroyTexture(data->background);
+/*
+ * meh_screen_platform_list_apply_platform reads again the given platform
+ * and inserts, replaces or removes it in the list, ordered by name.
+ * Its icon is loaded again only if it has changed.
+ */
+static void meh_screen_platform_list_apply_platform(App* app, Screen* screen, int platform_id) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	PlatformListData* data = meh_screen_platform_list_get_data(screen);
+
+	Platform* platform = meh_db_get_platform(app->db, platform_id);
+
+	SDL_Texture* texture = NULL;
+	WidgetImage* widget = NULL;
+
+	/* remove the current version */
+	for (unsigned int i = 0; i < data->platforms->len; i++) {
+		Platform* old = g_ptr_array_index(data->platforms, i);
+		if (old->id != platform_id) {
+			continue;
+		}
+
+		texture = g_ptr_array_remove_index(data->platforms_icons, i);
+		widget = g_ptr_array_remove_index(data->icons_widgets, i);
+		g_ptr_array_remove_index(data->platforms, i);
+
+		/* without icon, the texture is the name of the platform. */
+		gboolean same_icon = platform != NULL && g_strcmp0(old->icon, platform->icon) == 0 &&
+			((old->icon != NULL && strlen(old->icon) > 0) || g_strcmp0(old->name, platform->name) == 0);
+
+		if (!same_icon) {
+			meh_screen_platform_list_free_icon(screen, old, texture);
+		}
+
+		if (platform == NULL) {
+			meh_widget_image_destroy(widget);
+			gpointer request = g_hash_table_lookup(data->icon_requests, GINT_TO_POINTER(platform_id));
+			if (request != NULL) {
+				meh_image_loader_cancel(app->window->image_loader, GPOINTER_TO_UINT(request));
+				g_hash_table_remove(data->icon_requests, GINT_TO_POINTER(platform_id));
+			}
+		} else if (!same_icon) {
+			texture = meh_screen_platform_list_load_icon(app, screen, platform);
+			widget->texture = texture;
 		}
-		if (platform->background != NULL && strlen(platform->background) != 0) {
-			data->background = meh_image_load_file(app->window->sdl_renderer, platform->background);
-			data->background_widget->texture = data->background;
+
+		meh_model_platform_destroy(old);
+		break;
+	}
+
+	if (platform == NULL) {
+		return;
+	}
+
+	/* a new one */
+	if (widget == NULL) {
+		texture = meh_screen_platform_list_load_icon(app, screen, platform);
+		widget = meh_widget_image_new(texture, 100, MEH_FAKE_HEIGHT, 150, 150);
+	}
+
+	/* the platforms are ordered by name */
+	unsigned int position = 0;
+	while (position < data->platforms->len) {
+		Platform* other = g_ptr_array_index(data->platforms, position);
+		if (g_strcmp0(platform->name, other->name) < 0) {
+			break;
 		}
+		position++;
+	}
+
+	g_ptr_array_insert(data->platforms, position, platform);
+	g_ptr_array_insert(data->platforms_icons, position, texture);
+	g_ptr_array_insert(data->icons_widgets, position, widget);
+}
+
+/*
+ * meh_screen_platform_list_maintain runs the maintenance of the database,
+ * one step at a time, once nobody has used mehstation for a while.
+ */
+static void meh_screen_platform_list_maintain(App* app) {
+	g_assert(app != NULL);
+
+	int idle = app->settings.db_maintenance_idle;
+	if (idle <= 0 || app->db_worker == NULL || app->db->read_only) {
+		return;
+	}
+
+	if (SDL_GetTicks() - app->mainloop.last_input < (guint32)idle * 60 * 1000) {
+		return;
 	}
+
+	meh_db_worker_maintain(app->db_worker);
 }
 
 int meh_screen_platform_list_update(Screen* screen) {
@@ -342,7 +742,7 @@ int meh_screen_platform_list_render(App* app, Screen* screen, gboolean flip) {
 	g_assert(data != NULL);
 
 	SDL_Color black = { 0, 0, 0 };
-	int platform_count = g_queue_get_length(data->platforms);
+	int platform_count = data->platforms->len;
 
 	/* clear the screen */
 	meh_window_clear(app->window, black);
@@ -366,8 +766,8 @@ int meh_screen_platform_list_render(App* app, Screen* screen, gboolean flip) {
 	}
 
 	/* icon */
-	for (unsigned int i = 0; i < g_queue_get_length(data->icons_widgets); i++) {
-		WidgetImage* widget = g_queue_peek_nth(data->icons_widgets, i);
+	for (unsigned int i = 0; i < data->icons_widgets->len; i++) {
+		WidgetImage* widget = g_ptr_array_index(data->icons_widgets, i);
 		meh_widget_image_render(app->window, widget);
 	}
 	
@@ -12,8 +12,9 @@
 struct App;
 
 typedef struct PlatformListData {
-	GQueue* platforms;
+	GPtrArray* platforms; /* Array of Platform*, ordered by name, must be freed */
 	unsigned int selected_platform;
+	gint64 catalog_change_id; /* last change of the catalog applied to the list. */
 
 	/*
 	 * Widgets
@@ -22,6 +23,7 @@ typedef struct PlatformListData {
 	WidgetText* title;
 
 	SDL_Texture* background;
+	guint background_request; /* id of the image loader request decoding the next background, 0 if none. */
 	WidgetImage* background_widget;
 
 	WidgetRect* background_hover;
@@ -29,8 +31,9 @@ typedef struct PlatformListData {
 	WidgetText* platform_name;
 	WidgetText* executables_count;
 
-	GQueue* platforms_icons; /* Queue of SDL_Texture*, memory must be freed */
-	GQueue* icons_widgets; /* List of WidgetImage*, memory must be freed */
+	GPtrArray* platforms_icons; /* Array of SDL_Texture*, memory must be freed, NULL while decoding */
+	GHashTable* icon_requests; /* Hash platform id -> id of the image loader request decoding its icon. */
+	GPtrArray* icons_widgets; /* Array of WidgetImage*, memory must be freed */
 } PlatformListData;
 
 Screen* meh_screen_platform_list_new(struct App* app);
@@ -40,3 +43,5 @@ void meh_screen_platform_list_button_pressed(struct App* app, Screen* screen, in
 int meh_screen_platform_list_update(Screen* screen);
 int meh_screen_platform_list_render(struct App* app, Screen* screen, gboolean flip);
 PlatformListData* meh_screen_platform_list_get_data(Screen* screen);
+void meh_screen_platform_list_icon_size(Window* window, int* width, int* height);
+void meh_screen_platform_list_background_size(Window* window, int* width, int* height);
@@ -6,6 +6,7 @@
 
 #include "system/app.h"
 #include "system/consts.h"
+#include "system/db_worker.h"
 #include "view/screen.h"
 #include "view/widget_rect.h"
 #include "view/screen/popup.h"
@@ -160,75 +161,13 @@ static void meh_screen_popup_favorite_toggle(App* app, Screen* screen) {
 	g_assert(screen != NULL);
 
 	PopupData* data = meh_screen_popup_get_data(screen);
-	ExecutableListData* exec_list_data = meh_exec_list_get_data(data->src_screen);
 
-	/* updates the value of the executable */
+	/* updates the value of the executable, the DB worker writes it
+	 * and the executables list re-positions the executable when
+	 * receiving the result. */
 
 	gboolean new_value = data->executable->favorite == 1 ? FALSE : TRUE;
-
-	if (meh_db_set_executable_favorite(app->db, data->executable, new_value)) {
-		data->executable->favorite = new_value;
-	}
-
-	/* re-position the executable in the executables list if necessary */
-	if (g_queue_get_length(exec_list_data->executables) > 1) {
-		int prev_selected = exec_list_data->selected_executable;
-
-		unsigned int i = 0;
-
-		/* retrieves the one which will move in the list */
-		Executable* to_move = g_queue_pop_nth(exec_list_data->executables, exec_list_data->selected_executable);
-
-		/* find the good position for the moved executable */
-
-		for (i = 0; i < g_queue_get_length(exec_list_data->executables); i++) {
-			gboolean exit = FALSE;
-			Executable* ex = g_queue_peek_nth(exec_list_data->executables, i);
-			/* if favorite, ensure to stay in the favorite zone */
-			if (new_value == TRUE) {
-				if (ex->favorite == FALSE)  {
-					exit = TRUE;
-				}
-			}
-
-			gchar* first = g_utf8_strup(ex->display_name, g_utf8_strlen(ex->display_name, -1));
-			gchar* second = g_utf8_strup(data->executable->display_name, g_utf8_strlen(ex->display_name, -1));
-
-			if (g_utf8_collate(first, second) > 0) {
-				if (new_value == TRUE && ex->favorite == TRUE) {
-					exit = TRUE;
-				}
-				else if (new_value == FALSE && ex->favorite == FALSE) {
-					exit = TRUE;
-				}
-			}
-
-			g_free(first);
-			g_free(second);
-
-			if (exit) {
-				break;
-			}
-		}
-
-		GList* after = g_queue_peek_nth_link(exec_list_data->executables, i);
-
-		/* re-add it to the good position */
-
-		g_queue_insert_before(exec_list_data->executables, after, to_move);
-
-		/* notify the screen of the new selected executable */
-
-		exec_list_data->selected_executable = i;
-
-		/* redraw the executables list texts */
-
-		meh_exec_list_refresh_executables_widget(app, data->src_screen);
-
-		/* move and redraw the selection */
-
-		meh_exec_list_after_cursor_move(app, data->src_screen, prev_selected);
-	}
+	meh_db_worker_set_executable_favorite(app->db_worker, data->executable->id, new_value);
 
 	/* finally close the popup */
 
@@ -264,6 +203,13 @@ int meh_screen_popup_messages_handler(struct App* app, Screen* screen, Message*
 				meh_screen_popup_update(app, screen);
 			}
 			break;
+		case MEH_MSG_DB_RESULT:
+			{
+				/* the executables list is waiting for the results */
+				PopupData* data = meh_screen_popup_get_data(screen);
+				meh_message_forward(app, data->src_screen, message);
+			}
+			break;
 		case MEH_MSG_RENDER:
 			{
 				meh_screen_popup_render(app, screen);
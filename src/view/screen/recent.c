@@ -0,0 +1,344 @@
+/*
+ * mehstation - Recently played executables of every platform.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ *
+ * The list is loaded by the DB worker, and loaded again when coming
+ * back from a launch: the launched executable is now the first one.
+ */
+
+#include "system/app.h"
+#include "system/consts.h"
+#include "system/db_worker.h"
+#include "system/input.h"
+#include "system/db/models.h"
+#include "view/screen.h"
+#include "view/widget_rect.h"
+#include "view/widget_text.h"
+#include "view/screen/launch.h"
+#include "view/screen/recent.h"
+
+static void meh_screen_recent_button_pressed(App* app, Screen* screen, int pressed_button);
+static void meh_screen_recent_results(App* app, Screen* screen, DBRequest* request);
+static void meh_screen_recent_launch(App* app, Screen* screen);
+static Platform* meh_screen_recent_get_platform(RecentData* data, int platform_id);
+static void meh_screen_recent_move_selection(Screen* screen);
+static void meh_screen_recent_close(App* app, Screen* screen);
+
+#define MEH_RECENT_X 70
+#define MEH_RECENT_Y 110
+#define MEH_RECENT_HEIGHT 40
+
+Screen* meh_screen_recent_new(App* app, Screen* src_screen) {
+	g_assert(app != NULL);
+	g_assert(src_screen != NULL);
+
+	Screen* screen = meh_screen_new(app->window);
+
+	screen->name = g_strdup("Recently played screen");
+	screen->messages_handler = &meh_screen_recent_messages_handler;
+	screen->destroy_data = &meh_screen_recent_destroy_data;
+
+	/*
+	 * Custom data
+	 */
+	RecentData* data = g_new(RecentData, 1);
+
+	data->src_screen = src_screen;
+	data->platforms = meh_db_get_platforms(app->db);
+	data->executables = g_queue_new();
+	data->selected_executable = 0;
+
+	SDL_Color white = { 255, 255, 255, 255 };
+	SDL_Color gray_text = { 180, 180, 180, 255 };
+	SDL_Color black = { 0, 0, 0, 150 };
+	SDL_Color gray = { 15, 15, 15, 120 };
+	SDL_Color light_gray = { 90, 90, 90, 220 };
+	SDL_Color very_light_gray = { 40, 40, 40, 220 };
+
+	data->hover_widget = meh_widget_rect_new(0, 0, MEH_FAKE_WIDTH, MEH_FAKE_HEIGHT, black, TRUE);
+	data->background_widget = meh_widget_rect_new(40, 40, MEH_FAKE_WIDTH-80, MEH_FAKE_HEIGHT-80, very_light_gray, TRUE);
+
+	/* Title */
+	data->title_widget = meh_widget_text_new(app->small_bold_font, "RECENTLY PLAYED", 50, 45, 500, 40, white, TRUE);
+	data->title_bg_widget = meh_widget_rect_new(40, 40, MEH_FAKE_WIDTH-80, 45, gray, TRUE);
+
+	/* Executables */
+	data->selection_widget = meh_widget_rect_new(MEH_RECENT_X-10, MEH_RECENT_Y, MEH_FAKE_WIDTH-140, MEH_RECENT_HEIGHT-4, light_gray, TRUE);
+	for (int i = 0; i < MEH_RECENT_MAX_RESULTS; i++) {
+		int y = MEH_RECENT_Y + i*MEH_RECENT_HEIGHT + 3;
+		data->executables_widgets[i] = meh_widget_text_new(app->small_font, "", MEH_RECENT_X, y, 760, 30, white, TRUE);
+		data->platforms_widgets[i] = meh_widget_text_new(app->small_font, "", MEH_RECENT_X+800, y, 330, 30, gray_text, TRUE);
+	}
+
+	data->empty_widget = meh_widget_text_new(app->small_font, "Nothing has been played yet.", MEH_RECENT_X, MEH_RECENT_Y+3, 760, 30, white, TRUE);
+	data->help_widget = meh_widget_text_new(app->small_font, "A: launch   B: back",
+											MEH_RECENT_X, MEH_FAKE_HEIGHT-90, MEH_FAKE_WIDTH-140, 30, white, TRUE);
+
+	data->load_request = meh_db_worker_get_recent_executables(app->db_worker, MEH_RECENT_MAX_RESULTS);
+
+	screen->data = data;
+
+	return screen;
+}
+
+/*
+ * meh_screen_recent_destroy_data destroys the additional data
+ * of the recently played screen.
+ */
+void meh_screen_recent_destroy_data(Screen* screen) {
+	RecentData* data = meh_screen_recent_get_data(screen);
+	if (data == NULL) {
+		return;
+	}
+
+	meh_widget_rect_destroy(data->hover_widget);
+	meh_widget_rect_destroy(data->background_widget);
+	meh_widget_text_destroy(data->title_widget);
+	meh_widget_rect_destroy(data->title_bg_widget);
+	meh_widget_text_destroy(data->empty_widget);
+	meh_widget_text_destroy(data->help_widget);
+	meh_widget_rect_destroy(data->selection_widget);
+	for (int i = 0; i < MEH_RECENT_MAX_RESULTS; i++) {
+		meh_widget_text_destroy(data->executables_widgets[i]);
+		meh_widget_text_destroy(data->platforms_widgets[i]);
+	}
+
+	meh_model_executables_destroy(data->executables);
+	meh_model_platforms_destroy(data->platforms);
+
+	g_free(data);
+	screen->data = NULL;
+}
+
+RecentData* meh_screen_recent_get_data(Screen* screen) {
+	g_assert(screen != NULL);
+	if (screen->data == NULL) {
+		return NULL;
+	}
+	return (RecentData*) screen->data;
+}
+
+int meh_screen_recent_messages_handler(struct App* app, Screen* screen, Message* message) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	if (message == NULL) {
+		return 1;
+	}
+
+	switch (message->id) {
+		case MEH_MSG_BUTTON_PRESSED:
+			{
+				InputMessageData* data = (InputMessageData*)message->data;
+				meh_screen_recent_button_pressed(app, screen, data->button);
+			}
+			break;
+		case MEH_MSG_UPDATE:
+			{
+				meh_screen_recent_update(app, screen);
+			}
+			break;
+		case MEH_MSG_DB_RESULT:
+			{
+				DBRequest* request = (DBRequest*)message->data;
+				RecentData* data = meh_screen_recent_get_data(screen);
+				if (request->type == MEH_DB_REQUEST_GET_RECENT_EXECUTABLES) {
+					meh_screen_recent_results(app, screen, request);
+				} else if (request->type == MEH_DB_REQUEST_RECORD_LAUNCH) {
+					/* back from a launch, the order has changed. */
+					data->load_request = meh_db_worker_get_recent_executables(app->db_worker, MEH_RECENT_MAX_RESULTS);
+				} else {
+					/* not for this list, maybe for the platforms list. */
+					meh_message_forward(app, data->src_screen, message);
+				}
+			}
+			break;
+		case MEH_MSG_RENDER:
+			{
+				meh_screen_recent_render(app, screen);
+			}
+			break;
+	}
+
+	return 0;
+}
+
+/*
+ * meh_screen_recent_button_pressed is called when we received a button pressed
+ * message.
+ */
+static void meh_screen_recent_button_pressed(App* app, Screen* screen, int pressed_button) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	RecentData* data = meh_screen_recent_get_data(screen);
+
+	switch (pressed_button) {
+		case MEH_INPUT_BUTTON_UP:
+			if (data->selected_executable > 0) {
+				data->selected_executable -= 1;
+			}
+			break;
+		case MEH_INPUT_BUTTON_DOWN:
+			if (data->selected_executable + 1 < (int)g_queue_get_length(data->executables)) {
+				data->selected_executable += 1;
+			}
+			break;
+		case MEH_INPUT_BUTTON_A:
+		case MEH_INPUT_BUTTON_START:
+			meh_screen_recent_launch(app, screen);
+			return;
+		case MEH_INPUT_BUTTON_B:
+		case MEH_INPUT_BUTTON_SELECT:
+		case MEH_INPUT_SPECIAL_ESCAPE:
+			meh_screen_recent_close(app, screen);
+			return;
+	}
+
+	meh_screen_recent_move_selection(screen);
+}
+
+/*
+ * meh_screen_recent_results displays the last played executables.
+ */
+static void meh_screen_recent_results(App* app, Screen* screen, DBRequest* request) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+	g_assert(request != NULL);
+
+	RecentData* data = meh_screen_recent_get_data(screen);
+
+	if (request->id != data->load_request || request->executables == NULL) {
+		return;
+	}
+	data->load_request = 0;
+
+	/* take the ownership of the results */
+	meh_model_executables_destroy(data->executables);
+	data->executables = request->executables;
+	request->executables = NULL;
+
+	for (int i = 0; i < MEH_RECENT_MAX_RESULTS; i++) {
+		Executable* executable = g_queue_peek_nth(data->executables, i);
+		Platform* platform = executable != NULL ? meh_screen_recent_get_platform(data, executable->platform_id) : NULL;
+
+		g_free(data->executables_widgets[i]->text);
+		data->executables_widgets[i]->text = g_strdup(executable != NULL ? executable->display_name : "");
+		meh_widget_text_reload(app->window, data->executables_widgets[i]);
+
+		g_free(data->platforms_widgets[i]->text);
+		data->platforms_widgets[i]->text = g_strdup(platform != NULL ? platform->name : "");
+		meh_widget_text_reload(app->window, data->platforms_widgets[i]);
+	}
+
+	data->selected_executable = 0;
+	meh_screen_recent_move_selection(screen);
+}
+
+/*
+ * meh_screen_recent_launch launches the selected executable,
+ * this screen is displayed again after the launch.
+ */
+static void meh_screen_recent_launch(App* app, Screen* screen) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	RecentData* data = meh_screen_recent_get_data(screen);
+
+	Executable* executable = g_queue_peek_nth(data->executables, data->selected_executable);
+	if (executable == NULL) {
+		return;
+	}
+
+	Platform* platform = meh_screen_recent_get_platform(data, executable->platform_id);
+	if (platform == NULL || !meh_db_hydrate_executable(app->db, executable)) {
+		return;
+	}
+
+	Screen* launch_screen = meh_screen_launch_new(app, screen, platform, executable, NULL);
+	meh_app_set_current_screen(app, launch_screen, TRUE);
+}
+
+static Platform* meh_screen_recent_get_platform(RecentData* data, int platform_id) {
+	g_assert(data != NULL);
+
+	for (GList* l = data->platforms->head; l != NULL; l = l->next) {
+		Platform* platform = l->data;
+		if (platform->id == platform_id) {
+			return platform;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * meh_screen_recent_move_selection moves the selection
+ * widget on the selected executable.
+ */
+static void meh_screen_recent_move_selection(Screen* screen) {
+	g_assert(screen != NULL);
+
+	RecentData* data = meh_screen_recent_get_data(screen);
+	data->selection_widget->y.value = MEH_RECENT_Y + data->selected_executable * MEH_RECENT_HEIGHT;
+}
+
+/*
+ * meh_screen_recent_close goes back to the platforms list.
+ */
+static void meh_screen_recent_close(App* app, Screen* screen) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	RecentData* data = meh_screen_recent_get_data(screen);
+
+	meh_app_set_current_screen(app, data->src_screen, TRUE);
+	meh_screen_destroy(screen);
+}
+
+/*
+ * meh_screen_recent_update updates the recently played screen and
+ * the platforms list behind it.
+ */
+int meh_screen_recent_update(struct App* app, Screen* screen) {
+	meh_screen_update_transitions(screen);
+
+	RecentData* data = meh_screen_recent_get_data(screen);
+	meh_message_send(app, data->src_screen, MEH_MSG_UPDATE, NULL);
+
+	return 0;
+}
+
+void meh_screen_recent_render(struct App* app, Screen* screen) {
+	RecentData* data = meh_screen_recent_get_data(screen);
+	g_assert(data != NULL);
+
+	/* render the background screen */
+	gboolean* flip = g_new(gboolean, 1);
+	*flip = FALSE;
+	meh_message_send(app, data->src_screen, MEH_MSG_RENDER, flip);
+
+	/* render the recently played screen */
+
+	meh_widget_rect_render(app->window, data->hover_widget);
+	meh_widget_rect_render(app->window, data->background_widget);
+
+	meh_widget_rect_render(app->window, data->title_bg_widget);
+	meh_widget_text_render(app->window, data->title_widget);
+
+	int executables = g_queue_get_length(data->executables);
+	if (executables > 0) {
+		meh_widget_rect_render(app->window, data->selection_widget);
+	} else if (data->load_request == 0) {
+		meh_widget_text_render(app->window, data->empty_widget);
+	}
+	for (int i = 0; i < executables && i < MEH_RECENT_MAX_RESULTS; i++) {
+		meh_widget_text_render(app->window, data->executables_widgets[i]);
+		meh_widget_text_render(app->window, data->platforms_widgets[i]);
+	}
+
+	meh_widget_text_render(app->window, data->help_widget);
+
+	meh_window_render(app->window);
+}
@@ -0,0 +1,50 @@
+/*
+ * mehstation - Recently played executables of every platform.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include "view/screen.h"
+#include "view/widget_rect.h"
+#include "view/widget_text.h"
+
+struct App;
+
+#define MEH_RECENT_MAX_RESULTS (12)
+
+typedef struct {
+	/* upon which screen the list is appearing: the platforms list. */
+	Screen* src_screen;
+
+	GQueue* platforms; /* List of Platform*, to name and launch the executables, must be freed. */
+
+	guint load_request; /* id of the last DB worker load, 0 if none. */
+	GQueue* executables; /* List of Executable*, must be freed. */
+
+	int selected_executable;
+
+	/* Widgets */
+	WidgetRect* hover_widget;
+	WidgetRect* background_widget;
+
+	WidgetText* title_widget;
+	WidgetRect* title_bg_widget;
+
+	WidgetText* empty_widget;
+	WidgetText* help_widget;
+
+	WidgetRect* selection_widget;
+	WidgetText* executables_widgets[MEH_RECENT_MAX_RESULTS];
+	WidgetText* platforms_widgets[MEH_RECENT_MAX_RESULTS];
+} RecentData;
+
+Screen* meh_screen_recent_new(struct App* app, Screen* src_screen);
+RecentData* meh_screen_recent_get_data(Screen* screen);
+void meh_screen_recent_destroy_data(Screen* screen);
+int meh_screen_recent_messages_handler(struct App* app, Screen* screen, Message* message);
+int meh_screen_recent_update(struct App* app, Screen* screen);
+void meh_screen_recent_render(struct App* app, Screen* screen);
@@ -0,0 +1,425 @@
+/*
+ * mehstation - Search of an executable with an on-screen keyboard.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ *
+ * Every key typed re-runs the search in the DB worker, only the results of
+ * the last search are displayed. Going to a result moves the selection of
+ * the executables list on it.
+ */
+
+#include <string.h>
+
+#include "system/app.h"
+#include "system/consts.h"
+#include "system/db_worker.h"
+#include "system/input.h"
+#include "system/db/models.h"
+#include "view/screen.h"
+#include "view/widget_rect.h"
+#include "view/widget_text.h"
+#include "view/screen/executable_list.h"
+#include "view/screen/search.h"
+
+static void meh_screen_search_button_pressed(App* app, Screen* screen, int pressed_button);
+static void meh_screen_search_type_key(App* app, Screen* screen);
+static void meh_screen_search_results(App* app, Screen* screen, DBRequest* request);
+static void meh_screen_search_go_to_result(App* app, Screen* screen);
+static void meh_screen_search_move_selections(Screen* screen);
+static void meh_screen_search_close(App* app, Screen* screen);
+
+/*
+ * Labels of the keyboard keys, the two last ones are space and delete.
+ */
+static const gchar* meh_search_keys[MEH_SEARCH_KEYS_COUNT] = {
+	"A", "B", "C", "D", "E", "F", "G", "H", "I", "J",
+	"K", "L", "M", "N", "O", "P", "Q", "R", "S", "T",
+	"U", "V", "W", "X", "Y", "Z", "0", "1", "2", "3",
+	"4", "5", "6", "7", "8", "9", "_", "<",
+};
+
+#define MEH_SEARCH_KEY_SPACE (MEH_SEARCH_KEYS_COUNT-2)
+#define MEH_SEARCH_KEY_DELETE (MEH_SEARCH_KEYS_COUNT-1)
+
+#define MEH_SEARCH_KEYS_X 70
+#define MEH_SEARCH_KEYS_Y 180
+#define MEH_SEARCH_KEY_SIZE 50
+#define MEH_SEARCH_RESULTS_X 640
+#define MEH_SEARCH_RESULTS_Y 110
+#define MEH_SEARCH_RESULT_HEIGHT 40
+
+Screen* meh_screen_search_new(App* app, Screen* src_screen, int platform_id) {
+	g_assert(app != NULL);
+	g_assert(src_screen != NULL);
+
+	Screen* screen = meh_screen_new(app->window);
+
+	screen->name = g_strdup("Search screen");
+	screen->messages_handler = &meh_screen_search_messages_handler;
+	screen->destroy_data = &meh_screen_search_destroy_data;
+
+	/*
+	 * Custom data
+	 */
+	SearchData* data = g_new(SearchData, 1);
+
+	data->src_screen = src_screen;
+	data->platform_id = platform_id;
+	data->text = g_string_new("");
+	data->search_request = 0;
+	data->results = g_queue_new();
+	data->selected_key = 0;
+	data->selected_result = 0;
+
+	SDL_Color white = { 255, 255, 255, 255 };
+	SDL_Color black = { 0, 0, 0, 150 };
+	SDL_Color gray = { 15, 15, 15, 120 };
+	SDL_Color light_gray = { 90, 90, 90, 220 };
+	SDL_Color very_light_gray = { 40, 40, 40, 220 };
+
+	data->hover_widget = meh_widget_rect_new(0, 0, MEH_FAKE_WIDTH, MEH_FAKE_HEIGHT, black, TRUE);
+	data->background_widget = meh_widget_rect_new(40, 40, MEH_FAKE_WIDTH-80, MEH_FAKE_HEIGHT-80, very_light_gray, TRUE);
+
+	/* Title */
+	data->title_widget = meh_widget_text_new(app->small_bold_font, "SEARCH", 50, 45, 500, 40, white, TRUE);
+	data->title_bg_widget = meh_widget_rect_new(40, 40, MEH_FAKE_WIDTH-80, 45, gray, TRUE);
+
+	/* Searched text */
+	data->text_widget = meh_widget_text_new(app->big_font, "_", MEH_SEARCH_KEYS_X, 110, 520, 50, white, TRUE);
+
+	/* Keyboard */
+	data->key_selection_widget = meh_widget_rect_new(MEH_SEARCH_KEYS_X, MEH_SEARCH_KEYS_Y, MEH_SEARCH_KEY_SIZE-4, MEH_SEARCH_KEY_SIZE-4, light_gray, TRUE);
+	for (int i = 0; i < MEH_SEARCH_KEYS_COUNT; i++) {
+		int x = MEH_SEARCH_KEYS_X + (i % MEH_SEARCH_KEYS_PER_ROW) * MEH_SEARCH_KEY_SIZE + 14;
+		int y = MEH_SEARCH_KEYS_Y + (i / MEH_SEARCH_KEYS_PER_ROW) * MEH_SEARCH_KEY_SIZE + 6;
+		data->keys_widgets[i] = meh_widget_text_new(app->small_bold_font, meh_search_keys[i], x, y, MEH_SEARCH_KEY_SIZE-14, MEH_SEARCH_KEY_SIZE-10, white, TRUE);
+	}
+
+	/* Results */
+	data->result_selection_widget = meh_widget_rect_new(MEH_SEARCH_RESULTS_X-10, MEH_SEARCH_RESULTS_Y, 590, MEH_SEARCH_RESULT_HEIGHT-4, light_gray, TRUE);
+	for (int i = 0; i < MEH_SEARCH_MAX_RESULTS; i++) {
+		data->results_widgets[i] = meh_widget_text_new(app->small_font, "", MEH_SEARCH_RESULTS_X, MEH_SEARCH_RESULTS_Y + i*MEH_SEARCH_RESULT_HEIGHT + 3, 570, 30, white, TRUE);
+	}
+
+	data->help_widget = meh_widget_text_new(app->small_font, "A: type   B: erase   L/R: choose a result   START: go to the result",
+											MEH_SEARCH_KEYS_X, MEH_FAKE_HEIGHT-90, MEH_FAKE_WIDTH-140, 30, white, TRUE);
+
+	screen->data = data;
+
+	return screen;
+}
+
+/*
+ * meh_screen_search_destroy_data destroys the additional data
+ * of the search screen.
+ */
+void meh_screen_search_destroy_data(Screen* screen) {
+	SearchData* data = meh_screen_search_get_data(screen);
+	if (data == NULL) {
+		return;
+	}
+
+	meh_widget_rect_destroy(data->hover_widget);
+	meh_widget_rect_destroy(data->background_widget);
+	meh_widget_text_destroy(data->title_widget);
+	meh_widget_rect_destroy(data->title_bg_widget);
+	meh_widget_text_destroy(data->text_widget);
+	meh_widget_text_destroy(data->help_widget);
+	meh_widget_rect_destroy(data->key_selection_widget);
+	for (int i = 0; i < MEH_SEARCH_KEYS_COUNT; i++) {
+		meh_widget_text_destroy(data->keys_widgets[i]);
+	}
+	meh_widget_rect_destroy(data->result_selection_widget);
+	for (int i = 0; i < MEH_SEARCH_MAX_RESULTS; i++) {
+		meh_widget_text_destroy(data->results_widgets[i]);
+	}
+
+	meh_model_executables_destroy(data->results);
+	g_string_free(data->text, TRUE);
+
+	g_free(data);
+	screen->data = NULL;
+}
+
+SearchData* meh_screen_search_get_data(Screen* screen) {
+	g_assert(screen != NULL);
+	if (screen->data == NULL) {
+		return NULL;
+	}
+	return (SearchData*) screen->data;
+}
+
+int meh_screen_search_messages_handler(struct App* app, Screen* screen, Message* message) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	if (message == NULL) {
+		return 1;
+	}
+
+	switch (message->id) {
+		case MEH_MSG_BUTTON_PRESSED:
+			{
+				InputMessageData* data = (InputMessageData*)message->data;
+				meh_screen_search_button_pressed(app, screen, data->button);
+			}
+			break;
+		case MEH_MSG_UPDATE:
+			{
+				meh_screen_search_update(app, screen);
+			}
+			break;
+		case MEH_MSG_DB_RESULT:
+			{
+				DBRequest* request = (DBRequest*)message->data;
+				SearchData* data = meh_screen_search_get_data(screen);
+				if (request->type == MEH_DB_REQUEST_SEARCH_EXECUTABLES) {
+					meh_screen_search_results(app, screen, request);
+				} else {
+					/* not for the search, maybe for the executables list. */
+					meh_message_forward(app, data->src_screen, message);
+				}
+			}
+			break;
+		case MEH_MSG_RENDER:
+			{
+				meh_screen_search_render(app, screen);
+			}
+			break;
+	}
+
+	return 0;
+}
+
+/*
+ * meh_screen_search_button_pressed is called when we received a button pressed
+ * message.
+ */
+static void meh_screen_search_button_pressed(App* app, Screen* screen, int pressed_button) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	SearchData* data = meh_screen_search_get_data(screen);
+
+	switch (pressed_button) {
+		case MEH_INPUT_BUTTON_UP:
+			if (data->selected_key >= MEH_SEARCH_KEYS_PER_ROW) {
+				data->selected_key -= MEH_SEARCH_KEYS_PER_ROW;
+			}
+			break;
+		case MEH_INPUT_BUTTON_DOWN:
+			if (data->selected_key + MEH_SEARCH_KEYS_PER_ROW < MEH_SEARCH_KEYS_COUNT) {
+				data->selected_key += MEH_SEARCH_KEYS_PER_ROW;
+			}
+			break;
+		case MEH_INPUT_BUTTON_LEFT:
+			if (data->selected_key % MEH_SEARCH_KEYS_PER_ROW > 0) {
+				data->selected_key -= 1;
+			}
+			break;
+		case MEH_INPUT_BUTTON_RIGHT:
+			if (data->selected_key % MEH_SEARCH_KEYS_PER_ROW < MEH_SEARCH_KEYS_PER_ROW-1 &&
+				data->selected_key + 1 < MEH_SEARCH_KEYS_COUNT) {
+				data->selected_key += 1;
+			}
+			break;
+		case MEH_INPUT_BUTTON_L:
+			if (data->selected_result > 0) {
+				data->selected_result -= 1;
+			}
+			break;
+		case MEH_INPUT_BUTTON_R:
+			if (data->selected_result + 1 < (int)g_queue_get_length(data->results)) {
+				data->selected_result += 1;
+			}
+			break;
+		case MEH_INPUT_BUTTON_A:
+			meh_screen_search_type_key(app, screen);
+			break;
+		case MEH_INPUT_BUTTON_B:
+			/* erase the last character, or leave */
+			if (data->text->len == 0) {
+				meh_screen_search_close(app, screen);
+				return;
+			}
+			data->selected_key = MEH_SEARCH_KEY_DELETE;
+			meh_screen_search_type_key(app, screen);
+			break;
+		case MEH_INPUT_BUTTON_START:
+		case MEH_INPUT_BUTTON_SELECT:
+			meh_screen_search_go_to_result(app, screen);
+			return;
+		case MEH_INPUT_SPECIAL_ESCAPE:
+			meh_screen_search_close(app, screen);
+			return;
+	}
+
+	meh_screen_search_move_selections(screen);
+}
+
+/*
+ * meh_screen_search_type_key applies the selected key
+ * on the text and starts a new search.
+ */
+static void meh_screen_search_type_key(App* app, Screen* screen) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	SearchData* data = meh_screen_search_get_data(screen);
+
+	switch (data->selected_key) {
+		case MEH_SEARCH_KEY_DELETE:
+			if (data->text->len == 0) {
+				return;
+			}
+			g_string_truncate(data->text, data->text->len - 1);
+			break;
+		case MEH_SEARCH_KEY_SPACE:
+			if (data->text->len == 0 || data->text->len >= MEH_SEARCH_MAX_LENGTH) {
+				return;
+			}
+			g_string_append_c(data->text, ' ');
+			break;
+		default:
+			if (data->text->len >= MEH_SEARCH_MAX_LENGTH) {
+				return;
+			}
+			g_string_append(data->text, meh_search_keys[data->selected_key]);
+			break;
+	}
+
+	/* refresh the displayed text */
+	g_free(data->text_widget->text);
+	data->text_widget->text = g_strdup_printf("%s_", data->text->str);
+	meh_widget_text_reload(app->window, data->text_widget);
+
+	/* searches it, the results of the previous searches will be ignored. */
+	data->search_request = meh_db_worker_search_executables(app->db_worker, data->platform_id, data->text->str, MEH_SEARCH_MAX_RESULTS);
+}
+
+/*
+ * meh_screen_search_results displays the results of the last search.
+ */
+static void meh_screen_search_results(App* app, Screen* screen, DBRequest* request) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+	g_assert(request != NULL);
+
+	SearchData* data = meh_screen_search_get_data(screen);
+
+	if (request->id != data->search_request || request->executables == NULL) {
+		return;
+	}
+	data->search_request = 0;
+
+	/* take the ownership of the results */
+	meh_model_executables_destroy(data->results);
+	data->results = request->executables;
+	request->executables = NULL;
+
+	for (int i = 0; i < MEH_SEARCH_MAX_RESULTS; i++) {
+		Executable* executable = g_queue_peek_nth(data->results, i);
+		g_free(data->results_widgets[i]->text);
+		data->results_widgets[i]->text = g_strdup(executable != NULL ? executable->display_name : "");
+		meh_widget_text_reload(app->window, data->results_widgets[i]);
+	}
+
+	data->selected_result = 0;
+	meh_screen_search_move_selections(screen);
+}
+
+/*
+ * meh_screen_search_go_to_result selects the chosen result in the
+ * executables list and goes back to it.
+ */
+static void meh_screen_search_go_to_result(App* app, Screen* screen) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	SearchData* data = meh_screen_search_get_data(screen);
+
+	Executable* executable = g_queue_peek_nth(data->results, data->selected_result);
+	if (executable == NULL) {
+		return;
+	}
+
+	meh_exec_list_jump_to_executable(app, data->src_screen, executable->id);
+	meh_screen_search_close(app, screen);
+}
+
+/*
+ * meh_screen_search_move_selections moves the selection
+ * widgets on the selected key and result.
+ */
+static void meh_screen_search_move_selections(Screen* screen) {
+	g_assert(screen != NULL);
+
+	SearchData* data = meh_screen_search_get_data(screen);
+
+	data->key_selection_widget->x.value = MEH_SEARCH_KEYS_X + (data->selected_key % MEH_SEARCH_KEYS_PER_ROW) * MEH_SEARCH_KEY_SIZE;
+	data->key_selection_widget->y.value = MEH_SEARCH_KEYS_Y + (data->selected_key / MEH_SEARCH_KEYS_PER_ROW) * MEH_SEARCH_KEY_SIZE;
+	data->result_selection_widget->y.value = MEH_SEARCH_RESULTS_Y + data->selected_result * MEH_SEARCH_RESULT_HEIGHT;
+}
+
+/*
+ * meh_screen_search_close goes back to the executables list.
+ */
+static void meh_screen_search_close(App* app, Screen* screen) {
+	g_assert(app != NULL);
+	g_assert(screen != NULL);
+
+	SearchData* data = meh_screen_search_get_data(screen);
+
+	meh_app_set_current_screen(app, data->src_screen, TRUE);
+	meh_screen_destroy(screen);
+}
+
+/*
+ * meh_screen_search_update updates the search screen and
+ * the executables list behind it.
+ */
+int meh_screen_search_update(struct App* app, Screen* screen) {
+	meh_screen_update_transitions(screen);
+
+	SearchData* data = meh_screen_search_get_data(screen);
+	meh_message_send(app, data->src_screen, MEH_MSG_UPDATE, NULL);
+
+	return 0;
+}
+
+void meh_screen_search_render(struct App* app, Screen* screen) {
+	SearchData* data = meh_screen_search_get_data(screen);
+	g_assert(data != NULL);
+
+	/* render the background screen */
+	gboolean* flip = g_new(gboolean, 1);
+	*flip = FALSE;
+	meh_message_send(app, data->src_screen, MEH_MSG_RENDER, flip);
+
+	/* render the search screen */
+
+	meh_widget_rect_render(app->window, data->hover_widget);
+	meh_widget_rect_render(app->window, data->background_widget);
+
+	meh_widget_rect_render(app->window, data->title_bg_widget);
+	meh_widget_text_render(app->window, data->title_widget);
+
+	meh_widget_text_render(app->window, data->text_widget);
+
+	meh_widget_rect_render(app->window, data->key_selection_widget);
+	for (int i = 0; i < MEH_SEARCH_KEYS_COUNT; i++) {
+		meh_widget_text_render(app->window, data->keys_widgets[i]);
+	}
+
+	int results = g_queue_get_length(data->results);
+	if (results > 0) {
+		meh_widget_rect_render(app->window, data->result_selection_widget);
+	}
+	for (int i = 0; i < results && i < MEH_SEARCH_MAX_RESULTS; i++) {
+		meh_widget_text_render(app->window, data->results_widgets[i]);
+	}
+
+	meh_widget_text_render(app->window, data->help_widget);
+
+	meh_window_render(app->window);
+}
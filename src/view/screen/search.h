@@ -0,0 +1,56 @@
+/*
+ * mehstation - Search of an executable with an on-screen keyboard.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include "view/screen.h"
+#include "view/widget_rect.h"
+#include "view/widget_text.h"
+
+struct App;
+
+#define MEH_SEARCH_KEYS_PER_ROW (10)
+#define MEH_SEARCH_KEYS_COUNT (38) /* A-Z, 0-9, space and delete */
+#define MEH_SEARCH_MAX_RESULTS (12)
+#define MEH_SEARCH_MAX_LENGTH (32) /* Maximum length of the searched text */
+
+typedef struct {
+	/* upon which screen the search is appearing: the executables list. */
+	Screen* src_screen;
+	int platform_id;
+
+	GString* text;
+	guint search_request; /* id of the last DB worker search, 0 if none. */
+	GQueue* results; /* List of Executable*, must be freed. */
+
+	int selected_key;
+	int selected_result;
+
+	/* Widgets */
+	WidgetRect* hover_widget;
+	WidgetRect* background_widget;
+
+	WidgetText* title_widget;
+	WidgetRect* title_bg_widget;
+
+	WidgetText* text_widget;
+	WidgetText* help_widget;
+
+	WidgetRect* key_selection_widget;
+	WidgetText* keys_widgets[MEH_SEARCH_KEYS_COUNT];
+
+	WidgetRect* result_selection_widget;
+	WidgetText* results_widgets[MEH_SEARCH_MAX_RESULTS];
+} SearchData;
+
+Screen* meh_screen_search_new(struct App* app, Screen* src_screen, int platform_id);
+SearchData* meh_screen_search_get_data(Screen* screen);
+void meh_screen_search_destroy_data(Screen* screen);
+int meh_screen_search_messages_handler(struct App* app, Screen* screen, Message* message);
+int meh_screen_search_update(struct App* app, Screen* screen);
+void meh_screen_search_render(struct App* app, Screen* screen);
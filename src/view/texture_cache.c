@@ -0,0 +1,217 @@
+/*
+ * mehstation - Cache of the textures of the image files.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ */
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+
+#include "view/texture_cache.h"
+
+static gchar* meh_texture_cache_key(const gchar* filename, int width, int height);
+static void meh_texture_cache_evict(TextureCache* cache);
+static void meh_texture_cache_entry_destroy(TextureCacheEntry* entry);
+
+/*
+ * meh_texture_cache_new creates a cache keeping up to `budget`
+ * bytes of textures without users.
+ */
+TextureCache* meh_texture_cache_new(gsize budget) {
+	TextureCache* cache = g_new(TextureCache, 1);
+
+	cache->entries = g_hash_table_new(g_str_hash, g_str_equal);
+	cache->textures = g_hash_table_new(NULL, NULL);
+	cache->unused = g_queue_new();
+	cache->bytes = 0;
+	cache->budget = budget;
+	cache->hits = 0;
+	cache->misses = 0;
+	cache->evictions = 0;
+
+	return cache;
+}
+
+/*
+ * meh_texture_cache_destroy frees every texture of the cache,
+ * the ones still used too.
+ */
+void meh_texture_cache_destroy(TextureCache* cache) {
+	if (cache == NULL) {
+		return;
+	}
+
+	meh_texture_cache_log_stats(cache);
+
+	GHashTableIter iter;
+	gpointer value;
+	g_hash_table_iter_init(&iter, cache->entries);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		TextureCacheEntry* entry = (TextureCacheEntry*)value;
+		if (entry->users > 0) {
+			g_debug("The texture '%s' is still used by %u users.", entry->key, entry->users);
+		}
+		meh_texture_cache_entry_destroy(entry);
+	}
+
+	g_hash_table_destroy(cache->entries);
+	g_hash_table_destroy(cache->textures);
+	g_queue_free(cache->unused);
+	g_free(cache);
+}
+
+/*
+ * meh_texture_cache_key returns the key of the texture of the given file at
+ * the given size, 0 meaning the size of the file. Must be freed.
+ */
+static gchar* meh_texture_cache_key(const gchar* filename, int width, int height) {
+	return g_strdup_printf("%dx%d:%s", width, height, filename);
+}
+
+/*
+ * meh_texture_cache_get returns the texture of the given file if it's in
+ * the cache, NULL otherwise: the file must be decoded then added with
+ * meh_texture_cache_add. A returned texture must be released with
+ * meh_texture_cache_release, not destroyed.
+ */
+SDL_Texture* meh_texture_cache_get(TextureCache* cache, const gchar* filename, int width, int height) {
+	g_assert(cache != NULL);
+	g_assert(filename != NULL);
+
+	gchar* key = meh_texture_cache_key(filename, width, height);
+	TextureCacheEntry* entry = g_hash_table_lookup(cache->entries, key);
+	g_free(key);
+
+	if (entry == NULL) {
+		cache->misses++;
+		return NULL;
+	}
+
+	cache->hits++;
+
+	if (entry->unused_link != NULL) {
+		g_queue_delete_link(cache->unused, entry->unused_link);
+		entry->unused_link = NULL;
+	}
+	entry->users++;
+
+	return entry->texture;
+}
+
+/*
+ * meh_texture_cache_add adds the texture of the given file to the cache,
+ * which takes its ownership. If the file has been added meanwhile, the
+ * given texture is destroyed. Returns the texture to use, to release with
+ * meh_texture_cache_release.
+ */
+SDL_Texture* meh_texture_cache_add(TextureCache* cache, const gchar* filename, int width, int height, SDL_Texture* texture) {
+	g_assert(cache != NULL);
+	g_assert(filename != NULL);
+	g_assert(texture != NULL);
+
+	gchar* key = meh_texture_cache_key(filename, width, height);
+
+	TextureCacheEntry* entry = g_hash_table_lookup(cache->entries, key);
+	if (entry != NULL) {
+		g_free(key);
+		SDL_DestroyTexture(texture);
+		if (entry->unused_link != NULL) {
+			g_queue_delete_link(cache->unused, entry->unused_link);
+			entry->unused_link = NULL;
+		}
+		entry->users++;
+		return entry->texture;
+	}
+
+	int w = 0, h = 0;
+	SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+
+	entry = g_new(TextureCacheEntry, 1);
+	entry->key = key;
+	entry->texture = texture;
+	entry->bytes = (gsize)w * h * 4; /* ARGB8888 */
+	entry->users = 1;
+	entry->unused_link = NULL;
+
+	g_hash_table_insert(cache->entries, entry->key, entry);
+	g_hash_table_insert(cache->textures, entry->texture, entry);
+	cache->bytes += entry->bytes;
+
+	/* makes room for it. */
+	meh_texture_cache_evict(cache);
+
+	return entry->texture;
+}
+
+/*
+ * meh_texture_cache_release is called by a user of the texture which
+ * doesn't need it anymore. Without users, it's kept while the budget
+ * allows it.
+ */
+void meh_texture_cache_release(TextureCache* cache, SDL_Texture* texture) {
+	g_assert(cache != NULL);
+
+	if (texture == NULL) {
+		return;
+	}
+
+	TextureCacheEntry* entry = g_hash_table_lookup(cache->textures, texture);
+	if (entry == NULL) {
+		g_critical("Releasing a texture not in the texture cache.");
+		return;
+	}
+
+	g_assert(entry->users > 0);
+	entry->users--;
+	if (entry->users > 0) {
+		return;
+	}
+
+	g_queue_push_tail(cache->unused, entry);
+	entry->unused_link = cache->unused->tail;
+
+	meh_texture_cache_evict(cache);
+}
+
+/*
+ * meh_texture_cache_is_full returns TRUE if the textures in use
+ * fill the budget: no room can be made for new ones.
+ */
+gboolean meh_texture_cache_is_full(TextureCache* cache) {
+	g_assert(cache != NULL);
+
+	return cache->bytes >= cache->budget && g_queue_is_empty(cache->unused);
+}
+
+/*
+ * meh_texture_cache_evict frees the least recently used textures
+ * without users while the cache is above its budget.
+ */
+static void meh_texture_cache_evict(TextureCache* cache) {
+	while (cache->bytes > cache->budget && !g_queue_is_empty(cache->unused)) {
+		TextureCacheEntry* entry = g_queue_pop_head(cache->unused);
+		entry->unused_link = NULL;
+
+		g_hash_table_remove(cache->entries, entry->key);
+		g_hash_table_remove(cache->textures, entry->texture);
+		cache->bytes -= entry->bytes;
+		cache->evictions++;
+
+		meh_texture_cache_entry_destroy(entry);
+	}
+}
+
+void meh_texture_cache_log_stats(TextureCache* cache) {
+	g_assert(cache != NULL);
+
+	guint lookups = cache->hits + cache->misses;
+	g_message("Texture cache: %u textures, %" G_GSIZE_FORMAT " bytes, %u%% of hits on %u lookups, %u evictions.",
+			g_hash_table_size(cache->entries), cache->bytes,
+			lookups > 0 ? cache->hits * 100 / lookups : 0, lookups, cache->evictions);
+}
+
+static void meh_texture_cache_entry_destroy(TextureCacheEntry* entry) {
+	SDL_DestroyTexture(entry->texture);
+	g_free(entry->key);
+	g_free(entry);
+}
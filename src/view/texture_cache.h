@@ -0,0 +1,48 @@
+/*
+ * mehstation - Cache of the textures of the image files.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+
+/*
+ * A texture of an image file, shared by its users.
+ */
+typedef struct TextureCacheEntry {
+	gchar* key; /* see meh_texture_cache_key */
+	SDL_Texture* texture;
+	gsize bytes; /* estimated memory of the texture */
+	guint users;
+	GList* unused_link; /* link in the unused entries while it has no users, NULL otherwise */
+} TextureCacheEntry;
+
+/*
+ * The textures created from the image files, shared by every screen: a file
+ * used by several executables or screens is decoded once. The textures
+ * without users are kept while the memory budget allows it, the least
+ * recently used are freed first.
+ */
+typedef struct TextureCache {
+	GHashTable* entries; /* key -> TextureCacheEntry* */
+	GHashTable* textures; /* SDL_Texture* -> TextureCacheEntry* */
+	GQueue* unused; /* TextureCacheEntry* without users, the least recently used first */
+	gsize bytes; /* estimated memory of every texture in the cache */
+	gsize budget; /* bytes */
+
+	/* statistics */
+	guint hits;
+	guint misses;
+	guint evictions;
+} TextureCache;
+
+TextureCache* meh_texture_cache_new(gsize budget);
+void meh_texture_cache_destroy(TextureCache* cache);
+SDL_Texture* meh_texture_cache_get(TextureCache* cache, const gchar* filename, int width, int height);
+SDL_Texture* meh_texture_cache_add(TextureCache* cache, const gchar* filename, int width, int height, SDL_Texture* texture);
+void meh_texture_cache_release(TextureCache* cache, SDL_Texture* texture);
+gboolean meh_texture_cache_is_full(TextureCache* cache);
+void meh_texture_cache_log_stats(TextureCache* cache);
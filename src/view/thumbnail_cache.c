@@ -0,0 +1,600 @@
+/*
+ * mehstation - Cache on disk of the downscaled images.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ *
+ * Every image downscaled by the image loader is stored in the cache
+ * directory as a QOI file: decoding it is a lot faster than decoding the
+ * original PNG / JPEG, it's read through a memory mapping. A file of the
+ * cache is named after the path, the mtime and the size of the original
+ * file and the size it has been downscaled to: a modified original file
+ * is decoded again. The files are written atomically, several threads or
+ * processes can fill the cache at once.
+ *
+ * The --build-cache flag fills the cache for every image of the database,
+ * to not decode any original file while browsing the lists.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <SDL2/SDL_image.h>
+
+#include "system/app.h"
+#include "system/db.h"
+#include "system/settings.h"
+#include "system/db/models.h"
+#include "view/image.h"
+#include "view/thumbnail_cache.h"
+#include "view/window.h"
+#include "view/screen/executable_list.h"
+#include "view/screen/platform_list.h"
+
+/* QOI, see https://qoiformat.org/qoi-specification.pdf */
+#define MEH_QOI_HEADER_SIZE (14)
+#define MEH_QOI_PADDING_SIZE (8)
+#define MEH_QOI_OP_INDEX 0x00
+#define MEH_QOI_OP_DIFF 0x40
+#define MEH_QOI_OP_LUMA 0x80
+#define MEH_QOI_OP_RUN 0xc0
+#define MEH_QOI_OP_RGB 0xfe
+#define MEH_QOI_OP_RGBA 0xff
+#define MEH_QOI_MASK 0xc0
+#define MEH_QOI_HASH(a, r, g, b) (((r)*3 + (g)*5 + (b)*7 + (a)*11) % 64)
+
+static gchar* meh_thumbnail_cache_path(ThumbnailCache* cache, const gchar* filename, int width, int height, gint64* size);
+static SDL_Surface* meh_thumbnail_cache_read(const gchar* path);
+static gboolean meh_thumbnail_cache_write(const gchar* path, SDL_Surface* surface);
+static SDL_Surface* meh_qoi_decode(const guint8* bytes, gsize length);
+static guint8* meh_qoi_encode(SDL_Surface* surface, gsize* length);
+static void meh_thumbnail_cache_add_job(GHashTable* jobs, const gchar* filename, int width, int height);
+static void meh_thumbnail_cache_add_executables_jobs(GHashTable* jobs, Window* window, GQueue* executables);
+static void meh_thumbnail_cache_build_job(gpointer data, gpointer user_data);
+static void meh_thumbnail_job_destroy(gpointer data);
+
+/*
+ * meh_thumbnail_cache_new uses the given directory as cache, created if needed.
+ * Returns NULL if the directory is empty or can't be created: the images
+ * are then always decoded from their original file.
+ */
+ThumbnailCache* meh_thumbnail_cache_new(const gchar* directory) {
+	if (directory == NULL || strlen(directory) == 0) {
+		return NULL;
+	}
+
+	if (g_mkdir_with_parents(directory, 0755) != 0) {
+		g_warning("Can't create the thumbnails directory '%s', the thumbnails are not cached.", directory);
+		return NULL;
+	}
+
+	ThumbnailCache* cache = g_new(ThumbnailCache, 1);
+	cache->directory = g_strdup(directory);
+	cache->hits = 0;
+	cache->misses = 0;
+	cache->writes = 0;
+
+	return cache;
+}
+
+void meh_thumbnail_cache_destroy(ThumbnailCache* cache) {
+	if (cache == NULL) {
+		return;
+	}
+
+	g_message("Thumbnail cache: %d hits, %d misses, %d thumbnails written.",
+			g_atomic_int_get(&cache->hits), g_atomic_int_get(&cache->misses), g_atomic_int_get(&cache->writes));
+
+	g_free(cache->directory);
+	g_free(cache);
+}
+
+/*
+ * meh_thumbnail_cache_path returns the path in the cache of the given file
+ * downscaled to the given size, NULL if the file doesn't exist. `size` is
+ * set to the size of the original file. Must be freed.
+ */
+static gchar* meh_thumbnail_cache_path(ThumbnailCache* cache, const gchar* filename, int width, int height, gint64* size) {
+	GStatBuf st;
+	if (g_stat(filename, &st) != 0) {
+		return NULL;
+	}
+
+	if (size != NULL) {
+		*size = st.st_size;
+	}
+
+	gchar* key = g_strdup_printf("%s\n%" G_GINT64_FORMAT "\n%" G_GINT64_FORMAT "\n%dx%d",
+			filename, (gint64)st.st_mtime, (gint64)st.st_size, width, height);
+	gchar* checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA1, key, -1);
+	g_free(key);
+
+	/* subdirectories of a few hundred files for big catalogs. */
+	gchar subdirectory[3] = { checksum[0], checksum[1], '\0' };
+	gchar* name = g_strdup_printf("%s.qoi", checksum);
+	gchar* path = g_build_filename(cache->directory, subdirectory, name, NULL);
+	g_free(name);
+	g_free(checksum);
+
+	return path;
+}
+
+/*
+ * meh_thumbnail_cache_decode decodes the given file downscaled to cover `width`
+ * x `height` pixels, like meh_image_decode_file_scaled, from the cache if
+ * possible. The downscaled images are added to the cache. Can be called from
+ * any thread, `cache` can be NULL.
+ * The surface should be freed by the caller.
+ */
+SDL_Surface* meh_thumbnail_cache_decode(ThumbnailCache* cache, const gchar* filename, int width, int height) {
+	g_assert(filename != NULL);
+
+	/* the original size isn't cached, nor the missing files. */
+	gchar* path = NULL;
+	if (cache == NULL || width <= 0 || height <= 0 ||
+		(path = meh_thumbnail_cache_path(cache, filename, width, height, NULL)) == NULL) {
+		return meh_image_decode_file_scaled(filename, width, height);
+	}
+
+	SDL_Surface* surface = meh_thumbnail_cache_read(path);
+	if (surface != NULL) {
+		g_atomic_int_inc(&cache->hits);
+		g_free(path);
+		return surface;
+	}
+
+	g_atomic_int_inc(&cache->misses);
+
+	surface = meh_image_decode_file_scaled(filename, width, height);
+	if (surface != NULL && meh_thumbnail_cache_write(path, surface)) {
+		g_atomic_int_inc(&cache->writes);
+	}
+
+	g_free(path);
+	return surface;
+}
+
+/*
+ * meh_thumbnail_cache_read reads the cached file, through a memory
+ * mapping. Returns NULL if it's not in the cache or if it's corrupted.
+ */
+static SDL_Surface* meh_thumbnail_cache_read(const gchar* path) {
+	GMappedFile* file = g_mapped_file_new(path, FALSE, NULL);
+	if (file == NULL) {
+		return NULL;
+	}
+
+	SDL_Surface* surface = meh_qoi_decode((const guint8*)g_mapped_file_get_contents(file), g_mapped_file_get_length(file));
+	if (surface == NULL) {
+		g_warning("The thumbnail '%s' is corrupted.", path);
+	}
+
+	g_mapped_file_unref(file);
+	return surface;
+}
+
+/*
+ * meh_thumbnail_cache_write stores the downscaled image in the cache,
+ * atomically: a file of the cache is either missing or complete.
+ */
+static gboolean meh_thumbnail_cache_write(const gchar* path, SDL_Surface* surface) {
+	gchar* directory = g_path_get_dirname(path);
+	int mkdir_result = g_mkdir_with_parents(directory, 0755);
+	g_free(directory);
+
+	if (mkdir_result != 0) {
+		g_warning("Can't create the directory of the thumbnail '%s'", path);
+		return FALSE;
+	}
+
+	gsize length = 0;
+	guint8* bytes = meh_qoi_encode(surface, &length);
+	if (bytes == NULL) {
+		return FALSE;
+	}
+
+	GError* error = NULL;
+	gboolean written = g_file_set_contents(path, (const gchar*)bytes, length, &error);
+	if (!written) {
+		g_warning("Can't write the thumbnail '%s': %s", path, error->message);
+		g_error_free(error);
+	}
+
+	g_free(bytes);
+	return written;
+}
+
+/*
+ * meh_qoi_decode decodes a QOI image in an ARGB8888 surface,
+ * NULL if it's not a valid QOI image.
+ */
+static SDL_Surface* meh_qoi_decode(const guint8* bytes, gsize length) {
+	if (bytes == NULL || length < MEH_QOI_HEADER_SIZE + MEH_QOI_PADDING_SIZE || memcmp(bytes, "qoif", 4) != 0) {
+		return NULL;
+	}
+
+	guint32 width = (guint32)bytes[4] << 24 | (guint32)bytes[5] << 16 | (guint32)bytes[6] << 8 | bytes[7];
+	guint32 height = (guint32)bytes[8] << 24 | (guint32)bytes[9] << 16 | (guint32)bytes[10] << 8 | bytes[11];
+	if (width == 0 || height == 0 || width > MEH_THUMBNAIL_MAX_SIDE || height > MEH_THUMBNAIL_MAX_SIDE) {
+		return NULL;
+	}
+
+	SDL_Surface* surface = SDL_CreateRGBSurface(0, width, height, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+	if (surface == NULL) {
+		return NULL;
+	}
+
+	guint32 index[64] = { 0 };
+	guint8 r = 0, g = 0, b = 0, a = 255;
+	int run = 0;
+
+	/* the padding at the end lets read a whole chunk without checking it. */
+	gsize position = MEH_QOI_HEADER_SIZE;
+	gsize chunks_end = length - MEH_QOI_PADDING_SIZE;
+
+	for (guint32 y = 0; y < height; y++) {
+		Uint32* row = (Uint32*)((Uint8*)surface->pixels + y * surface->pitch);
+		for (guint32 x = 0; x < width; x++) {
+			if (run > 0) {
+				run--;
+			} else if (position < chunks_end) {
+				guint8 b1 = bytes[position++];
+
+				if (b1 == MEH_QOI_OP_RGB) {
+					r = bytes[position++];
+					g = bytes[position++];
+					b = bytes[position++];
+				} else if (b1 == MEH_QOI_OP_RGBA) {
+					r = bytes[position++];
+					g = bytes[position++];
+					b = bytes[position++];
+					a = bytes[position++];
+				} else if ((b1 & MEH_QOI_MASK) == MEH_QOI_OP_INDEX) {
+					guint32 pixel = index[b1];
+					a = pixel >> 24; r = pixel >> 16; g = pixel >> 8; b = pixel;
+				} else if ((b1 & MEH_QOI_MASK) == MEH_QOI_OP_DIFF) {
+					r += ((b1 >> 4) & 0x03) - 2;
+					g += ((b1 >> 2) & 0x03) - 2;
+					b += (b1 & 0x03) - 2;
+				} else if ((b1 & MEH_QOI_MASK) == MEH_QOI_OP_LUMA) {
+					guint8 b2 = bytes[position++];
+					int vg = (b1 & 0x3f) - 32;
+					r += vg - 8 + ((b2 >> 4) & 0x0f);
+					g += vg;
+					b += vg - 8 + (b2 & 0x0f);
+				} else {
+					run = b1 & 0x3f;
+				}
+
+				index[MEH_QOI_HASH(a, r, g, b)] = (guint32)a << 24 | (guint32)r << 16 | (guint32)g << 8 | b;
+			} else {
+				/* truncated */
+				SDL_FreeSurface(surface);
+				return NULL;
+			}
+
+			row[x] = (Uint32)a << 24 | (Uint32)r << 16 | (Uint32)g << 8 | b;
+		}
+	}
+
+	return surface;
+}
+
+/*
+ * meh_qoi_encode encodes the ARGB8888 surface as a QOI image.
+ * Returns the bytes, to free, and their amount in `length`.
+ */
+static guint8* meh_qoi_encode(SDL_Surface* surface, gsize* length) {
+	g_assert(surface != NULL);
+	g_assert(length != NULL);
+
+	if (surface->format->format != SDL_PIXELFORMAT_ARGB8888) {
+		return NULL;
+	}
+
+	guint32 width = surface->w;
+	guint32 height = surface->h;
+
+	/* worst case: a RGBA chunk by pixel */
+	guint8* bytes = g_malloc(MEH_QOI_HEADER_SIZE + (gsize)width * height * 5 + MEH_QOI_PADDING_SIZE);
+	gsize position = 0;
+
+	memcpy(bytes, "qoif", 4);
+	bytes[4] = width >> 24; bytes[5] = width >> 16; bytes[6] = width >> 8; bytes[7] = width;
+	bytes[8] = height >> 24; bytes[9] = height >> 16; bytes[10] = height >> 8; bytes[11] = height;
+	bytes[12] = 4; /* RGBA */
+	bytes[13] = 0; /* sRGB */
+	position = MEH_QOI_HEADER_SIZE;
+
+	if (SDL_LockSurface(surface) != 0) {
+		g_free(bytes);
+		return NULL;
+	}
+
+	guint32 index[64] = { 0 };
+	guint32 previous = 0xFF000000;
+	int run = 0;
+
+	for (guint32 y = 0; y < height; y++) {
+		const Uint32* row = (const Uint32*)((const Uint8*)surface->pixels + y * surface->pitch);
+		for (guint32 x = 0; x < width; x++) {
+			guint32 pixel = row[x];
+			gboolean last = y == height - 1 && x == width - 1;
+
+			if (pixel == previous) {
+				run++;
+				if (run == 62 || last) {
+					bytes[position++] = MEH_QOI_OP_RUN | (run - 1);
+					run = 0;
+				}
+				continue;
+			}
+
+			if (run > 0) {
+				bytes[position++] = MEH_QOI_OP_RUN | (run - 1);
+				run = 0;
+			}
+
+			guint8 a = pixel >> 24, r = pixel >> 16, g = pixel >> 8, b = pixel;
+			int hash = MEH_QOI_HASH(a, r, g, b);
+
+			if (index[hash] == pixel) {
+				bytes[position++] = MEH_QOI_OP_INDEX | hash;
+			} else {
+				index[hash] = pixel;
+
+				if (a == (guint8)(previous >> 24)) {
+					signed char vr = r - (guint8)(previous >> 16);
+					signed char vg = g - (guint8)(previous >> 8);
+					signed char vb = b - (guint8)previous;
+					signed char vg_r = vr - vg;
+					signed char vg_b = vb - vg;
+
+					if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+						bytes[position++] = MEH_QOI_OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2);
+					} else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8) {
+						bytes[position++] = MEH_QOI_OP_LUMA | (vg + 32);
+						bytes[position++] = (vg_r + 8) << 4 | (vg_b + 8);
+					} else {
+						bytes[position++] = MEH_QOI_OP_RGB;
+						bytes[position++] = r;
+						bytes[position++] = g;
+						bytes[position++] = b;
+					}
+				} else {
+					bytes[position++] = MEH_QOI_OP_RGBA;
+					bytes[position++] = r;
+					bytes[position++] = g;
+					bytes[position++] = b;
+					bytes[position++] = a;
+				}
+			}
+
+			previous = pixel;
+		}
+	}
+
+	SDL_UnlockSurface(surface);
+
+	/* end marker */
+	memset(bytes + position, 0, MEH_QOI_PADDING_SIZE - 1);
+	position += MEH_QOI_PADDING_SIZE - 1;
+	bytes[position++] = 1;
+
+	*length = position;
+	return bytes;
+}
+
+/*
+ * meh_thumbnail_cache_main fills, without any UI, the thumbnail cache with
+ * every image of the platforms and executables, using all the processors.
+ * Used by the --build-cache flag.
+ * Returns the exit code of mehstation.
+ */
+int meh_thumbnail_cache_main() {
+	Settings settings;
+	meh_settings_load(&settings);
+
+	ThumbnailCache* cache = meh_thumbnail_cache_new(settings.images_thumbnails);
+	if (cache == NULL) {
+		g_printerr("No thumbnails directory configured.\n");
+		return 2;
+	}
+
+	DB* db = meh_db_open_or_create("database.db", settings);
+	if (db == NULL) {
+		meh_thumbnail_cache_destroy(cache);
+		return 2;
+	}
+
+	IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG);
+
+	/* the images are displayed at the size of the widgets on
+	 * the window: only its size is used to convert them. */
+	Window window = { 0 };
+	window.width = settings.width;
+	window.height = settings.height;
+
+	/* "WxH:path" -> ThumbnailJob*, the same image can be used several times. */
+	GHashTable* jobs = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, meh_thumbnail_job_destroy);
+
+	int icon_width = 0, icon_height = 0, background_width = 0, background_height = 0;
+	meh_screen_platform_list_icon_size(&window, &icon_width, &icon_height);
+	meh_screen_platform_list_background_size(&window, &background_width, &background_height);
+
+	GQueue* platforms = meh_db_get_platforms(db);
+	for (unsigned int i = 0; i < g_queue_get_length(platforms); i++) {
+		Platform* platform = g_queue_peek_nth(platforms, i);
+		meh_thumbnail_cache_add_job(jobs, platform->icon, icon_width, icon_height);
+		meh_thumbnail_cache_add_job(jobs, platform->background, background_width, background_height);
+
+		GQueue* executables = meh_db_get_platform_executables(db, platform, TRUE);
+		meh_thumbnail_cache_add_executables_jobs(jobs, &window, executables);
+		meh_model_executables_destroy(executables);
+	}
+	meh_model_platforms_destroy(platforms);
+	meh_db_close(db);
+
+	ThumbnailBuild build;
+	build.cache = cache;
+	build.done = 0;
+	build.built = 0;
+	build.failed = 0;
+	build.read_bytes = 0;
+	g_mutex_init(&build.mutex);
+
+	int threads = MAX(g_get_num_processors(), 1);
+	int total = g_hash_table_size(jobs);
+	g_print("Building the thumbnails of %d images with %d threads in '%s'\n", total, threads, cache->directory);
+
+	gint64 started = g_get_monotonic_time();
+
+	GThreadPool* pool = g_thread_pool_new(meh_thumbnail_cache_build_job, &build, threads, FALSE, NULL);
+	GHashTableIter iter;
+	gpointer value;
+	g_hash_table_iter_init(&iter, jobs);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		g_thread_pool_push(pool, value, NULL);
+	}
+
+	/* progress */
+	int done = 0;
+	while ((done = g_atomic_int_get(&build.done)) < total) {
+		g_usleep(MEH_THUMBNAIL_PROGRESS_INTERVAL * 1000);
+
+		double elapsed = (g_get_monotonic_time() - started) / (double)G_USEC_PER_SEC;
+		g_mutex_lock(&build.mutex);
+		gint64 read_bytes = build.read_bytes;
+		g_mutex_unlock(&build.mutex);
+
+		g_print("\r%d/%d images (%d%%), %.1f images/s, %.1f MB/s read",
+				g_atomic_int_get(&build.done), total, total > 0 ? g_atomic_int_get(&build.done) * 100 / total : 100,
+				elapsed > 0 ? g_atomic_int_get(&build.done) / elapsed : 0,
+				elapsed > 0 ? read_bytes / elapsed / (1024 * 1024) : 0);
+		fflush(stdout);
+	}
+
+	g_thread_pool_free(pool, FALSE, TRUE);
+
+	double elapsed = (g_get_monotonic_time() - started) / (double)G_USEC_PER_SEC;
+	g_print("\n%d thumbnails built, %d already in the cache, %d failed, in %.1fs (%.1f images/s, %.1f MB/s read).\n",
+			build.built, total - build.built - build.failed, build.failed, elapsed,
+			elapsed > 0 ? total / elapsed : 0,
+			elapsed > 0 ? build.read_bytes / elapsed / (1024 * 1024) : 0);
+
+	g_mutex_clear(&build.mutex);
+	g_hash_table_destroy(jobs);
+	meh_thumbnail_cache_destroy(cache);
+	IMG_Quit();
+
+	return build.failed > 0 ? 3 : 0;
+}
+
+static void meh_thumbnail_cache_add_job(GHashTable* jobs, const gchar* filename, int width, int height) {
+	if (filename == NULL || strlen(filename) == 0) {
+		return;
+	}
+
+	gchar* key = g_strdup_printf("%dx%d:%s", width, height, filename);
+	if (g_hash_table_contains(jobs, key)) {
+		g_free(key);
+		return;
+	}
+
+	ThumbnailJob* job = g_new(ThumbnailJob, 1);
+	job->filename = g_strdup(filename);
+	job->width = width;
+	job->height = height;
+	g_hash_table_insert(jobs, key, job);
+}
+
+/*
+ * meh_thumbnail_cache_add_executables_jobs adds the images of the executables
+ * at the size of every widget which can display them, following the
+ * picks of the executables list.
+ */
+static void meh_thumbnail_cache_add_executables_jobs(GHashTable* jobs, Window* window, GQueue* executables) {
+	int sizes[MEH_EXEC_LIST_PICKED_SCREENSHOT + 1][2];
+	for (int i = 0; i <= MEH_EXEC_LIST_PICKED_SCREENSHOT; i++) {
+		meh_exec_list_image_size(window, i, &sizes[i][0], &sizes[i][1]);
+	}
+
+	for (GList* l = g_queue_peek_head_link(executables); l != NULL; l = g_list_next(l)) {
+		Executable* executable = l->data;
+		int count = 0;
+
+		/* any of the fanarts / screenshots, or the covers / logos without them. */
+		ExecutableResource* resources = meh_model_executable_get_resources(executable, MEH_EXEC_RES_OTHER, MEH_EXEC_RES_SCREENSHOT, &count);
+		if (count == 0) {
+			resources = meh_model_executable_get_resources(executable, MEH_EXEC_RES_COVER, MEH_EXEC_RES_LOGO, &count);
+		}
+		for (int i = 0; i < count; i++) {
+			meh_thumbnail_cache_add_job(jobs, resources[i].filepath,
+					sizes[MEH_EXEC_LIST_PICKED_BACKGROUND][0], sizes[MEH_EXEC_LIST_PICKED_BACKGROUND][1]);
+		}
+
+		/* the last cover and logo */
+		resources = meh_model_executable_get_resources(executable, MEH_EXEC_RES_COVER, MEH_EXEC_RES_COVER, &count);
+		if (count > 0) {
+			meh_thumbnail_cache_add_job(jobs, resources[count-1].filepath,
+					sizes[MEH_EXEC_LIST_PICKED_COVER][0], sizes[MEH_EXEC_LIST_PICKED_COVER][1]);
+		}
+
+		resources = meh_model_executable_get_resources(executable, MEH_EXEC_RES_LOGO, MEH_EXEC_RES_LOGO, &count);
+		if (count > 0) {
+			meh_thumbnail_cache_add_job(jobs, resources[count-1].filepath,
+					sizes[MEH_EXEC_LIST_PICKED_LOGO][0], sizes[MEH_EXEC_LIST_PICKED_LOGO][1]);
+		}
+
+		/* any of the fanarts / screenshots */
+		resources = meh_model_executable_get_resources(executable, MEH_EXEC_RES_FANART, MEH_EXEC_RES_SCREENSHOT, &count);
+		for (int i = 0; i < count; i++) {
+			meh_thumbnail_cache_add_job(jobs, resources[i].filepath,
+					sizes[MEH_EXEC_LIST_PICKED_SCREENSHOT][0], sizes[MEH_EXEC_LIST_PICKED_SCREENSHOT][1]);
+		}
+	}
+}
+
+/*
+ * meh_thumbnail_cache_build_job builds the thumbnail of one image
+ * if it's not in the cache yet, in a thread of the pool.
+ */
+static void meh_thumbnail_cache_build_job(gpointer data, gpointer user_data) {
+	ThumbnailJob* job = (ThumbnailJob*)data;
+	ThumbnailBuild* build = (ThumbnailBuild*)user_data;
+	g_assert(job != NULL);
+	g_assert(build != NULL);
+
+	gint64 size = 0;
+	gchar* path = meh_thumbnail_cache_path(build->cache, job->filename, job->width, job->height, &size);
+
+	if (path == NULL) {
+		g_atomic_int_inc(&build->failed);
+	} else if (!g_file_test(path, G_FILE_TEST_EXISTS)) {
+		SDL_Surface* surface = meh_image_decode_file_scaled(job->filename, job->width, job->height);
+		if (surface != NULL && meh_thumbnail_cache_write(path, surface)) {
+			g_atomic_int_inc(&build->built);
+			g_atomic_int_inc(&build->cache->writes);
+		} else {
+			g_atomic_int_inc(&build->failed);
+		}
+
+		if (surface != NULL) {
+			SDL_FreeSurface(surface);
+		}
+
+		g_mutex_lock(&build->mutex);
+		build->read_bytes += size;
+		g_mutex_unlock(&build->mutex);
+	}
+
+	g_free(path);
+	g_atomic_int_inc(&build->done);
+}
+
+static void meh_thumbnail_job_destroy(gpointer data) {
+	ThumbnailJob* job = (ThumbnailJob*)data;
+	g_free(job->filename);
+	g_free(job);
+}
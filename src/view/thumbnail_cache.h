@@ -0,0 +1,53 @@
+/*
+ * mehstation - Cache on disk of the downscaled images.
+ *
+ * Copyright © 2015 Rémy Mathieu
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+
+#define MEH_THUMBNAIL_MAX_SIDE (16384) /* above, a cached file is considered corrupted */
+#define MEH_THUMBNAIL_PROGRESS_INTERVAL (500) /* ms between two prints of the progress of --build-cache */
+
+/*
+ * The images downscaled to the size they are displayed at, stored
+ * in a directory as QOI files to not decode the original files
+ * again. Used by several threads at once.
+ */
+typedef struct ThumbnailCache {
+	gchar* directory;
+
+	/* statistics, atomically updated. */
+	gint hits;
+	gint misses;
+	gint writes;
+} ThumbnailCache;
+
+/*
+ * A downscaled image to build with --build-cache.
+ */
+typedef struct ThumbnailJob {
+	gchar* filename;
+	int width;
+	int height;
+} ThumbnailJob;
+
+/*
+ * The state of --build-cache, shared by the threads building the thumbnails.
+ */
+typedef struct ThumbnailBuild {
+	ThumbnailCache* cache;
+	gint done; /* jobs processed, atomically updated */
+	gint built; /* thumbnails not in the cache before */
+	gint failed;
+	gint64 read_bytes; /* size of the original files decoded, protected by the mutex */
+	GMutex mutex;
+} ThumbnailBuild;
+
+ThumbnailCache* meh_thumbnail_cache_new(const gchar* directory);
+void meh_thumbnail_cache_destroy(ThumbnailCache* cache);
+SDL_Surface* meh_thumbnail_cache_decode(ThumbnailCache* cache, const gchar* filename, int width, int height);
+int meh_thumbnail_cache_main();
@@ -2,6 +2,8 @@
 #include <glib.h>
 #include <string.h>
 
+#include "view/image_loader.h"
+#include "view/texture_cache.h"
 #include "view/window.h"
 #include "view/text.h"
 #include "system/consts.h"
@@ -10,8 +12,12 @@ static gboolean meh_window_has_accelerated(void);
 
 /*
  * meh_create_window deals with the creation of the opengl window.
+ * `image_threads` is the amount of threads decoding the images, `texture_budget`
+ * the bytes of unused textures the texture cache can keep and `thumbnails_directory`
+ * where the downscaled images are cached on disk.
  */
-Window* meh_window_create(guint width, guint height, gboolean fullscreen, gboolean force_software) {
+Window* meh_window_create(guint width, guint height, gboolean fullscreen, gboolean force_software, int image_threads, gsize texture_budget,
+		const gchar* thumbnails_directory) {
 	Window* w = g_new(Window, 1);
 
 	w->width = width;
@@ -58,6 +64,9 @@ Window* meh_window_create(guint width, guint height, gboolean fullscreen, gboole
 	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");  // make the scaled rendering look smoother.
 	SDL_RenderSetLogicalSize(w->sdl_renderer, w->width, w->height);
 
+	w->image_loader = meh_image_loader_new(image_threads, thumbnails_directory);
+	w->texture_cache = meh_texture_cache_new(texture_budget);
+
 	g_message("Window %d:%d %s created.", w->width, w->height, (w->fullscreen == TRUE ? "fullscreen" : "windowed"));
 	return w;
 }
@@ -83,6 +92,12 @@ gboolean meh_window_has_accelerated(void) {
 void meh_window_destroy(Window* window) {
 	g_assert(window != NULL);
 
+	/* its textures are created with the renderer. */
+	meh_image_loader_destroy(window->image_loader);
+	window->image_loader = NULL;
+	meh_texture_cache_destroy(window->texture_cache);
+	window->texture_cache = NULL;
+
 	if (window->sdl_window != NULL) {
 		SDL_DestroyWindow(window->sdl_window);
 		window->sdl_window = NULL;
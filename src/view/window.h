@@ -5,6 +5,9 @@
 
 #include "view/text.h"
 
+struct ImageLoader;
+struct TextureCache;
+
 /*
  * Main window.
  */
@@ -14,9 +17,14 @@ typedef struct {
 	gboolean fullscreen;
 	SDL_Window* sdl_window;
 	SDL_Renderer* sdl_renderer;
+	/* decodes the images of the screens in background. */
+	struct ImageLoader* image_loader;
+	/* textures of the image files, shared by the screens. */
+	struct TextureCache* texture_cache;
 } Window;
 
-Window* meh_window_create(guint width, guint height, gboolean fullscreen, gboolean force_software);
+Window* meh_window_create(guint width, guint height, gboolean fullscreen, gboolean force_software, int image_threads, gsize texture_budget,
+		const gchar* thumbnails_directory);
 void meh_window_destroy(Window* window);
 void meh_window_clear(Window* window, SDL_Color color);
 void meh_window_render(Window* window);